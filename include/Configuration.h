@@ -20,7 +20,10 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #define CONFIGURATION_20061031_H_
 
 #include "API.h"
+#include "Types.h"
+#include <QHash>
 #include <QString>
+#include <QStringList>
 
 class EDB_EXPORT Configuration {
 public:
@@ -64,9 +67,15 @@ public:
 	InitialBreakpoint initial_breakpoint;
 	bool              warn_on_no_exec_bp;
 	bool              find_main;
+	bool              non_stop;
 	bool              tty_enabled;
 	QString           tty_command;
 
+	// signals tab, signals which aren't listed stop. The system calls to stop
+	// on are named the way syscalls.xml names them
+	QHash<int, edb::SIGNAL_POLICY> signal_policies;
+	QStringList       syscall_stops;
+
 	// disassembly tab
 	Syntax            syntax;
 	bool              zeros_are_filling;
@@ -20,6 +20,10 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #define EXPRESSION_20070402_H_
 
 #include <QString>
+#include <QStringList>
+#include <QVarLengthArray>
+#include <QVector>
+#include <boost/bind.hpp>
 #include <boost/function.hpp>
 
 struct ExpressionError {
@@ -75,15 +79,72 @@ private:
 	ERROR_MSG error_;
 };
 
+// a parsed expression in the form of a small stack machine program, it can be
+// evaluated over and over without going back to the source text
+template <class T>
+class CompiledExpression {
+public:
+	typedef boost::function<T(int, bool*, ExpressionError*)> variable_reader_t;
+	typedef boost::function<T(T, bool*, ExpressionError*)>   memory_reader_t;
+
+public:
+	enum Opcode {
+		CONSTANT,
+		VARIABLE,
+		READ_MEMORY,
+		NEGATE,
+		COMPLEMENT,
+		NOT,
+		AND,
+		OR,
+		XOR,
+		LSHFT,
+		RSHFT,
+		PLUS,
+		MINUS,
+		MUL,
+		DIV,
+		MOD,
+		LT,
+		LE,
+		GT,
+		GE,
+		EQ,
+		NE,
+		LOGICAL_AND,
+		LOGICAL_OR
+	};
+
+	struct Instruction {
+		Opcode opcode;
+		T      operand;
+	};
+
+public:
+	CompiledExpression() : stack_depth_(0), stack_size_(0) {}
+
+public:
+	bool empty() const { return code_.isEmpty(); }
+	void add_instruction(Opcode opcode, T operand = T());
+	void clear();
+	T evaluate(const variable_reader_t &variable_reader, const memory_reader_t &memory_reader, bool *ok, ExpressionError *error) const;
+
+private:
+	QVector<Instruction> code_;
+	int                  stack_depth_;
+	int                  stack_size_;
+};
 
 template <class T>
 class Expression {
 public:
-	typedef boost::function<T(const QString&, bool*, ExpressionError*)> variable_getter_t;
-	typedef boost::function<T(T, bool*, ExpressionError*)>              memory_reader_t;
+	typedef boost::function<T(const QString&, bool*, ExpressionError*)>   variable_getter_t;
+	typedef boost::function<T(T, bool*, ExpressionError*)>                memory_reader_t;
+	typedef boost::function<int(const QString&, bool*, ExpressionError*)> variable_resolver_t;
 
 public:
 	Expression(const QString &s, variable_getter_t vg, memory_reader_t mr);
+	explicit Expression(const QString &s);
 	~Expression() {}
 
 private:
@@ -135,42 +196,25 @@ private:
 		}
 	};
 
-private:
-	T evaluate_expression() {
-		T result;
-
-		get_token();
-		eval_exp(result);
+public:
+	T evaluate_expression(bool *ok, ExpressionError *error) throw();
+	bool compile(CompiledExpression<T> *program, variable_resolver_t resolver, ExpressionError *error) throw();
 
-		return result;
-	}
+private:
+	int intern_variable(const QString &name, bool *ok, ExpressionError *error);
+	T read_variable(int id, bool *ok, ExpressionError *error) const;
 
-public:
-	T evaluate_expression(bool *ok, ExpressionError *error) throw() {
-	
-		Q_ASSERT(ok);
-		Q_ASSERT(error);
-	
-		try {
-			*ok = true;
-			return evaluate_expression();
-		} catch(const ExpressionError &e) {
-			*ok = false;
-			*error = e;
-			return T();
-		}
-	}
 private:
-	void eval_exp(T &result);
-	void eval_exp0(T &result);
-	void eval_exp1(T &result);
-	void eval_exp2(T &result);
-	void eval_exp3(T &result);
-	void eval_exp4(T &result);
-	void eval_exp5(T &result);
-	void eval_exp6(T &result);
-	void eval_exp7(T &result);
-	void eval_atom(T &result);
+	void parse_exp();
+	void parse_exp0();
+	void parse_exp1();
+	void parse_exp2();
+	void parse_exp3();
+	void parse_exp4();
+	void parse_exp5();
+	void parse_exp6();
+	void parse_exp7();
+	void parse_atom();
 	void get_token();
 
 	static bool is_delim(QChar ch) {
@@ -183,6 +227,9 @@ private:
 	Token                   token_;
 	variable_getter_t       variable_reader_;
 	memory_reader_t         memory_reader_;
+	CompiledExpression<T> * program_;
+	variable_resolver_t     variable_resolver_;
+	QStringList             variables_;
 };
 
 #include "Expression.tcc"
@@ -19,6 +19,167 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #ifndef EXPRESSION_20070402_TCC_
 #define EXPRESSION_20070402_TCC_
 
+//------------------------------------------------------------------------------
+// Name: add_instruction
+// Desc: appends an instruction to the program, keeping track of how deep the
+//       evaluation stack will need to be
+//------------------------------------------------------------------------------
+template <class T>
+void CompiledExpression<T>::add_instruction(Opcode opcode, T operand) {
+
+	const Instruction insn = { opcode, operand };
+	code_.push_back(insn);
+
+	switch(opcode) {
+	case CONSTANT:
+	case VARIABLE:
+		stack_size_ = qMax(stack_size_, ++stack_depth_);
+		break;
+	case READ_MEMORY:
+	case NEGATE:
+	case COMPLEMENT:
+	case NOT:
+		break;
+	default:
+		--stack_depth_;
+		break;
+	}
+}
+
+//------------------------------------------------------------------------------
+// Name: clear
+// Desc:
+//------------------------------------------------------------------------------
+template <class T>
+void CompiledExpression<T>::clear() {
+	code_.clear();
+	stack_depth_ = 0;
+	stack_size_  = 0;
+}
+
+//------------------------------------------------------------------------------
+// Name: evaluate
+// Desc: runs the program, variables are read by the id they were resolved to
+//       when the expression was compiled
+//------------------------------------------------------------------------------
+template <class T>
+T CompiledExpression<T>::evaluate(const variable_reader_t &variable_reader, const memory_reader_t &memory_reader, bool *ok, ExpressionError *error) const {
+
+	Q_ASSERT(ok);
+	Q_ASSERT(error);
+
+	*ok = false;
+
+	if(code_.isEmpty()) {
+		*error = ExpressionError(ExpressionError::SYNTAX);
+		return T();
+	}
+
+	QVarLengthArray<T, 16> stack(stack_size_);
+	int sp = 0;
+
+	const Instruction *const last = code_.constData() + code_.size();
+	for(const Instruction *insn = code_.constData(); insn != last; ++insn) {
+		switch(insn->opcode) {
+		case CONSTANT:
+			stack[sp++] = insn->operand;
+			break;
+		case VARIABLE:
+			if(!variable_reader) {
+				*error = ExpressionError(ExpressionError::UNKNOWN_VARIABLE);
+				return T();
+			}
+
+			stack[sp++] = variable_reader(static_cast<int>(insn->operand), ok, error);
+			if(!*ok) {
+				return T();
+			}
+			break;
+		case READ_MEMORY:
+			if(!memory_reader) {
+				*error = ExpressionError(ExpressionError::CANNOT_READ_MEMORY);
+				return T();
+			}
+
+			stack[sp - 1] = memory_reader(stack[sp - 1], ok, error);
+			if(!*ok) {
+				return T();
+			}
+			break;
+		case NEGATE:
+#ifdef _MSC_VER
+#pragma warning(push)
+#pragma warning(disable:4146)
+#endif
+			stack[sp - 1] = -stack[sp - 1];
+#ifdef _MSC_VER
+#pragma warning(pop)
+#endif
+			break;
+		case COMPLEMENT:
+			stack[sp - 1] = ~stack[sp - 1];
+			break;
+		case NOT:
+			stack[sp - 1] = !stack[sp - 1];
+			break;
+		default:
+			do {
+				const T rhs = stack[--sp];
+				T &lhs      = stack[sp - 1];
+
+				switch(insn->opcode) {
+				case AND:         lhs &= rhs;           break;
+				case OR:          lhs |= rhs;           break;
+				case XOR:         lhs ^= rhs;           break;
+				case LSHFT:       lhs <<= rhs;          break;
+				case RSHFT:       lhs >>= rhs;          break;
+				case PLUS:        lhs += rhs;           break;
+				case MUL:         lhs *= rhs;           break;
+				case LT:          lhs = lhs <  rhs;     break;
+				case LE:          lhs = lhs <= rhs;     break;
+				case GT:          lhs = lhs >  rhs;     break;
+				case GE:          lhs = lhs >= rhs;     break;
+				case EQ:          lhs = lhs == rhs;     break;
+				case NE:          lhs = lhs != rhs;     break;
+				case LOGICAL_AND: lhs = lhs && rhs;     break;
+				case LOGICAL_OR:  lhs = lhs || rhs;     break;
+				case MINUS:
+#ifdef _MSC_VER
+#pragma warning(push)
+/* disable warning about applying unary - to an unsigned type */
+#pragma warning(disable : 4146)
+#endif
+					lhs -= rhs;
+#ifdef _MSC_VER
+#pragma warning(pop)
+#endif
+					break;
+				case DIV:
+					if(rhs == 0) {
+						*error = ExpressionError(ExpressionError::DIVIDE_BY_ZERO);
+						return T();
+					}
+					lhs /= rhs;
+					break;
+				case MOD:
+					if(rhs == 0) {
+						*error = ExpressionError(ExpressionError::DIVIDE_BY_ZERO);
+						return T();
+					}
+					lhs %= rhs;
+					break;
+				default:
+					break;
+				}
+			} while(0);
+			break;
+		}
+	}
+
+	*ok = true;
+	return stack[0];
+}
+
 //------------------------------------------------------------------------------
 // Name: Expression
 // Desc:
@@ -26,20 +187,108 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 template <class T>
 Expression<T>::Expression(const QString &s, variable_getter_t vg, memory_reader_t mr) :
 		expression_(s), expression_ptr_(expression_.begin()),
-		variable_reader_(vg), memory_reader_(mr) {
+		variable_reader_(vg), memory_reader_(mr), program_(0) {
+}
+
+//------------------------------------------------------------------------------
+// Name: Expression
+// Desc: for expressions which are only going to be compiled
+//------------------------------------------------------------------------------
+template <class T>
+Expression<T>::Expression(const QString &s) :
+		expression_(s), expression_ptr_(expression_.begin()), program_(0) {
 }
 
 //------------------------------------------------------------------------------
-// Name: eval_exp
+// Name: evaluate_expression
+// Desc: compiles the expression and runs it once, variables are looked up by
+//       name through the variable getter
+//------------------------------------------------------------------------------
+template <class T>
+T Expression<T>::evaluate_expression(bool *ok, ExpressionError *error) throw() {
+
+	Q_ASSERT(ok);
+	Q_ASSERT(error);
+
+	CompiledExpression<T> program;
+
+	variables_.clear();
+	if(!compile(&program, boost::bind(&Expression::intern_variable, this, _1, _2, _3), error)) {
+		*ok = false;
+		return T();
+	}
+
+	return program.evaluate(boost::bind(&Expression::read_variable, this, _1, _2, _3), memory_reader_, ok, error);
+}
+
+//------------------------------------------------------------------------------
+// Name: compile
+// Desc: parses the expression into program, every variable is handed to the
+//       resolver once so that evaluating the program does no string work
+//------------------------------------------------------------------------------
+template <class T>
+bool Expression<T>::compile(CompiledExpression<T> *program, variable_resolver_t resolver, ExpressionError *error) throw() {
+
+	Q_ASSERT(program);
+	Q_ASSERT(error);
+
+	program->clear();
+
+	program_           = program;
+	variable_resolver_ = resolver;
+	expression_ptr_    = expression_.begin();
+
+	try {
+		get_token();
+		parse_exp();
+		program_ = 0;
+		return true;
+	} catch(const ExpressionError &e) {
+		program->clear();
+		program_ = 0;
+		*error   = e;
+		return false;
+	}
+}
+
+//------------------------------------------------------------------------------
+// Name: intern_variable
+// Desc: resolver used by evaluate_expression, it just remembers the name
+//------------------------------------------------------------------------------
+template <class T>
+int Expression<T>::intern_variable(const QString &name, bool *ok, ExpressionError *error) {
+	Q_UNUSED(error);
+	*ok = true;
+	variables_.push_back(name);
+	return variables_.size() - 1;
+}
+
+//------------------------------------------------------------------------------
+// Name: read_variable
+// Desc: reader used by evaluate_expression, looks the variable up by name
+//------------------------------------------------------------------------------
+template <class T>
+T Expression<T>::read_variable(int id, bool *ok, ExpressionError *error) const {
+	if(!variable_reader_) {
+		*ok    = false;
+		*error = ExpressionError(ExpressionError::UNKNOWN_VARIABLE);
+		return T();
+	}
+
+	return variable_reader_(variables_[id], ok, error);
+}
+
+//------------------------------------------------------------------------------
+// Name: parse_exp
 // Desc: private entry point with sanity check
 //------------------------------------------------------------------------------
 template <class T>
-void Expression<T>::eval_exp(T &result) {
+void Expression<T>::parse_exp() {
 	if(token_.type_ == Token::UNKNOWN) {
 		throw ExpressionError(ExpressionError::SYNTAX);
 	}
 
-	eval_exp0(result);
+	parse_exp0();
 
 	switch(token_.type_) {
 	case Token::OPERATOR:
@@ -63,26 +312,24 @@ void Expression<T>::eval_exp(T &result) {
 }
 
 //------------------------------------------------------------------------------
-// Name: eval_exp0
+// Name: parse_exp0
 // Desc: logic
 //------------------------------------------------------------------------------
 template <class T>
-void Expression<T>::eval_exp0(T &result) {
-	eval_exp1(result);
+void Expression<T>::parse_exp0() {
+	parse_exp1();
 
 	for(Token op = token_; op.operator_ == Token::LOGICAL_AND || op.operator_ == Token::LOGICAL_OR; op = token_) {
-		T partial_value;
 
 		get_token();
-		eval_exp1(partial_value);
+		parse_exp1();
 
-		// add or subtract
 		switch(op.operator_) {
 		case Token::LOGICAL_AND:
-			result = result && partial_value;
+			program_->add_instruction(CompiledExpression<T>::LOGICAL_AND);
 			break;
 		case Token::LOGICAL_OR:
-			result = result || partial_value;
+			program_->add_instruction(CompiledExpression<T>::LOGICAL_OR);
 			break;
 		default:
 			break;
@@ -91,29 +338,27 @@ void Expression<T>::eval_exp0(T &result) {
 }
 
 //------------------------------------------------------------------------------
-// Name: eval_exp1
+// Name: parse_exp1
 // Desc: binary logic
 //------------------------------------------------------------------------------
 template <class T>
-void Expression<T>::eval_exp1(T &result) {
-	eval_exp2(result);
+void Expression<T>::parse_exp1() {
+	parse_exp2();
 
 	for(Token op = token_; op.operator_ == Token::AND || op.operator_ == Token::OR || op.operator_ == Token::XOR; op = token_) {
-		T partial_value;
 
 		get_token();
-		eval_exp2(partial_value);
+		parse_exp2();
 
-		// add or subtract
 		switch(op.operator_) {
 		case Token::AND:
-			result &= partial_value;
+			program_->add_instruction(CompiledExpression<T>::AND);
 			break;
 		case Token::OR:
-			result |= partial_value;
+			program_->add_instruction(CompiledExpression<T>::OR);
 			break;
 		case Token::XOR:
-			result ^= partial_value;
+			program_->add_instruction(CompiledExpression<T>::XOR);
 			break;
 		default:
 			break;
@@ -122,38 +367,36 @@ void Expression<T>::eval_exp1(T &result) {
 }
 
 //------------------------------------------------------------------------------
-// Name: eval_exp2
+// Name: parse_exp2
 // Desc: comparisons
 //------------------------------------------------------------------------------
 template <class T>
-void Expression<T>::eval_exp2(T &result) {
-	eval_exp3(result);
+void Expression<T>::parse_exp2() {
+	parse_exp3();
 
 	for(Token op = token_; op.operator_ == Token::LT || op.operator_ == Token::LE || op.operator_ == Token::GT || op.operator_ == Token::GE || op.operator_ == Token::EQ || op.operator_ == Token::NE; op = token_) {
-		T partial_value;
 
 		get_token();
-		eval_exp3(partial_value);
+		parse_exp3();
 
-		// perform the relational operation
 		switch(op.operator_) {
 		case Token::LT:
-			result = result < partial_value;
+			program_->add_instruction(CompiledExpression<T>::LT);
 			break;
 		case Token::LE:
-			result = result <= partial_value;
+			program_->add_instruction(CompiledExpression<T>::LE);
 			break;
 		case Token::GT:
-			result = result > partial_value;
+			program_->add_instruction(CompiledExpression<T>::GT);
 			break;
 		case Token::GE:
-			result = result >= partial_value;
+			program_->add_instruction(CompiledExpression<T>::GE);
 			break;
 		case Token::EQ:
-			result = result == partial_value;
+			program_->add_instruction(CompiledExpression<T>::EQ);
 			break;
 		case Token::NE:
-			result = result != partial_value;
+			program_->add_instruction(CompiledExpression<T>::NE);
 			break;
 		default:
 			break;
@@ -162,26 +405,24 @@ void Expression<T>::eval_exp2(T &result) {
 }
 
 //------------------------------------------------------------------------------
-// Name: eval_exp3
+// Name: parse_exp3
 // Desc: shifts
 //------------------------------------------------------------------------------
 template <class T>
-void Expression<T>::eval_exp3(T &result) {
-	eval_exp4(result);
+void Expression<T>::parse_exp3() {
+	parse_exp4();
 
 	for(Token op = token_; op.operator_ == Token::RSHFT || op.operator_ == Token::LSHFT; op = token_) {
-		T partial_value;
 
 		get_token();
-		eval_exp4(partial_value);
+		parse_exp4();
 
-		// perform the shift operation
 		switch(op.operator_) {
 		case Token::LSHFT:
-			result <<= partial_value;
+			program_->add_instruction(CompiledExpression<T>::LSHFT);
 			break;
 		case Token::RSHFT:
-			result >>= partial_value;
+			program_->add_instruction(CompiledExpression<T>::RSHFT);
 			break;
 		default:
 			break;
@@ -190,34 +431,24 @@ void Expression<T>::eval_exp3(T &result) {
 }
 
 //------------------------------------------------------------------------------
-// Name: eval_exp4
+// Name: parse_exp4
 // Desc: addition/subtraction
 //------------------------------------------------------------------------------
 template <class T>
-void Expression<T>::eval_exp4(T &result) {
-	eval_exp5(result);
+void Expression<T>::parse_exp4() {
+	parse_exp5();
 
 	for(Token op = token_; op.operator_ == Token::PLUS || op.operator_ == Token::MINUS; op = token_) {
-		T partial_value;
 
 		get_token();
-		eval_exp5(partial_value);
+		parse_exp5();
 
-		// add or subtract
 		switch(op.operator_) {
 		case Token::PLUS:
-			result += partial_value;
+			program_->add_instruction(CompiledExpression<T>::PLUS);
 			break;
 		case Token::MINUS:
-#ifdef _MSC_VER
-#pragma warning(push)
-/* disable warning about applying unary - to an unsigned type */
-#pragma warning(disable : 4146)
-#endif
-			result -= partial_value;
-#ifdef _MSC_VER
-#pragma warning(pop)
-#endif
+			program_->add_instruction(CompiledExpression<T>::MINUS);
 			break;
 		default:
 			break;
@@ -226,35 +457,27 @@ void Expression<T>::eval_exp4(T &result) {
 }
 
 //------------------------------------------------------------------------------
-// Name: eval_exp5
+// Name: parse_exp5
 // Desc: multiplication/division
 //------------------------------------------------------------------------------
 template <class T>
-void Expression<T>::eval_exp5(T &result) {
-	eval_exp6(result);
+void Expression<T>::parse_exp5() {
+	parse_exp6();
 
 	for(Token op = token_; op.operator_ == Token::MUL || op.operator_ == Token::DIV || op.operator_ == Token::MOD; op = token_) {
-		T partial_value;
 
 		get_token();
-		eval_exp6(partial_value);
+		parse_exp6();
 
-		// mul, div, or modulus
 		switch(op.operator_) {
 		case Token::MUL:
-			result *= partial_value;
+			program_->add_instruction(CompiledExpression<T>::MUL);
 			break;
 		case Token::DIV:
-			if(partial_value == 0) {
-				throw ExpressionError(ExpressionError::DIVIDE_BY_ZERO);
-			}
-			result /= partial_value;
+			program_->add_instruction(CompiledExpression<T>::DIV);
 			break;
 		case Token::MOD:
-			if(partial_value == 0) {
-				throw ExpressionError(ExpressionError::DIVIDE_BY_ZERO);
-			}
-			result %= partial_value;
+			program_->add_instruction(CompiledExpression<T>::MOD);
 			break;
 		default:
 			break;
@@ -263,59 +486,48 @@ void Expression<T>::eval_exp5(T &result) {
 }
 
 //------------------------------------------------------------------------------
-// Name: eval_exp6
+// Name: parse_exp6
 // Desc: unary expressions
 //------------------------------------------------------------------------------
 template <class T>
-void Expression<T>::eval_exp6(T &result) {
+void Expression<T>::parse_exp6() {
 
 	Token op = token_;
 	if(op.operator_ == Token::PLUS || op.operator_ == Token::MINUS || op.operator_ == Token::CMP || op.operator_ == Token::NOT) {
 		get_token();
 	}
 
-	eval_exp7(result);
+	parse_exp7();
 
 	switch(op.operator_) {
-	case Token::PLUS:
-		// this may seems like a waste, but unary + can be overloaded for a type
-		// to have a non-nop effect!
-		result = +result;
-		break;
 	case Token::MINUS:
-#ifdef _MSC_VER
-#pragma warning(push)
-#pragma warning(disable:4146)
-#endif
-		result = -result;
-#ifdef _MSC_VER
-#pragma warning(pop)
-#endif
+		program_->add_instruction(CompiledExpression<T>::NEGATE);
 		break;
 	case Token::CMP:
-		result = ~result;
+		program_->add_instruction(CompiledExpression<T>::COMPLEMENT);
 		break;
 	case Token::NOT:
-		result = !result;
+		program_->add_instruction(CompiledExpression<T>::NOT);
 		break;
 	default:
+		// unary + has no effect on the integral types we are used with
 		break;
 	}
 }
 
 //------------------------------------------------------------------------------
-// Name: eval_exp7
+// Name: parse_exp7
 // Desc: sub-expressions
 //------------------------------------------------------------------------------
 template <class T>
-void Expression<T>::eval_exp7(T &result) {
+void Expression<T>::parse_exp7() {
 
 	switch(token_.operator_) {
 	case Token::LPAREN:
 		get_token();
 
 		// get sub-expression
-		eval_exp0(result);
+		parse_exp0();
 
 		if(token_.operator_ != Token::RPAREN) {
 			throw ExpressionError(ExpressionError::UNBALANCED_PARENS);
@@ -327,69 +539,59 @@ void Expression<T>::eval_exp7(T &result) {
 		throw ExpressionError(ExpressionError::UNBALANCED_PARENS);
 		break;
 	case Token::LBRACE:
-		do {
-			get_token();
-
-			// get sub-expression
-			T effective_address;
-			eval_exp0(effective_address);
+		get_token();
 
-			if(memory_reader_) {
-				bool ok;
-				ExpressionError error;
+		// get the effective address, then dereference it
+		parse_exp0();
+		program_->add_instruction(CompiledExpression<T>::READ_MEMORY);
 
-				result = memory_reader_(effective_address, &ok, &error);
-				if(!ok) {
-					throw error;
-				}
-			} else {
-				throw ExpressionError(ExpressionError::CANNOT_READ_MEMORY);
-			}
-
-			if(token_.operator_ != Token::RBRACE) {
-				throw ExpressionError(ExpressionError::UNBALANCED_BRACES);
-			}
+		if(token_.operator_ != Token::RBRACE) {
+			throw ExpressionError(ExpressionError::UNBALANCED_BRACES);
+		}
 
-			get_token();
-		} while(0);
+		get_token();
 		break;
 	case Token::RBRACE:
 		throw ExpressionError(ExpressionError::UNBALANCED_BRACES);
 		break;
 	default:
-		eval_atom(result);
+		parse_atom();
 		break;
 
 	}
 }
 
 //------------------------------------------------------------------------------
-// Name: eval_atom
+// Name: parse_atom
 // Desc: atoms (variables/constants)
 //------------------------------------------------------------------------------
 template <class T>
-void Expression<T>::eval_atom(T &result) {
+void Expression<T>::parse_atom() {
 
 	switch(token_.type_) {
 	case Token::VARIABLE:
-		if(variable_reader_) {
+		if(variable_resolver_) {
 			bool ok;
 			ExpressionError error;
-			result = variable_reader_(token_.data_, &ok, &error);
+			const int id = variable_resolver_(token_.data_, &ok, &error);
 			if(!ok) {
 				throw error;
 			}
+			program_->add_instruction(CompiledExpression<T>::VARIABLE, static_cast<T>(id));
 		} else {
 			throw ExpressionError(ExpressionError::UNKNOWN_VARIABLE);
 		}
 		get_token();
 		break;
 	case Token::NUMBER:
-		bool ok;
-		result = token_.data_.toULongLong(&ok, 0);
-		if(!ok) {
-			throw ExpressionError(ExpressionError::INVALID_NUMBER);
-		}
+		do {
+			bool ok;
+			const T value = token_.data_.toULongLong(&ok, 0);
+			if(!ok) {
+				throw ExpressionError(ExpressionError::INVALID_NUMBER);
+			}
+			program_->add_instruction(CompiledExpression<T>::CONSTANT, value);
+		} while(0);
 		get_token();
 		break;
 	default:
@@ -19,6 +19,7 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #ifndef IBREAKPOINT_20060720_H_
 #define IBREAKPOINT_20060720_H_
 
+#include "Tracepoint.h"
 #include "Types.h"
 
 #include <QByteArray>
@@ -30,11 +31,13 @@ public:
 	typedef QSharedPointer<IBreakpoint> pointer;
 	
 public:
+	IBreakpoint() : coverage(false) {}
 	virtual ~IBreakpoint() {}
 
 public:
 	virtual edb::address_t address() const = 0;
 	virtual unsigned int hit_count() const = 0;
+	virtual unsigned int ignore_count() const = 0;
 	virtual bool enabled() const = 0;
 	virtual bool one_time() const = 0;
 	virtual bool internal() const = 0;
@@ -44,11 +47,23 @@ public:
 	virtual bool enable() = 0;
 	virtual bool disable() = 0;
 	virtual void hit() = 0;
+	virtual void set_ignore_count(unsigned int value) = 0;
 	virtual void set_one_time(bool value) = 0;
 	virtual void set_internal(bool value) = 0;
 
 public:
 	QString condition;
+
+	// condition compiled into a program on its first evaluation, anything
+	// which changes condition must reset this
+	QSharedPointer<CompiledExpression<edb::address_t> > compiled_condition;
+
+	// when set, hits are recorded and the process carries on running
+	Tracepoint::pointer tracepoint;
+
+	// when set, the first hit marks the block starting here as covered and the
+	// breakpoint is removed for good without ever stopping the process
+	bool coverage;
 };
 
 #endif
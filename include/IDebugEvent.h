@@ -39,7 +39,8 @@ public:
 
 	enum TRAP_REASON {
 		TRAP_STEPPING,
-		TRAP_BREAKPOINT
+		TRAP_BREAKPOINT,
+		TRAP_SYSCALL     // entry to a system call the core was told to stop on
 	};
 
 	struct Message {
@@ -73,6 +74,12 @@ public:
 	virtual edb::pid_t process() const = 0;
 	virtual edb::tid_t thread() const = 0;
 	virtual int code() const = 0;
+
+public:
+	// what the core made of a hit on one of our breakpoints, so that it isn't
+	// worked out twice. Cores which leave that to the debugger need not bother
+	virtual edb::BREAKPOINT_ACTION breakpoint_action() const { return edb::BREAKPOINT_UNDECIDED; }
+	virtual QString breakpoint_error() const                 { return QString(); }
 };
 
 #endif
@@ -35,12 +35,27 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #include <QtPlugin>
 
 class IState;
+class IStepHandler;
 class QString;
 class State;
 
 class IDebuggerCore {
 public:
 	typedef QHash<edb::address_t, IBreakpoint::pointer> BreakpointList;
+
+	struct MemoryRange {
+		edb::address_t address;
+		void          *buffer;
+		std::size_t    length;
+		bool           ok;
+	};
+
+	typedef QVector<MemoryRange> MemoryRangeList;
+
+	enum StepMode {
+		STEP_INSTRUCTION, // one instruction at a time
+		STEP_BLOCK        // straight to the next taken branch
+	};
 	
 public:
 	virtual ~IDebuggerCore() {}
@@ -81,19 +96,68 @@ public:
 	virtual void set_state(const State &state) = 0;
 	virtual void step(edb::EVENT_STATUS status) = 0;
 
+	// returns a descriptor which becomes readable whenever wait_debug_event may
+	// have something to report, so that it doesn't need to be polled. Returns -1
+	// if the platform has no such thing and polling is the only option
+	virtual int event_fd() const = 0;
+
 public:
 	// returns true on success, false on failure, all bytes must be successfully
 	// read/written in order for a success. The debugged application should be stopped
-	// or this will return false immediately.
+	// or this will return false immediately. Reads may still fill in the parts
+	// which could be read, the rest is 0xff.
 	virtual bool write_bytes(edb::address_t address, const void *buf, std::size_t len) = 0;
 	virtual bool read_bytes(edb::address_t address, void *buf, std::size_t len) = 0;
 	virtual bool read_pages(edb::address_t address, void *buf, std::size_t count) = 0;
 
+	// reads several (possibly unrelated) ranges in as few round trips as the
+	// platform allows. Each range's "ok" is set only if all of its bytes could
+	// be read, unreadable bytes are filled with 0xff just like read_bytes.
+	// returns false if the debugged application is not stopped
+	virtual bool read_ranges(MemoryRangeList *ranges) = 0;
+
+	// page cache statistics (optional), how many page lookups were and weren't
+	// answered from the cache since the core was loaded. Returns false if the
+	// core doesn't cache pages
+	virtual bool page_cache_statistics(quint64 *, quint64 *) const { return false; }
+
 public:
 	// thread support stuff (optional)
 	virtual QList<edb::tid_t> thread_ids() const            { return QList<edb::tid_t>(); }
 	virtual edb::tid_t        active_thread() const         { return static_cast<edb::tid_t>(-1); }
 	virtual void              set_active_thread(edb::tid_t) {}
+	virtual bool              thread_running(edb::tid_t) const { return false; }
+
+public:
+	// instruction tracing (optional). Steps the active thread up to <count>
+	// times in one go, the other threads stay stopped and no event is reported
+	// for the steps themselves, <handler> sees the thread after every step.
+	// Stepping also ends when the thread is about to run into an enabled
+	// breakpoint, or when something other than the step happens to it, which
+	// is then reported by wait_debug_event as usual. Returns the number of
+	// steps taken, or -1 if the core can't do this
+	virtual int step_many(IStepHandler *, int, StepMode) { return -1; }
+
+	// signal policy (optional). A core which knows what to do with a signal
+	// that isn't meant to stop can hand it back to the thread by itself, so
+	// it never turns into an event. The debugger applies the same policies to
+	// whatever does get reported
+	virtual void set_signal_policy(int, edb::SIGNAL_POLICY) {}
+
+	// system call stops (optional). The system calls to stop on entry to, by
+	// number and keyed by the ABI they belong to, named as in syscalls.xml
+	// ("x86", "x86-64"). Stopping on one is reported as a trap of type
+	// TRAP_SYSCALL, everything else runs at full speed. Takes effect for the
+	// next process which is started. A core may do this with a filter which
+	// can't be taken out of the process again, an empty map starts processes
+	// without one. Returns false if the core can't do this
+	virtual bool set_syscall_stops(const QMap<QString, QList<int> > &) { return false; }
+
+	// non-stop mode (optional). Only the thread which reports an event stops,
+	// the others carry on. resume and step then act on the active thread alone,
+	// which may be set to any thread that is stopped. Returns false if the core
+	// can't do this
+	virtual bool set_non_stop(bool) { return false; }
 
 public:
 	// basic breakpoint managment
@@ -104,6 +168,13 @@ public:
 	virtual void                 clear_breakpoints() = 0;
 	virtual void                 remove_breakpoint(edb::address_t address) = 0;
 
+	// bulk breakpoint managment, the addresses are grouped by page so that the
+	// bytes of each page are read and written once no matter how many
+	// breakpoints land on it. add_breakpoints returns the breakpoints which
+	// were created, addresses which already had one are skipped
+	virtual QList<IBreakpoint::pointer> add_breakpoints(const QList<edb::address_t> &addresses) = 0;
+	virtual void                        remove_breakpoints(const QList<edb::address_t> &addresses) = 0;
+
 public:
 	virtual QString format_pointer(edb::address_t address) const = 0;
 
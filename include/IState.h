@@ -34,6 +34,8 @@ public:
 	virtual QString flags_to_string() const = 0;
 	virtual QString flags_to_string(edb::reg_t flags) const = 0;
 	virtual Register value(const QString &reg) const = 0;
+	virtual Register value(int id) const;
+	virtual int register_id(const QString &reg) const;
 	virtual edb::address_t frame_pointer() const = 0;
 	virtual edb::address_t instruction_pointer() const = 0;
 	virtual edb::address_t stack_pointer() const = 0;
@@ -0,0 +1,36 @@
+/*
+Copyright (C) 2006 - 2013 Evan Teran
+                          eteran@alum.rit.edu
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef ISTEP_HANDLER_20131103_H_
+#define ISTEP_HANDLER_20131103_H_
+
+class State;
+
+// sees every step taken by IDebuggerCore::step_many. This is called on
+// whatever thread the core does its stepping on, and while the debugged thread
+// is stopped, so it should do little more than take note of the state
+class IStepHandler {
+public:
+	virtual ~IStepHandler() {}
+
+public:
+	// return false to end the stepping after this step
+	virtual bool handle_step(const State &state) = 0;
+};
+
+#endif
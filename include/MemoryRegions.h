@@ -23,7 +23,11 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #include "Types.h"
 #include "IRegion.h"
 #include <QAbstractItemModel>
+#include <QAtomicInt>
 #include <QList>
+#include <QMutex>
+#include <QSharedPointer>
+#include <QVector>
 
 class EDB_EXPORT MemoryRegions : public QAbstractItemModel {
 	Q_OBJECT
@@ -47,7 +51,28 @@ public:
 	void sync();
 
 private:
-	QList<IRegion::pointer> regions_;
+	// the regions ordered by address, with their bounds laid out flat so that
+	// find_region can binary search them without touching the region objects.
+	// An index is never changed once it is built, a new one is swapped in, so
+	// lookups from worker threads hold on to whichever one they started with
+	struct RegionIndex {
+		RegionIndex() : last_hit(0) {
+		}
+
+		QVector<IRegion::pointer> regions;
+		QVector<edb::address_t>   starts;
+		QVector<edb::address_t>   ends;
+		mutable QAtomicInt        last_hit;
+	};
+
+private:
+	void rebuild_index();
+	QSharedPointer<const RegionIndex> current_index() const;
+
+private:
+	QList<IRegion::pointer>           regions_;
+	QSharedPointer<const RegionIndex> index_;
+	mutable QMutex                    index_mutex_;
 };
 
 #endif
@@ -45,6 +45,8 @@ public:
 	QString flags_to_string() const;
 	QString flags_to_string(edb::reg_t flags) const;
 	Register value(const QString &reg) const;
+	Register value(int id) const;
+	int register_id(const QString &reg) const;
 	edb::address_t frame_pointer() const;
 	edb::address_t instruction_pointer() const;
 	edb::address_t stack_pointer() const;
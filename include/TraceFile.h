@@ -0,0 +1,86 @@
+/*
+Copyright (C) 2006 - 2013 Evan Teran
+                          eteran@alum.rit.edu
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef TRACEFILE_20131020_H_
+#define TRACEFILE_20131020_H_
+
+#include "API.h"
+#include "Types.h"
+
+#include <QByteArray>
+#include <QHash>
+#include <QList>
+#include <QString>
+#include <QStringList>
+#include <QVector>
+
+// the on disk format of tracepoint logs. A file is a short header followed by
+// records, each record is a type, the length of its payload and the payload,
+// so readers can step over records they don't know about
+class EDB_EXPORT TraceFile {
+public:
+	enum RecordType {
+		RECORD_TRACEPOINT = 1,
+		RECORD_HIT        = 2,
+		RECORD_DROPPED    = 3
+	};
+
+	struct TracepointInfo {
+		quint32        id;
+		edb::address_t address;
+		QStringList    registers;
+		QString        memory_expression;
+		quint32        memory_size;
+		quint32        backtrace_depth;
+	};
+
+	struct Hit {
+		quint32                 tracepoint;
+		qint64                  timestamp;
+		edb::tid_t              tid;
+		edb::address_t          address;
+		QVector<edb::reg_t>     registers;
+		edb::address_t          memory_address;
+		QByteArray              memory;
+		QVector<edb::address_t> backtrace;
+	};
+
+public:
+	TraceFile();
+
+public:
+	static QByteArray header();
+	static QByteArray encode(const TracepointInfo &info);
+	static QByteArray encode(const Hit &hit);
+	static QByteArray encode_dropped(quint64 count);
+
+public:
+	bool load(const QString &filename);
+	QString error_string() const                          { return error_string_; }
+	QHash<quint32, TracepointInfo> tracepoints() const    { return tracepoints_; }
+	QList<Hit> hits() const                               { return hits_; }
+	quint64 dropped() const                               { return dropped_; }
+
+private:
+	QString                        error_string_;
+	QHash<quint32, TracepointInfo> tracepoints_;
+	QList<Hit>                     hits_;
+	quint64                        dropped_;
+};
+
+#endif
@@ -0,0 +1,54 @@
+/*
+Copyright (C) 2006 - 2013 Evan Teran
+                          eteran@alum.rit.edu
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef TRACEPOINT_20131020_H_
+#define TRACEPOINT_20131020_H_
+
+#include "Types.h"
+
+#include <QSharedPointer>
+#include <QString>
+#include <QStringList>
+#include <QVector>
+
+template <class T>
+class CompiledExpression;
+
+// what a tracepoint writes to the trace file each time it is hit
+class Tracepoint {
+public:
+	typedef QSharedPointer<Tracepoint> pointer;
+
+public:
+	Tracepoint() : memory_size(0), backtrace_depth(0), id(0) {
+	}
+
+public:
+	QStringList registers;
+	QString     memory_expression;
+	quint32     memory_size;
+	quint32     backtrace_depth;
+
+public:
+	// filled in by the recorder on the first hit
+	quint32                                             id;
+	QVector<int>                                        register_ids;
+	QSharedPointer<CompiledExpression<edb::address_t> > memory_program;
+};
+
+#endif
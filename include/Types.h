@@ -29,6 +29,21 @@ namespace edb {
 		DEBUG_CONTINUE_STEP,        // the event has been addressed, step as normal
 		DEBUG_EXCEPTION_NOT_HANDLED // pass the event unmodified back thread and continue
 	};
+
+	enum BREAKPOINT_ACTION {
+		BREAKPOINT_UNDECIDED, // nobody has looked at the hit yet
+		BREAKPOINT_STOP,      // the hit is due, report it
+		BREAKPOINT_IGNORE,    // the hit uses up one of the ignore count, carry on
+		BREAKPOINT_SKIP,      // the condition doesn't hold, carry on
+		BREAKPOINT_TRACE,     // a tracepoint's hit which is due, record it and carry on
+		BREAKPOINT_ERROR      // the condition couldn't be evaluated, report the hit
+	};
+
+	enum SIGNAL_POLICY {
+		SIGNAL_STOP, // report the signal like any other event
+		SIGNAL_PASS, // hand it straight back to the thread without stopping
+		SIGNAL_LOG   // like SIGNAL_PASS, but leave a note in the log
+	};
 }
 
 #endif
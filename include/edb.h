@@ -24,6 +24,7 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #include "IRegion.h"
 #include "IBreakpoint.h"
 #include "Module.h"
+#include "Tracepoint.h"
 #include "Types.h"
 
 #include <QHash>
@@ -52,6 +53,9 @@ class QWidget;
 
 struct ExpressionError;
 
+template <class T>
+class CompiledExpression;
+
 namespace edb {
 
 class Prototype;
@@ -77,13 +81,58 @@ EDB_EXPORT QWidget *disassembly_widget();
 // breakpoint managment
 EDB_EXPORT IBreakpoint::pointer find_breakpoint(address_t address);
 EDB_EXPORT QString get_breakpoint_condition(address_t address);
+EDB_EXPORT unsigned int get_breakpoint_ignore_count(address_t address);
 EDB_EXPORT address_t disable_breakpoint(address_t address);
 EDB_EXPORT address_t enable_breakpoint(address_t address);
 EDB_EXPORT void create_breakpoint(address_t address);
+EDB_EXPORT int create_breakpoints(const QList<address_t> &addresses);
 EDB_EXPORT void remove_breakpoint(address_t address);
+EDB_EXPORT void remove_breakpoints(const QList<address_t> &addresses);
 EDB_EXPORT void set_breakpoint_condition(address_t address, const QString &condition);
+EDB_EXPORT void set_breakpoint_ignore_count(address_t address, unsigned int count);
+EDB_EXPORT void set_breakpoint_tracepoint(address_t address, const Tracepoint::pointer &tracepoint);
 EDB_EXPORT void toggle_breakpoint(address_t address);
 
+// evaluates a breakpoint's condition against a stopped thread's state, the
+// condition is compiled on first use and kept on the breakpoint
+EDB_EXPORT bool evaluate_breakpoint_condition(const IBreakpoint::pointer &bp, const State &state, bool *ok, ExpressionError *err);
+
+// what a hit on a breakpoint calls for, worked out once per hit by whoever
+// sees it first. complete_breakpoint_hit does the counting and recording that
+// goes with it, once the hit is really over
+EDB_EXPORT BREAKPOINT_ACTION breakpoint_action(const IBreakpoint::pointer &bp, const State &state, QString *error);
+EDB_EXPORT void complete_breakpoint_hit(const IBreakpoint::pointer &bp, BREAKPOINT_ACTION action, const State &state);
+
+// expressions which are evaluated over and over against a stopped thread,
+// registers are resolved when compiling so running them does no string work
+EDB_EXPORT bool compile_expression(const QString &expression, const State &state, CompiledExpression<address_t> *program, ExpressionError *err);
+EDB_EXPORT address_t evaluate_expression(const CompiledExpression<address_t> &program, const State &state, bool *ok, ExpressionError *err);
+
+// tracepoints, hits are written to a trace file in the background
+EDB_EXPORT void record_tracepoint(const IBreakpoint::pointer &bp, const State &state);
+EDB_EXPORT QString trace_file_name();
+EDB_EXPORT void flush_trace();
+
+// block coverage, each basic block of a region gets a breakpoint which is
+// taken out on its first hit without the process ever stopping
+EDB_EXPORT int start_coverage(const IRegion::pointer &region);
+EDB_EXPORT void stop_coverage();
+EDB_EXPORT void clear_coverage();
+EDB_EXPORT void record_coverage(address_t address);
+EDB_EXPORT bool is_covered(address_t address);
+EDB_EXPORT bool coverage_enabled();
+
+// signals, what the configuration says to do when the program receives one
+EDB_EXPORT SIGNAL_POLICY signal_policy(int signal);
+EDB_EXPORT void apply_signal_policies();
+
+// system calls to stop on, returns the configured names which syscalls.xml
+// doesn't know
+EDB_EXPORT QStringList apply_syscall_stops();
+
+// whether only the thread with an event stops
+EDB_EXPORT void apply_non_stop();
+
 EDB_EXPORT address_t current_data_view_address();
 
 // change what the various views show
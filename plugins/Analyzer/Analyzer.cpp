@@ -112,6 +112,11 @@ QMenu *Analyzer::menu(QWidget *parent) {
 		menu_->addAction(tr("&Analyze RIP's Region"), this, SLOT(do_ip_analysis()), QKeySequence(tr("Ctrl+A")));
 #endif
 		menu_->addAction(tr("&Analyze Viewed Region"), this, SLOT(do_view_analysis()), QKeySequence(tr("Ctrl+Shift+A")));
+		menu_->addSeparator();
+		menu_->addAction(tr("Start &Coverage Of Viewed Region"), this, SLOT(start_view_coverage()));
+		menu_->addAction(tr("S&top Coverage"), this, SLOT(stop_coverage()));
+		menu_->addAction(tr("C&lear Coverage"), this, SLOT(clear_coverage()));
+		menu_->addSeparator();
 
 		// if we are dealing with a main window (and we are...)
 		// add the dock object
@@ -175,6 +180,37 @@ void Analyzer::do_view_analysis() {
 	do_analysis(edb::v1::current_cpu_view_region());
 }
 
+//------------------------------------------------------------------------------
+// Name: start_view_coverage
+// Desc: watches every basic block of the viewed region, the blocks light up
+//       in the CPU view as they are executed
+//------------------------------------------------------------------------------
+void Analyzer::start_view_coverage() {
+	if(IRegion::pointer region = edb::v1::current_cpu_view_region()) {
+		const int planted = edb::v1::start_coverage(region);
+		edb::v1::set_status(tr("Coverage: watching %n more block(s)", "", planted));
+		edb::v1::repaint_cpu_view();
+	}
+}
+
+//------------------------------------------------------------------------------
+// Name: stop_coverage
+// Desc:
+//------------------------------------------------------------------------------
+void Analyzer::stop_coverage() {
+	edb::v1::stop_coverage();
+	edb::v1::repaint_cpu_view();
+}
+
+//------------------------------------------------------------------------------
+// Name: clear_coverage
+// Desc:
+//------------------------------------------------------------------------------
+void Analyzer::clear_coverage() {
+	edb::v1::clear_coverage();
+	edb::v1::repaint_cpu_view();
+}
+
 //------------------------------------------------------------------------------
 // Name: mark_function_start
 // Desc:
@@ -94,6 +94,9 @@ public Q_SLOTS:
 	void goto_function_end();
 	void mark_function_start();
 	void show_specified();
+	void start_view_coverage();
+	void stop_coverage();
+	void clear_coverage();
 
 private:
 	struct RegionData {
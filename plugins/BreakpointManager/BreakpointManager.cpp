@@ -18,6 +18,7 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 
 #include "BreakpointManager.h"
 #include "DialogBreakpoints.h"
+#include "DialogTraceViewer.h"
 #include "edb.h"
 #include <QMenu>
 #include <QKeySequence>
@@ -26,7 +27,7 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 // Name: BreakpointManager
 // Desc:
 //------------------------------------------------------------------------------
-BreakpointManager::BreakpointManager() : menu_(0), dialog_(0) {
+BreakpointManager::BreakpointManager() : menu_(0), dialog_(0), trace_viewer_(0) {
 }
 
 //------------------------------------------------------------------------------
@@ -35,6 +36,7 @@ BreakpointManager::BreakpointManager() : menu_(0), dialog_(0) {
 //------------------------------------------------------------------------------
 BreakpointManager::~BreakpointManager() {
 	delete dialog_;
+	delete trace_viewer_;
 }
 
 //------------------------------------------------------------------------------
@@ -48,6 +50,7 @@ QMenu *BreakpointManager::menu(QWidget *parent) {
 	if(!menu_) {
 		menu_ = new QMenu(tr("BreakpointManager"), parent);
 		menu_->addAction(tr("&Breakpoints"), this, SLOT(show_menu()), QKeySequence(tr("Ctrl+B")));
+		menu_->addAction(tr("&Trace Viewer"), this, SLOT(show_trace_viewer()));
 	}
 
 	return menu_;
@@ -66,6 +69,19 @@ void BreakpointManager::show_menu() {
 	dialog_->show();
 }
 
+//------------------------------------------------------------------------------
+// Name: show_trace_viewer
+// Desc:
+//------------------------------------------------------------------------------
+void BreakpointManager::show_trace_viewer() {
+
+	if(!trace_viewer_) {
+		trace_viewer_ = new DialogTraceViewer(edb::v1::debugger_ui);
+	}
+
+	trace_viewer_->show();
+}
+
 #if QT_VERSION < 0x050000
 Q_EXPORT_PLUGIN2(BreakpointManager, BreakpointManager)
 #endif
@@ -42,10 +42,12 @@ public:
 
 public Q_SLOTS:
 	void show_menu();
+	void show_trace_viewer();
 
 private:
 	QMenu *   menu_;
 	QDialog * dialog_;
+	QDialog * trace_viewer_;
 };
 
 #endif
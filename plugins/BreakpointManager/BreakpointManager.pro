@@ -2,6 +2,6 @@
 include(../plugins.pri)
 
 # Input
-HEADERS += BreakpointManager.h DialogBreakpoints.h
-FORMS += dialogbreakpoints.ui
-SOURCES += BreakpointManager.cpp DialogBreakpoints.cpp
+HEADERS += BreakpointManager.h DialogBreakpoints.h DialogTracepoint.h DialogTraceViewer.h
+FORMS += dialogbreakpoints.ui dialogtracepoint.ui dialogtraceviewer.ui
+SOURCES += BreakpointManager.cpp DialogBreakpoints.cpp DialogTracepoint.cpp DialogTraceViewer.cpp
@@ -17,6 +17,7 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 */
 
 #include "DialogBreakpoints.h"
+#include "DialogTracepoint.h"
 #include "Expression.h"
 #include "IDebuggerCore.h"
 #include "edb.h"
@@ -25,6 +26,8 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #include <QInputDialog>
 #include <QMessageBox>
 
+#include <climits>
+
 #include "ui_dialogbreakpoints.h"
 
 //------------------------------------------------------------------------------
@@ -78,14 +81,18 @@ void DialogBreakpoints::updateList() {
 			const QString condition      = bp->condition;
 			const QByteArray orig_bytes  = bp->original_bytes();
 			const bool onetime           = bp->one_time();
+			const unsigned int hits      = bp->hit_count();
+			const unsigned int ignore    = bp->ignore_count();
 			const QString symname        = edb::v1::find_function_symbol(address, QString(), 0);
 			const QString bytes          = edb::v1::format_bytes(orig_bytes);
 
 			ui->tableWidget->setItem(row, 0, new QTableWidgetItem(edb::v1::format_pointer(address)));
 			ui->tableWidget->setItem(row, 1, new QTableWidgetItem(condition));
 			ui->tableWidget->setItem(row, 2, new QTableWidgetItem(bytes));
-			ui->tableWidget->setItem(row, 3, new QTableWidgetItem(onetime ? tr("One Time") : tr("Standard")));
-			ui->tableWidget->setItem(row, 4, new QTableWidgetItem(symname));
+			ui->tableWidget->setItem(row, 3, new QTableWidgetItem(bp->tracepoint ? tr("Tracepoint") : onetime ? tr("One Time") : tr("Standard")));
+			ui->tableWidget->setItem(row, 4, new QTableWidgetItem(QString::number(hits)));
+			ui->tableWidget->setItem(row, 5, new QTableWidgetItem(QString::number(ignore)));
+			ui->tableWidget->setItem(row, 6, new QTableWidgetItem(symname));
 		}
 	}
 
@@ -135,6 +142,24 @@ void DialogBreakpoints::on_btnCondition_clicked() {
 	}
 }
 
+//------------------------------------------------------------------------------
+// Name: on_btnTracepoint_clicked
+// Desc: adds a breakpoint which records what was asked for and keeps going
+//------------------------------------------------------------------------------
+void DialogBreakpoints::on_btnTracepoint_clicked() {
+
+	DialogTracepoint dlg(this);
+	if(dlg.exec() == QDialog::Accepted) {
+		const edb::address_t address = dlg.address();
+		if(!edb::v1::find_breakpoint(address)) {
+			edb::v1::create_breakpoint(address);
+		}
+
+		edb::v1::set_breakpoint_tracepoint(address, dlg.tracepoint());
+		updateList();
+	}
+}
+
 #if 0
 //------------------------------------------------------------------------------
 // Name: on_btnAddFunction_clicked
@@ -160,16 +185,20 @@ void DialogBreakpoints::on_btnAddFunction_clicked() {
 // Desc:
 //------------------------------------------------------------------------------
 void DialogBreakpoints::on_btnRemove_clicked() {
+	QList<edb::address_t> addresses;
+
 	QList<QTableWidgetItem *> sel = ui->tableWidget->selectedItems();
 	Q_FOREACH(QTableWidgetItem *it, sel) {
 		if(it->column() == 0) { // address column
 			bool ok;
 			const edb::address_t address = edb::v1::string_to_address(it->text(), &ok);
 			if(ok) {
-				edb::v1::remove_breakpoint(address);
+				addresses.push_back(address);
 			}
 		}
 	}
+
+	edb::v1::remove_breakpoints(addresses);
 	updateList();
 }
 
@@ -206,5 +235,21 @@ void DialogBreakpoints::on_tableWidget_cellDoubleClicked(int row, int col) {
 			}
 			break;
 		}
+		case 5: // ignore count
+		{
+			if(QTableWidgetItem *const address_item = ui->tableWidget->item(row, 0)) {
+				bool ok;
+				const edb::address_t address = edb::v1::string_to_address(address_item->text(), &ok);
+				if(ok) {
+					const unsigned int count = edb::v1::get_breakpoint_ignore_count(address);
+					const int value = QInputDialog::getInt(this, tr("Set Breakpoint Ignore Count"), tr("Hits to ignore:"), count, 0, INT_MAX, 1, &ok);
+					if(ok) {
+						edb::v1::set_breakpoint_ignore_count(address, value);
+						updateList();
+					}
+				}
+			}
+			break;
+		}
 	}
 }
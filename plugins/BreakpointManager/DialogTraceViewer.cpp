@@ -0,0 +1,148 @@
+/*
+Copyright (C) 2006 - 2013 Evan Teran
+                          eteran@alum.rit.edu
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "DialogTraceViewer.h"
+#include "TraceFile.h"
+#include "edb.h"
+
+#include <QDateTime>
+#include <QFileDialog>
+#include <QHeaderView>
+#include <QMessageBox>
+
+#include "ui_dialogtraceviewer.h"
+
+//------------------------------------------------------------------------------
+// Name: DialogTraceViewer
+// Desc:
+//------------------------------------------------------------------------------
+DialogTraceViewer::DialogTraceViewer(QWidget *parent) : QDialog(parent), ui(new Ui::DialogTraceViewer) {
+	ui->setupUi(this);
+#if QT_VERSION >= 0x050000
+	ui->tableWidget->horizontalHeader()->setSectionResizeMode(QHeaderView::ResizeToContents);
+#else
+	ui->tableWidget->horizontalHeader()->setResizeMode(QHeaderView::ResizeToContents);
+#endif
+}
+
+//------------------------------------------------------------------------------
+// Name: ~DialogTraceViewer
+// Desc:
+//------------------------------------------------------------------------------
+DialogTraceViewer::~DialogTraceViewer() {
+	delete ui;
+}
+
+//------------------------------------------------------------------------------
+// Name: showEvent
+// Desc: shows the trace of the current session unless another file was opened
+//------------------------------------------------------------------------------
+void DialogTraceViewer::showEvent(QShowEvent *) {
+	if(filename_.isEmpty()) {
+		filename_ = edb::v1::trace_file_name();
+	}
+
+	on_btnRefresh_clicked();
+}
+
+//------------------------------------------------------------------------------
+// Name: on_btnOpen_clicked
+// Desc:
+//------------------------------------------------------------------------------
+void DialogTraceViewer::on_btnOpen_clicked() {
+	const QString filename = QFileDialog::getOpenFileName(this, tr("Open Trace File"), filename_, tr("Trace Files (*.edbtrace);;All Files (*)"));
+	if(!filename.isEmpty()) {
+		filename_ = filename;
+		load(filename_);
+	}
+}
+
+//------------------------------------------------------------------------------
+// Name: on_btnRefresh_clicked
+// Desc: re-reads the file, after making sure the recorder has written out all
+//       it has
+//------------------------------------------------------------------------------
+void DialogTraceViewer::on_btnRefresh_clicked() {
+	edb::v1::flush_trace();
+	load(filename_);
+}
+
+//------------------------------------------------------------------------------
+// Name: load
+// Desc:
+//------------------------------------------------------------------------------
+void DialogTraceViewer::load(const QString &filename) {
+
+	ui->tableWidget->setSortingEnabled(false);
+	ui->tableWidget->setRowCount(0);
+
+	if(filename.isEmpty()) {
+		ui->labelFile->setText(tr("Nothing has been traced yet."));
+		return;
+	}
+
+	TraceFile trace;
+	if(!trace.load(filename)) {
+		ui->labelFile->setText(filename);
+		QMessageBox::information(this, tr("Could Not Read Trace"), trace.error_string());
+		return;
+	}
+
+	const QHash<quint32, TraceFile::TracepointInfo> tracepoints = trace.tracepoints();
+	const QList<TraceFile::Hit> hits                             = trace.hits();
+
+	if(trace.dropped() != 0) {
+		ui->labelFile->setText(tr("%1: %2 hits, %3 dropped").arg(filename).arg(hits.size()).arg(trace.dropped()));
+	} else {
+		ui->labelFile->setText(tr("%1: %2 hits").arg(filename).arg(hits.size()));
+	}
+
+	ui->tableWidget->setRowCount(hits.size());
+
+	int row = 0;
+	Q_FOREACH(const TraceFile::Hit &hit, hits) {
+
+		const TraceFile::TracepointInfo info = tracepoints.value(hit.tracepoint);
+
+		QStringList registers;
+		for(int i = 0; i < hit.registers.size(); ++i) {
+			const QString name = (i < info.registers.size()) ? info.registers[i] : QString::number(i);
+			registers << QString("%1=%2").arg(name, edb::v1::format_pointer(hit.registers[i]));
+		}
+
+		QString memory;
+		if(!hit.memory.isEmpty()) {
+			memory = QString("%1: %2").arg(edb::v1::format_pointer(hit.memory_address), edb::v1::format_bytes(hit.memory));
+		}
+
+		QStringList backtrace;
+		Q_FOREACH(edb::address_t address, hit.backtrace) {
+			backtrace << edb::v1::format_pointer(address);
+		}
+
+		ui->tableWidget->setItem(row, 0, new QTableWidgetItem(QDateTime::fromMSecsSinceEpoch(hit.timestamp).toString("hh:mm:ss.zzz")));
+		ui->tableWidget->setItem(row, 1, new QTableWidgetItem(QString::number(hit.tid)));
+		ui->tableWidget->setItem(row, 2, new QTableWidgetItem(edb::v1::format_pointer(hit.address)));
+		ui->tableWidget->setItem(row, 3, new QTableWidgetItem(registers.join(" ")));
+		ui->tableWidget->setItem(row, 4, new QTableWidgetItem(memory));
+		ui->tableWidget->setItem(row, 5, new QTableWidgetItem(backtrace.join(" ")));
+		++row;
+	}
+
+	ui->tableWidget->setSortingEnabled(true);
+}
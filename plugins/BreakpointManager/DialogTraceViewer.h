@@ -0,0 +1,48 @@
+/*
+Copyright (C) 2006 - 2013 Evan Teran
+                          eteran@alum.rit.edu
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef DIALOGTRACEVIEWER_20131020_H_
+#define DIALOGTRACEVIEWER_20131020_H_
+
+#include <QDialog>
+
+namespace Ui { class DialogTraceViewer; }
+
+class DialogTraceViewer : public QDialog {
+	Q_OBJECT
+
+public:
+	DialogTraceViewer(QWidget *parent = 0);
+	virtual ~DialogTraceViewer();
+
+public Q_SLOTS:
+	void on_btnOpen_clicked();
+	void on_btnRefresh_clicked();
+
+private:
+	virtual void showEvent(QShowEvent *event);
+
+private:
+	void load(const QString &filename);
+
+private:
+	 Ui::DialogTraceViewer *const ui;
+	 QString                      filename_;
+};
+
+#endif
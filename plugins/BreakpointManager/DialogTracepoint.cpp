@@ -0,0 +1,83 @@
+/*
+Copyright (C) 2006 - 2013 Evan Teran
+                          eteran@alum.rit.edu
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "DialogTracepoint.h"
+#include "Expression.h"
+#include "edb.h"
+
+#include <QMessageBox>
+#include <QRegExp>
+
+#include "ui_dialogtracepoint.h"
+
+//------------------------------------------------------------------------------
+// Name: DialogTracepoint
+// Desc:
+//------------------------------------------------------------------------------
+DialogTracepoint::DialogTracepoint(QWidget *parent) : QDialog(parent), ui(new Ui::DialogTracepoint), address_(0) {
+	ui->setupUi(this);
+}
+
+//------------------------------------------------------------------------------
+// Name: ~DialogTracepoint
+// Desc:
+//------------------------------------------------------------------------------
+DialogTracepoint::~DialogTracepoint() {
+	delete ui;
+}
+
+//------------------------------------------------------------------------------
+// Name: address
+// Desc:
+//------------------------------------------------------------------------------
+edb::address_t DialogTracepoint::address() const {
+	return address_;
+}
+
+//------------------------------------------------------------------------------
+// Name: tracepoint
+// Desc: what the user asked to have recorded
+//------------------------------------------------------------------------------
+Tracepoint::pointer DialogTracepoint::tracepoint() const {
+	Tracepoint::pointer tracepoint(new Tracepoint);
+	tracepoint->registers         = ui->txtRegisters->text().toLower().split(QRegExp("[,\\s]+"), QString::SkipEmptyParts);
+	tracepoint->memory_expression = ui->txtMemory->text().trimmed();
+	tracepoint->memory_size       = ui->spinMemorySize->value();
+	tracepoint->backtrace_depth   = ui->spinBacktrace->value();
+	return tracepoint;
+}
+
+//------------------------------------------------------------------------------
+// Name: on_buttonBox_accepted
+// Desc: only closes the dialog once the address makes sense
+//------------------------------------------------------------------------------
+void DialogTracepoint::on_buttonBox_accepted() {
+
+	Expression<edb::address_t> expr(ui->txtAddress->text(), edb::v1::get_variable, edb::v1::get_value);
+	ExpressionError err;
+
+	bool ok;
+	const edb::address_t address = expr.evaluate_expression(&ok, &err);
+	if(!ok) {
+		QMessageBox::information(this, tr("Error In Address Expression!"), err.what());
+		return;
+	}
+
+	address_ = address;
+	accept();
+}
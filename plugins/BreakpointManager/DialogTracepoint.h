@@ -0,0 +1,48 @@
+/*
+Copyright (C) 2006 - 2013 Evan Teran
+                          eteran@alum.rit.edu
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef DIALOGTRACEPOINT_20131020_H_
+#define DIALOGTRACEPOINT_20131020_H_
+
+#include "Tracepoint.h"
+#include "Types.h"
+
+#include <QDialog>
+
+namespace Ui { class DialogTracepoint; }
+
+class DialogTracepoint : public QDialog {
+	Q_OBJECT
+
+public:
+	DialogTracepoint(QWidget *parent = 0);
+	virtual ~DialogTracepoint();
+
+public:
+	edb::address_t address() const;
+	Tracepoint::pointer tracepoint() const;
+
+public Q_SLOTS:
+	void on_buttonBox_accepted();
+
+private:
+	 Ui::DialogTracepoint *const ui;
+	 edb::address_t              address_;
+};
+
+#endif
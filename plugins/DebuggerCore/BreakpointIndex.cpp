@@ -0,0 +1,347 @@
+/*
+Copyright (C) 2006 - 2013 Evan Teran
+                          eteran@alum.rit.edu
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "BreakpointIndex.h"
+
+#include <QReadLocker>
+#include <QWriteLocker>
+
+#include <algorithm>
+
+namespace {
+	// the filter works in 4k pages whatever the real page size is, it only has
+	// to say where there definitely are no breakpoints
+	const int FilterBits = 1 << 16;
+	const int PageShift  = 12;
+
+	// ranges covering more pages than this skip the filter
+	const std::size_t MaxFilterPages = 64;
+
+	bool entry_less(const BreakpointIndex::Entry &entry, edb::address_t address) {
+		return entry.address < address;
+	}
+
+	bool entry_order(const BreakpointIndex::Entry &lhs, const BreakpointIndex::Entry &rhs) {
+		return lhs.address < rhs.address;
+	}
+
+	bool entry_equal(const BreakpointIndex::Entry &lhs, const BreakpointIndex::Entry &rhs) {
+		return lhs.address == rhs.address;
+	}
+
+	bool entry_removed(const BreakpointIndex::Entry &entry) {
+		return !entry.breakpoint;
+	}
+}
+
+//------------------------------------------------------------------------------
+// Name: BreakpointIndex
+// Desc:
+//------------------------------------------------------------------------------
+BreakpointIndex::BreakpointIndex() : filter_(FilterBits), removed_(0) {
+}
+
+//------------------------------------------------------------------------------
+// Name: filter_bit
+// Desc: the bit which stands for the page holding <address>
+//------------------------------------------------------------------------------
+int BreakpointIndex::filter_bit(edb::address_t address) {
+	const edb::address_t page = address >> PageShift;
+	return static_cast<int>((page ^ (page >> 16)) & (FilterBits - 1));
+}
+
+//------------------------------------------------------------------------------
+// Name: may_contain
+// Desc: returns false if there definitely is no breakpoint in the range
+//------------------------------------------------------------------------------
+bool BreakpointIndex::may_contain(edb::address_t address, std::size_t len) const {
+
+	if(entries_.isEmpty() || len == 0) {
+		return false;
+	}
+
+	const edb::address_t first_page = address >> PageShift;
+	const edb::address_t last_page  = (address + len - 1) >> PageShift;
+
+	if(last_page - first_page >= MaxFilterPages) {
+		return true;
+	}
+
+	for(edb::address_t page = first_page; page <= last_page; ++page) {
+		if(filter_.testBit(filter_bit(page << PageShift))) {
+			return true;
+		}
+	}
+
+	return false;
+}
+
+//------------------------------------------------------------------------------
+// Name: lower_bound
+// Desc: the first entry at or above <address>
+//------------------------------------------------------------------------------
+BreakpointIndex::const_iterator BreakpointIndex::lower_bound(edb::address_t address) const {
+	return std::lower_bound(entries_.constBegin(), entries_.constEnd(), address, entry_less);
+}
+
+//------------------------------------------------------------------------------
+// Name: find
+// Desc: returns the breakpoint at <address> or IBreakpoint::pointer()
+//------------------------------------------------------------------------------
+IBreakpoint::pointer BreakpointIndex::find(edb::address_t address) const {
+	QReadLocker locker(&lock_);
+	return find_entry(address);
+}
+
+//------------------------------------------------------------------------------
+// Name: find_entry
+// Desc: find, for when the lock is already held
+//------------------------------------------------------------------------------
+IBreakpoint::pointer BreakpointIndex::find_entry(edb::address_t address) const {
+
+	if(may_contain(address, 1)) {
+		const const_iterator it = lower_bound(address);
+		if(it != entries_.constEnd() && it->address == address) {
+			return it->breakpoint;
+		}
+	}
+
+	return IBreakpoint::pointer();
+}
+
+//------------------------------------------------------------------------------
+// Name: contains
+// Desc:
+//------------------------------------------------------------------------------
+bool BreakpointIndex::contains(edb::address_t address) const {
+	QReadLocker locker(&lock_);
+	return !find_entry(address).isNull();
+}
+
+//------------------------------------------------------------------------------
+// Name: range
+// Desc: the breakpoints at <address> up to <address> + <len>, in order. They
+//       are copied out, as the array may change as soon as the lock is let go
+//------------------------------------------------------------------------------
+QList<IBreakpoint::pointer> BreakpointIndex::range(edb::address_t address, std::size_t len) const {
+	QReadLocker locker(&lock_);
+
+	QList<IBreakpoint::pointer> ret;
+	if(may_contain(address, len)) {
+		const const_iterator first = lower_bound(address);
+		const const_iterator last  = std::lower_bound(first, entries_.constEnd(), address + len, entry_less);
+		for(const_iterator it = first; it != last; ++it) {
+			if(it->breakpoint) {
+				ret.push_back(it->breakpoint);
+			}
+		}
+	}
+	return ret;
+}
+
+//------------------------------------------------------------------------------
+// Name: size
+// Desc:
+//------------------------------------------------------------------------------
+int BreakpointIndex::size() const {
+	QReadLocker locker(&lock_);
+	return entries_.size() - removed_;
+}
+
+//------------------------------------------------------------------------------
+// Name: empty
+// Desc:
+//------------------------------------------------------------------------------
+bool BreakpointIndex::empty() const {
+	QReadLocker locker(&lock_);
+	return entries_.size() == removed_;
+}
+
+//------------------------------------------------------------------------------
+// Name: addresses
+// Desc: the address of every breakpoint, in order
+//------------------------------------------------------------------------------
+QList<edb::address_t> BreakpointIndex::addresses() const {
+	QReadLocker locker(&lock_);
+
+	QList<edb::address_t> ret;
+	ret.reserve(entries_.size() - removed_);
+	Q_FOREACH(const Entry &entry, entries_) {
+		if(entry.breakpoint) {
+			ret.push_back(entry.address);
+		}
+	}
+	return ret;
+}
+
+//------------------------------------------------------------------------------
+// Name: to_list
+// Desc: every breakpoint, the way IDebuggerCore hands them out
+//------------------------------------------------------------------------------
+IDebuggerCore::BreakpointList BreakpointIndex::to_list() const {
+	QReadLocker locker(&lock_);
+
+	IDebuggerCore::BreakpointList ret;
+	ret.reserve(entries_.size() - removed_);
+	Q_FOREACH(const Entry &entry, entries_) {
+		if(entry.breakpoint) {
+			ret.insert(entry.address, entry.breakpoint);
+		}
+	}
+	return ret;
+}
+
+//------------------------------------------------------------------------------
+// Name: insert
+// Desc: adds a breakpoint, replacing any which is already at its address
+//------------------------------------------------------------------------------
+void BreakpointIndex::insert(const IBreakpoint::pointer &bp) {
+
+	Q_ASSERT(bp);
+
+	QWriteLocker locker(&lock_);
+
+	const edb::address_t address = bp->address();
+	const int n = lower_bound(address) - entries_.constBegin();
+
+	if(n != entries_.size() && entries_[n].address == address) {
+		if(!entries_[n].breakpoint) {
+			--removed_;
+		}
+		entries_[n].breakpoint = bp;
+	} else {
+		Entry entry;
+		entry.address    = address;
+		entry.breakpoint = bp;
+		entries_.insert(n, entry);
+	}
+
+	filter_.setBit(filter_bit(address));
+}
+
+//------------------------------------------------------------------------------
+// Name: insert
+// Desc: adds many breakpoints with a single sort, instead of shifting the
+//       array once for each of them. Addresses which already have a
+//       breakpoint keep it
+//------------------------------------------------------------------------------
+void BreakpointIndex::insert(const QList<IBreakpoint::pointer> &bps) {
+
+	if(bps.isEmpty()) {
+		return;
+	}
+
+	QWriteLocker locker(&lock_);
+
+	compact();
+
+	entries_.reserve(entries_.size() + bps.size());
+	Q_FOREACH(const IBreakpoint::pointer &bp, bps) {
+		Q_ASSERT(bp);
+		Entry entry;
+		entry.address    = bp->address();
+		entry.breakpoint = bp;
+		entries_.push_back(entry);
+		filter_.setBit(filter_bit(entry.address));
+	}
+
+	std::stable_sort(entries_.begin(), entries_.end(), entry_order);
+	entries_.erase(std::unique(entries_.begin(), entries_.end(), entry_equal), entries_.end());
+}
+
+//------------------------------------------------------------------------------
+// Name: remove
+// Desc: removes the breakpoint at <address>, this only clears its slot
+//------------------------------------------------------------------------------
+void BreakpointIndex::remove(edb::address_t address) {
+
+	QWriteLocker locker(&lock_);
+
+	if(!may_contain(address, 1)) {
+		return;
+	}
+
+	const int n = lower_bound(address) - entries_.constBegin();
+	if(n != entries_.size() && entries_[n].address == address && entries_[n].breakpoint) {
+		entries_[n].breakpoint.clear();
+		++removed_;
+
+		// amortized, a compaction pays for at least as many removals as there
+		// are breakpoints left
+		if(removed_ > entries_.size() / 2) {
+			compact();
+		}
+	}
+}
+
+//------------------------------------------------------------------------------
+// Name: remove
+// Desc: removes the breakpoints at each of the addresses and compacts once
+//------------------------------------------------------------------------------
+void BreakpointIndex::remove(const QList<edb::address_t> &addresses) {
+
+	QWriteLocker locker(&lock_);
+
+	Q_FOREACH(edb::address_t address, addresses) {
+		if(may_contain(address, 1)) {
+			const int n = lower_bound(address) - entries_.constBegin();
+			if(n != entries_.size() && entries_[n].address == address && entries_[n].breakpoint) {
+				entries_[n].breakpoint.clear();
+				++removed_;
+			}
+		}
+	}
+
+	compact();
+}
+
+//------------------------------------------------------------------------------
+// Name: clear
+// Desc:
+//------------------------------------------------------------------------------
+void BreakpointIndex::clear() {
+	QWriteLocker locker(&lock_);
+
+	entries_.clear();
+	filter_.fill(false);
+	removed_ = 0;
+}
+
+//------------------------------------------------------------------------------
+// Name: compact
+// Desc: drops the cleared slots and the filter bits which only they needed
+// Note: the lock must be held for writing
+//------------------------------------------------------------------------------
+void BreakpointIndex::compact() {
+	if(removed_ != 0) {
+		entries_.erase(std::remove_if(entries_.begin(), entries_.end(), entry_removed), entries_.end());
+		removed_ = 0;
+		rebuild_filter();
+	}
+}
+
+//------------------------------------------------------------------------------
+// Name: rebuild_filter
+// Desc:
+//------------------------------------------------------------------------------
+void BreakpointIndex::rebuild_filter() {
+	filter_.fill(false);
+	Q_FOREACH(const Entry &entry, entries_) {
+		filter_.setBit(filter_bit(entry.address));
+	}
+}
@@ -0,0 +1,83 @@
+/*
+Copyright (C) 2006 - 2013 Evan Teran
+                          eteran@alum.rit.edu
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef BREAKPOINT_INDEX_20131101_H_
+#define BREAKPOINT_INDEX_20131101_H_
+
+#include "IDebuggerCore.h"
+
+#include <QBitArray>
+#include <QList>
+#include <QReadWriteLock>
+#include <QVector>
+
+// the core's breakpoints, kept in a flat array sorted by address. A bitmap
+// with a bit per (hashed) page sits in front of it, so looking up an address
+// which has no breakpoint, which is what nearly every lookup does, usually
+// costs one bit test. Everything else is a binary search.
+//
+// Removing a single breakpoint only clears its slot, the array is compacted
+// once enough of them have piled up.
+//
+// Memory reads mask the breakpoints from any thread while the debugger adds
+// and removes them, so every member takes the lock, and nothing hands out
+// iterators into the array, which a compaction would pull out from under them
+class BreakpointIndex {
+public:
+	struct Entry {
+		edb::address_t       address;
+		IBreakpoint::pointer breakpoint;
+	};
+
+	typedef QVector<Entry>::const_iterator const_iterator;
+
+public:
+	BreakpointIndex();
+
+public:
+	IBreakpoint::pointer find(edb::address_t address) const;
+	bool contains(edb::address_t address) const;
+	QList<IBreakpoint::pointer> range(edb::address_t address, std::size_t len) const;
+	int size() const;
+	bool empty() const;
+	QList<edb::address_t> addresses() const;
+	IDebuggerCore::BreakpointList to_list() const;
+
+public:
+	void insert(const IBreakpoint::pointer &bp);
+	void insert(const QList<IBreakpoint::pointer> &bps);
+	void remove(edb::address_t address);
+	void remove(const QList<edb::address_t> &addresses);
+	void clear();
+
+private:
+	static int filter_bit(edb::address_t address);
+	IBreakpoint::pointer find_entry(edb::address_t address) const;
+	bool may_contain(edb::address_t address, std::size_t len) const;
+	const_iterator lower_bound(edb::address_t address) const;
+	void compact();
+	void rebuild_filter();
+
+private:
+	mutable QReadWriteLock lock_;
+	QVector<Entry>         entries_;
+	QBitArray              filter_;
+	int                    removed_;
+};
+
+#endif
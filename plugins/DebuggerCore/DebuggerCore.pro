@@ -11,6 +11,9 @@ unix {
 	linux-* {
 		VPATH       += unix/linux
 		INCLUDEPATH += unix/linux
+
+		HEADERS += PtraceThread.h
+		SOURCES += PtraceThread.cpp
 	}
 
 	openbsd-* {
@@ -34,5 +37,5 @@ win32 {
 	INCLUDEPATH += win32 .
 }
 
-HEADERS += PlatformEvent.h   PlatformState.h   PlatformRegion.h   DebuggerCoreBase.h   DebuggerCore.h   X86Breakpoint.h
-SOURCES += PlatformEvent.cpp PlatformState.cpp PlatformRegion.cpp DebuggerCoreBase.cpp DebuggerCore.cpp X86Breakpoint.cpp
+HEADERS += PlatformEvent.h   PlatformState.h   PlatformRegion.h   DebuggerCoreBase.h   DebuggerCore.h   X86Breakpoint.h   BreakpointIndex.h
+SOURCES += PlatformEvent.cpp PlatformState.cpp PlatformRegion.cpp DebuggerCoreBase.cpp DebuggerCore.cpp X86Breakpoint.cpp BreakpointIndex.cpp
@@ -19,11 +19,41 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #include "DebuggerCoreBase.h"
 #include "X86Breakpoint.h"
 
+#include <QMap>
+
+#include <algorithm>
+#include <cstring>
+
+namespace {
+	// if a single stop reads more than this many pages, just start over
+	// rather than letting the cache grow without bound
+	const int MaxCachedPages = 4096;
+
+	typedef QMap<edb::address_t, QList<edb::address_t> > PageMap;
+
+	//--------------------------------------------------------------------------
+	// Name: group_by_page
+	// Desc: sorts the addresses, drops the duplicates and splits them up by
+	//       the page that they are on
+	//--------------------------------------------------------------------------
+	PageMap group_by_page(QList<edb::address_t> addresses, edb::address_t page_size) {
+
+		std::sort(addresses.begin(), addresses.end());
+		addresses.erase(std::unique(addresses.begin(), addresses.end()), addresses.end());
+
+		PageMap pages;
+		Q_FOREACH(edb::address_t address, addresses) {
+			pages[address & ~(page_size - 1)].push_back(address);
+		}
+		return pages;
+	}
+}
+
 //------------------------------------------------------------------------------
 // Name: DebuggerCoreBase
 // Desc: constructor
 //------------------------------------------------------------------------------
-DebuggerCoreBase::DebuggerCoreBase() : active_thread_(0), pid_(0) {
+DebuggerCoreBase::DebuggerCoreBase() : active_thread_(0), pid_(0), page_cache_hits_(0), page_cache_misses_(0) {
 }
 
 //------------------------------------------------------------------------------
@@ -39,7 +69,7 @@ DebuggerCoreBase::~DebuggerCoreBase() {
 //------------------------------------------------------------------------------
 void DebuggerCoreBase::clear_breakpoints() {
 	if(attached()) {
-		breakpoints_.clear();
+		remove_breakpoints(breakpoints_.addresses());
 	}
 }
 
@@ -53,7 +83,7 @@ IBreakpoint::pointer DebuggerCoreBase::add_breakpoint(edb::address_t address) {
 	if(attached()) {
 		if(!find_breakpoint(address)) {
 			IBreakpoint::pointer bp(new X86Breakpoint(address));
-			breakpoints_[address] = bp;
+			breakpoints_.insert(bp);
 			return bp;
 		}
 	}
@@ -67,10 +97,7 @@ IBreakpoint::pointer DebuggerCoreBase::add_breakpoint(edb::address_t address) {
 //------------------------------------------------------------------------------
 IBreakpoint::pointer DebuggerCoreBase::find_breakpoint(edb::address_t address) {
 	if(attached()) {
-		const BreakpointList::const_iterator it = breakpoints_.find(address);
-		if(it != breakpoints_.end()) {
-			return it.value();
-		}
+		return breakpoints_.find(address);
 	}
 	return IBreakpoint::pointer();
 }
@@ -87,11 +114,115 @@ void DebuggerCoreBase::remove_breakpoint(edb::address_t address) {
 
 	// TODO: assert paused
 	if(attached()) {
-		const BreakpointList::iterator it = breakpoints_.find(address);
-		if(it != breakpoints_.end()) {
-			breakpoints_.erase(it);
+		breakpoints_.remove(address);
+	}
+}
+
+//------------------------------------------------------------------------------
+// Name: add_breakpoints
+// Desc: creates a breakpoint at each address which doesn't have one yet. For
+//       each page, the bytes spanning its new breakpoints are read once,
+//       patched and written back once
+//------------------------------------------------------------------------------
+QList<IBreakpoint::pointer> DebuggerCoreBase::add_breakpoints(const QList<edb::address_t> &addresses) {
+
+	QList<IBreakpoint::pointer> ret;
+
+	if(!attached()) {
+		return ret;
+	}
+
+	QList<edb::address_t> wanted;
+	Q_FOREACH(edb::address_t address, addresses) {
+		if(!breakpoints_.contains(address)) {
+			wanted.push_back(address);
+		}
+	}
+
+	const PageMap pages = group_by_page(wanted, page_size());
+
+	QList<IBreakpoint::pointer> created;
+	for(PageMap::const_iterator it = pages.begin(); it != pages.end(); ++it) {
+		const QList<edb::address_t> &page_addresses = it.value();
+		const edb::address_t first = page_addresses.front();
+		const std::size_t    len   = page_addresses.back() - first + X86Breakpoint::size;
+
+		// the other breakpoints in here read back as their original bytes and
+		// are shadowed again when this is written
+		QByteArray bytes(static_cast<int>(len), 0);
+		if(!read_bytes(first, bytes.data(), len)) {
+			continue;
+		}
+
+		const QByteArray original = bytes;
+		Q_FOREACH(edb::address_t address, page_addresses) {
+			std::memcpy(bytes.data() + (address - first), X86Breakpoint::instruction, X86Breakpoint::size);
+		}
+
+		if(!write_bytes(first, bytes.constData(), len)) {
+			continue;
+		}
+
+		Q_FOREACH(edb::address_t address, page_addresses) {
+			created.push_back(IBreakpoint::pointer(new X86Breakpoint(address, original.mid(static_cast<int>(address - first), X86Breakpoint::size))));
 		}
 	}
+
+	// they only go in the list once memory is patched, otherwise the writes
+	// above would take them for existing breakpoints to shadow
+	breakpoints_.insert(created);
+
+	return created;
+}
+
+//------------------------------------------------------------------------------
+// Name: remove_breakpoints
+// Desc: removes the breakpoints at each of the addresses, restoring the
+//       original bytes a page at a time. Unlike remove_breakpoint, the bytes
+//       are restored right away even if someone still holds a reference
+//------------------------------------------------------------------------------
+void DebuggerCoreBase::remove_breakpoints(const QList<edb::address_t> &addresses) {
+
+	if(!attached()) {
+		return;
+	}
+
+	QList<edb::address_t> enabled;
+	Q_FOREACH(edb::address_t address, addresses) {
+		const IBreakpoint::pointer bp = breakpoints_.find(address);
+		if(bp && bp->enabled()) {
+			enabled.push_back(address);
+		}
+	}
+
+	const PageMap pages = group_by_page(enabled, page_size());
+
+	for(PageMap::const_iterator it = pages.begin(); it != pages.end(); ++it) {
+		const QList<edb::address_t> &page_addresses = it.value();
+		const edb::address_t first = page_addresses.front();
+		const std::size_t    len   = page_addresses.back() - first + X86Breakpoint::size;
+
+		// every breakpoint reads back as its original bytes, so once the ones
+		// going away are marked disabled this puts their bytes back while the
+		// rest stay shadowed
+		QByteArray bytes(static_cast<int>(len), 0);
+		if(!read_bytes(first, bytes.data(), len)) {
+			continue;
+		}
+
+		Q_FOREACH(edb::address_t address, page_addresses) {
+			// all of our breakpoints are created by DebuggerCoreBase
+			static_cast<X86Breakpoint *>(breakpoints_.find(address).data())->set_enabled(false);
+		}
+
+		if(!write_bytes(first, bytes.constData(), len)) {
+			Q_FOREACH(edb::address_t address, page_addresses) {
+				static_cast<X86Breakpoint *>(breakpoints_.find(address).data())->set_enabled(true);
+			}
+		}
+	}
+
+	breakpoints_.remove(addresses);
 }
 
 //------------------------------------------------------------------------------
@@ -100,7 +231,7 @@ void DebuggerCoreBase::remove_breakpoint(edb::address_t address) {
 //       preventing full removal until this list is destructed.
 //------------------------------------------------------------------------------
 DebuggerCoreBase::BreakpointList DebuggerCoreBase::backup_breakpoints() const {
-	return breakpoints_;
+	return breakpoints_.to_list();
 }
 
 //------------------------------------------------------------------------------
@@ -111,6 +242,27 @@ bool DebuggerCoreBase::open(const QString &path, const QString &cwd, const QList
 	return open(path, cwd, args, QString());
 }
 
+//------------------------------------------------------------------------------
+// Name: read_ranges
+// Desc: reads each of the ranges with read_bytes, which only succeeds if all of
+//       a range could be read. Cores which can do better than this should
+//       override it
+//------------------------------------------------------------------------------
+bool DebuggerCoreBase::read_ranges(MemoryRangeList *ranges) {
+
+	Q_ASSERT(ranges);
+
+	if(!attached()) {
+		return false;
+	}
+
+	for(MemoryRangeList::iterator it = ranges->begin(); it != ranges->end(); ++it) {
+		it->ok = read_bytes(it->address, it->buffer, it->length);
+	}
+
+	return true;
+}
+
 //------------------------------------------------------------------------------
 // Name: pid
 // Desc: returns the pid of the currently debugged process (0 if not attached)
@@ -157,3 +309,73 @@ void DebuggerCoreBase::set_active_thread(edb::tid_t) {
 int DebuggerCoreBase::breakpoint_size() const {
 	return X86Breakpoint::size;
 }
+
+//------------------------------------------------------------------------------
+// Name: event_fd
+// Desc: by default there is nothing to wait on, the core has to be polled
+//------------------------------------------------------------------------------
+int DebuggerCoreBase::event_fd() const {
+	return -1;
+}
+
+//------------------------------------------------------------------------------
+// Name: cached_page
+// Desc: returns the contents of the page starting at <page> if it has been read
+//       since the process was last allowed to run, otherwise returns a null
+//       byte array
+// Note: the cache may be used from more than one thread, so a (shallow) copy
+//       is handed out rather than a pointer into it
+//------------------------------------------------------------------------------
+QByteArray DebuggerCoreBase::cached_page(edb::address_t page) {
+	QMutexLocker locker(&page_cache_mutex_);
+
+	const QHash<edb::address_t, QByteArray>::const_iterator it = page_cache_.constFind(page);
+	if(it != page_cache_.constEnd()) {
+		++page_cache_hits_;
+		return *it;
+	}
+
+	++page_cache_misses_;
+	return QByteArray();
+}
+
+//------------------------------------------------------------------------------
+// Name: page_cache_statistics
+// Desc:
+//------------------------------------------------------------------------------
+bool DebuggerCoreBase::page_cache_statistics(quint64 *hits, quint64 *misses) const {
+	Q_ASSERT(hits);
+	Q_ASSERT(misses);
+
+	QMutexLocker locker(&page_cache_mutex_);
+	*hits   = page_cache_hits_;
+	*misses = page_cache_misses_;
+	return true;
+}
+
+//------------------------------------------------------------------------------
+// Name: cache_page
+// Desc: remembers the contents of a page until the cache is invalidated
+// Note: the data should be what is really in the process, breakpoints and all
+//------------------------------------------------------------------------------
+void DebuggerCoreBase::cache_page(edb::address_t page, const QByteArray &data) {
+	Q_ASSERT(static_cast<edb::address_t>(data.size()) == page_size());
+
+	QMutexLocker locker(&page_cache_mutex_);
+
+	if(page_cache_.size() >= MaxCachedPages) {
+		page_cache_.clear();
+	}
+
+	page_cache_.insert(page, data);
+}
+
+//------------------------------------------------------------------------------
+// Name: invalidate_page_cache
+// Desc: forgets all cached pages, must be called whenever the memory of the
+//       process may have changed (it was resumed, stepped or written to)
+//------------------------------------------------------------------------------
+void DebuggerCoreBase::invalidate_page_cache() {
+	QMutexLocker locker(&page_cache_mutex_);
+	page_cache_.clear();
+}
@@ -19,7 +19,9 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #ifndef DEBUGGERCOREBASE_20090529_H_
 #define DEBUGGERCOREBASE_20090529_H_
 
+#include "BreakpointIndex.h"
 #include "IDebuggerCore.h"
+#include <QMutex>
 
 class DebuggerCoreBase : public QObject, public IDebuggerCore {
 public:
@@ -43,17 +45,37 @@ public:
 	virtual int breakpoint_size() const;
 	virtual void clear_breakpoints();
 	virtual void remove_breakpoint(edb::address_t address);
+	virtual QList<IBreakpoint::pointer> add_breakpoints(const QList<edb::address_t> &addresses);
+	virtual void remove_breakpoints(const QList<edb::address_t> &addresses);
+
+public:
+	virtual bool read_ranges(MemoryRangeList *ranges);
 
 public:
 	virtual edb::pid_t pid() const;
+	virtual int event_fd() const;
+
+public:
+	virtual bool page_cache_statistics(quint64 *hits, quint64 *misses) const;
 
 protected:
 	bool attached() const;
 
+protected:
+	QByteArray cached_page(edb::address_t page);
+	void cache_page(edb::address_t page, const QByteArray &data);
+	void invalidate_page_cache();
+
 protected:
 	edb::tid_t      active_thread_;
 	edb::pid_t      pid_;
-	BreakpointList  breakpoints_;
+	BreakpointIndex breakpoints_;
+
+private:
+	mutable QMutex                    page_cache_mutex_;
+	QHash<edb::address_t, QByteArray> page_cache_;
+	quint64                           page_cache_hits_;
+	quint64                           page_cache_misses_;
 };
 
 #endif
@@ -20,18 +20,24 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #include "IDebuggerCore.h"
 #include "edb.h"
 
-namespace {
-const quint8 BreakpointInstruction[X86Breakpoint::size] = {0xcc};
-}
+const quint8 X86Breakpoint::instruction[X86Breakpoint::size] = {0xcc};
 
 //------------------------------------------------------------------------------
 // Name: X86Breakpoint
 // Desc: constructor
 //------------------------------------------------------------------------------
-X86Breakpoint::X86Breakpoint(edb::address_t address) : address_(address), hit_count_(0), enabled_(false), one_time_(false), internal_(false) {
+X86Breakpoint::X86Breakpoint(edb::address_t address) : address_(address), hit_count_(0), ignore_count_(0), enabled_(false), one_time_(false), internal_(false) {
 	enable();
 }
 
+//------------------------------------------------------------------------------
+// Name: X86Breakpoint
+// Desc: a breakpoint which the caller has already written to memory, over
+//       <original_bytes>
+//------------------------------------------------------------------------------
+X86Breakpoint::X86Breakpoint(edb::address_t address, const QByteArray &original_bytes) : original_bytes_(original_bytes), address_(address), hit_count_(0), ignore_count_(0), enabled_(true), one_time_(false), internal_(false) {
+}
+
 //------------------------------------------------------------------------------
 // Name: ~X86Breakpoint
 // Desc:
@@ -48,7 +54,7 @@ bool X86Breakpoint::enable() {
 	if(!enabled()) {
 		char prev[size];
 		if(edb::v1::debugger_core->read_bytes(address(), prev, size)) {
-			if(edb::v1::debugger_core->write_bytes(address(), BreakpointInstruction, size)) {
+			if(edb::v1::debugger_core->write_bytes(address(), instruction, size)) {
 				original_bytes_ = QByteArray(prev, size);
 				enabled_ = true;
 				return true;
@@ -64,10 +70,13 @@ bool X86Breakpoint::enable() {
 //------------------------------------------------------------------------------
 bool X86Breakpoint::disable() {
 	if(enabled()) {
+		// we must not be enabled while restoring the original bytes, otherwise
+		// the core will think that this is a write over an active breakpoint
+		enabled_ = false;
 		if(edb::v1::debugger_core->write_bytes(address(), original_bytes_.constData(), size)) {
-			enabled_ = false;
 			return true;
 		}
+		enabled_ = true;
 	}
 	return false;
 }
@@ -24,11 +24,13 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 class X86Breakpoint : public IBreakpoint {
 public:
 	X86Breakpoint(edb::address_t address);
+	X86Breakpoint(edb::address_t address, const QByteArray &original_bytes);
 	~X86Breakpoint();
 
 public:
 	virtual edb::address_t address() const    { return address_; }
 	virtual unsigned int hit_count() const    { return hit_count_; }
+	virtual unsigned int ignore_count() const { return ignore_count_; }
 	virtual bool enabled() const              { return enabled_; }
 	virtual bool one_time() const             { return one_time_; }
 	virtual bool internal() const             { return internal_; }
@@ -38,16 +40,25 @@ public:
 	virtual bool enable();
 	virtual bool disable();
 	virtual void hit()                    { hit_count_++; }
+	virtual void set_ignore_count(unsigned int value) { ignore_count_ = value; }
 	virtual void set_one_time(bool value) { one_time_ = value; }
 	virtual void set_internal(bool value) { internal_ = value; }
 
+public:
+	void set_original_bytes(const QByteArray &bytes) { original_bytes_ = bytes; }
+
+	// for the core's bulk operations, which patch the memory themselves
+	void set_enabled(bool value) { enabled_ = value; }
+
 public:
 	static const int size = 1;
+	static const quint8 instruction[size];
 
 private:
 	QByteArray     original_bytes_;
 	edb::address_t address_;
 	unsigned int   hit_count_;
+	unsigned int   ignore_count_;
 	bool           enabled_ ;
 	bool           one_time_;
 	bool           internal_;
@@ -19,6 +19,7 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 // this code is common to all unix variants (linux/bsd/osx)
 
 #include "DebuggerCoreUNIX.h"
+#include "X86Breakpoint.h"
 #include "edb.h"
 
 #include <QStringList>
@@ -133,7 +134,10 @@ int native::select_ex(int nfds, fd_set *readfds, fd_set *writefds, fd_set *excep
 
 //------------------------------------------------------------------------------
 // Name: wait_for_sigchld
-// Desc:
+// Desc: returns true on timeout
+// Note: signals get merged, so one notification may stand for several events,
+//       all of them are consumed at once and the caller should look for every
+//       event which is ready
 //------------------------------------------------------------------------------
 bool native::wait_for_sigchld(int msecs) {
 
@@ -145,11 +149,18 @@ bool native::wait_for_sigchld(int msecs) {
 		return true;
 	}
 
-	char ch;
-	if(native::read(selfpipe[0], &ch, sizeof(char)) == -1) {
+	char buf[64];
+	const ssize_t n = native::read(selfpipe[0], buf, sizeof(buf));
+	if(n == -1) {
 		return true;
 	}
 
+	// the pipe is non-blocking, so this stops as soon as it is empty
+	if(n == sizeof(buf)) {
+		while(native::read(selfpipe[0], buf, sizeof(buf)) > 0) {
+		}
+	}
+
 	return false;
 }
 
@@ -171,6 +182,24 @@ pid_t native::waitpid_timeout(pid_t pid, int *status, int options, int msecs, bo
 	return -1;
 }
 
+//------------------------------------------------------------------------------
+// Name: event_fd
+// Desc: the read end of the SIGCHLD self-pipe, it becomes readable whenever
+//       a child (traced or otherwise) changes state
+//------------------------------------------------------------------------------
+int DebuggerCoreUNIX::event_fd() const {
+	return selfpipe[0];
+}
+
+//------------------------------------------------------------------------------
+// Name: post_event_notification
+// Desc: makes event_fd readable for events the core already has in hand, as
+//       opposed to the ones a SIGCHLD announces
+//------------------------------------------------------------------------------
+void DebuggerCoreUNIX::post_event_notification() {
+	native::write(selfpipe[1], " ", sizeof(char));
+}
+
 //------------------------------------------------------------------------------
 // Name: DebuggerCoreUNIX
 // Desc:
@@ -201,123 +230,155 @@ DebuggerCoreUNIX::DebuggerCoreUNIX() {
 
 
 //------------------------------------------------------------------------------
-// Name: write_byte
-// Desc: writes a single byte at a given address
-// Note: assumes the this will not trample any breakpoints, must be handled
-//       in calling code!
+// Name: read_words
+// Desc: reads <len> bytes starting at <address> using word sized reads
+// Note: the range must not cross a page boundary, this way either all of it
+//       is readable or none of it is
 //------------------------------------------------------------------------------
-void DebuggerCoreUNIX::write_byte(edb::address_t address, quint8 value, bool *ok) {
-	write_byte_base(address, value, ok);
+bool DebuggerCoreUNIX::read_words(edb::address_t address, quint8 *buf, std::size_t len) {
+	// TODO: assert that we are paused
+
+	Q_ASSERT(buf);
+
+	if(!attached()) {
+		return false;
+	}
+
+	// pages are always a multiple of the word size, so an aligned word
+	// will never straddle two pages
+	const edb::address_t end_address = address + len;
+	edb::address_t word_address      = address & ~static_cast<edb::address_t>(EDB_WORDSIZE - 1);
+
+	while(word_address < end_address) {
+		bool ok;
+		const long v = read_data(word_address, &ok);
+		if(!ok) {
+			return false;
+		}
+
+		const quint8 *const bytes = reinterpret_cast<const quint8 *>(&v);
+		for(std::size_t i = 0; i < EDB_WORDSIZE; ++i) {
+			const edb::address_t a = word_address + i;
+			if(a >= address && a < end_address) {
+				buf[a - address] = bytes[i];
+			}
+		}
+
+		word_address += EDB_WORDSIZE;
+	}
+
+	return true;
 }
 
 //------------------------------------------------------------------------------
-// Name: read_byte
-// Desc: reads a single bytes at a given address
+// Name: mask_breakpoints
+// Desc: replaces any of our breakpoints which fall inside of the buffer with
+//       the original bytes that they overwrote
 //------------------------------------------------------------------------------
-quint8 DebuggerCoreUNIX::read_byte(edb::address_t address, bool *ok) {
+void DebuggerCoreUNIX::mask_breakpoints(edb::address_t address, quint8 *buf, std::size_t len) const {
 
-	// TODO: handle if breakponts have a size more than 1!
-	const quint8 ret = read_byte_base(address, ok);
+	Q_ASSERT(buf);
 
-	if(ok) {
-		if(const IBreakpoint::pointer bp = find_breakpoint(address)) {
-			return bp->original_bytes()[0];
+	// TODO: handle if breakponts have a size more than 1!
+	Q_FOREACH(const IBreakpoint::pointer &bp, breakpoints_.range(address, len)) {
+		if(bp->enabled()) {
+			// show the original bytes in the buffer..
+			buf[bp->address() - address] = bp->original_bytes()[0];
 		}
 	}
-
-	return ret;
 }
 
 //------------------------------------------------------------------------------
-// Name: write_byte_base
-// Desc: the base implementation of writing a byte
+// Name: write_words
+// Desc: writes <len> bytes from <buf> starting at <address> using word sized
+//       writes, only the unaligned head and tail need to be read first
 //------------------------------------------------------------------------------
-void DebuggerCoreUNIX::write_byte_base(edb::address_t address, quint8 value, bool *ok) {
+bool DebuggerCoreUNIX::write_words(edb::address_t address, const quint8 *buf, std::size_t len) {
 	// TODO: assert that we are paused
 
-	Q_ASSERT(ok);
+	Q_ASSERT(buf);
+
+	if(!attached()) {
+		return false;
+	}
 
-	*ok = false;
-	if(attached()) {
+	const edb::address_t end_address = address + len;
+	edb::address_t word_address      = address & ~static_cast<edb::address_t>(EDB_WORDSIZE - 1);
+
+	while(word_address < end_address) {
 		long v;
-		long mask;
-		// page_size() - 1 will always be 0xf* because pagesizes
-		// are always 0x10*, so the masking works
-		// range of a is [1..n] where n=pagesize, and we have to adjust
-		// if a < wordsize
-		const edb::address_t a = page_size() - (address & (page_size() - 1));
-
-		v = value;
-#if Q_BYTE_ORDER == Q_LITTLE_ENDIAN
-		if(a < EDB_WORDSIZE) {
-			address -= (EDB_WORDSIZE - a);                       // LE + BE
-			mask = ~(0xffUL << (CHAR_BIT * (EDB_WORDSIZE - a))); // LE
-			v <<= CHAR_BIT * (EDB_WORDSIZE - a);                 // LE
-		} else {
-			mask = ~0xffUL; // LE
-		}
-#else /* BIG ENDIAN */
-		if(a < EDB_WORDSIZE) {
-			address -= (EDB_WORDSIZE - a);            // LE + BE
-			mask = ~(0xffUL << (CHAR_BIT * (a - 1))); // BE
-			v <<= CHAR_BIT * (a - 1);                 // BE
+		quint8 *const bytes = reinterpret_cast<quint8 *>(&v);
+
+		if(word_address < address || word_address + EDB_WORDSIZE > end_address) {
+			// partial word, merge our bytes with what is already there
+			bool ok;
+			v = read_data(word_address, &ok);
+			if(!ok) {
+				return false;
+			}
+
+			for(std::size_t i = 0; i < EDB_WORDSIZE; ++i) {
+				const edb::address_t a = word_address + i;
+				if(a >= address && a < end_address) {
+					bytes[i] = buf[a - address];
+				}
+			}
 		} else {
-			mask = ~(0xffUL << (CHAR_BIT * (EDB_WORDSIZE - 1))); // BE
-			v <<= CHAR_BIT * (EDB_WORDSIZE - 1);                 // BE
+			std::memcpy(bytes, buf + (word_address - address), EDB_WORDSIZE);
 		}
-#endif
 
-		v |= (read_data(address, ok) & mask);
-		if(*ok) {
-			*ok = write_data(address, v);
+		if(!write_data(word_address, v)) {
+			return false;
 		}
+
+		word_address += EDB_WORDSIZE;
 	}
+
+	return true;
 }
 
 //------------------------------------------------------------------------------
-// Name: read_byte_base
-// Desc: the base implementation of reading a byte
+// Name: shadow_breakpoints
+// Desc: returns the bytes which should actually be written to the process.
+//       any enabled breakpoints inside of the range are kept in place, the
+//       caller is expected to pass <shadowed> to update_shadows once the write
+//       has succeeded so that they will restore the new bytes when disabled
 //------------------------------------------------------------------------------
-quint8 DebuggerCoreUNIX::read_byte_base(edb::address_t address, bool *ok) {
-	// TODO: assert that we are paused
+const quint8 *DebuggerCoreUNIX::shadow_breakpoints(edb::address_t address, const quint8 *buf, std::size_t len, QByteArray *patched, QList<IBreakpoint::pointer> *shadowed) const {
 
-	Q_ASSERT(ok);
-
-	*ok = false;
-	errno = -1;
-	if(attached()) {
-		// if this spot is unreadable, then just return 0xff, otherwise
-		// continue as normal.
+	Q_ASSERT(buf);
+	Q_ASSERT(patched);
+	Q_ASSERT(shadowed);
 
-		// page_size() - 1 will always be 0xf* because pagesizes
-		// are always 0x10*, so the masking works
-		// range of a is [1..n] where n=pagesize, and we have to adjust
-		// if a < wordsize
-		const edb::address_t a = page_size() - (address & (page_size() - 1));
+	// TODO: handle if breakponts have a size more than 1!
+	Q_FOREACH(const IBreakpoint::pointer &bp, breakpoints_.range(address, len)) {
+		if(bp->enabled()) {
+			if(patched->isEmpty()) {
+				*patched = QByteArray(reinterpret_cast<const char *>(buf), len);
+			}
 
-		if(a < EDB_WORDSIZE) {
-			address -= (EDB_WORDSIZE - a); // LE + BE
+			(*patched)[static_cast<int>(bp->address() - address)] = X86Breakpoint::instruction[0];
+			shadowed->push_back(bp);
 		}
+	}
 
-		long value = read_data(address, ok);
+	return patched->isEmpty() ? buf : reinterpret_cast<const quint8 *>(patched->constData());
+}
 
-		if(*ok) {
-#if Q_BYTE_ORDER == Q_LITTLE_ENDIAN
-			if(a < EDB_WORDSIZE) {
-				value >>= CHAR_BIT * (EDB_WORDSIZE - a); // LE
-			}
-#else
-			if(a < EDB_WORDSIZE) {
-				value >>= CHAR_BIT * (a - 1);            // BE
-			} else {
-				value >>= CHAR_BIT * (EDB_WORDSIZE - 1); // BE
-			}
-#endif
-			return value & 0xff;
-		}
-	}
+//------------------------------------------------------------------------------
+// Name: update_shadows
+// Desc: gives the breakpoints which were written over the bytes that they
+//       would have overwritten
+//------------------------------------------------------------------------------
+void DebuggerCoreUNIX::update_shadows(edb::address_t address, const quint8 *buf, const QList<IBreakpoint::pointer> &shadowed) {
+
+	Q_ASSERT(buf);
 
-	return 0xff;
+	Q_FOREACH(const IBreakpoint::pointer &bp, shadowed) {
+		// all of our breakpoints are created by DebuggerCoreBase::add_breakpoint
+		X86Breakpoint *const x86_bp = static_cast<X86Breakpoint *>(bp.data());
+		x86_bp->set_original_bytes(QByteArray(reinterpret_cast<const char *>(buf + (bp->address() - address)), X86Breakpoint::size));
+	}
 }
 
 //------------------------------------------------------------------------------
@@ -335,32 +396,16 @@ bool DebuggerCoreUNIX::read_pages(edb::address_t address, void *buf, std::size_t
 	}
 
 	if((address & (page_size() - 1)) == 0) {
-		const edb::address_t orig_address = address;
-		long *ptr                         = reinterpret_cast<long *>(buf);
-		quint8 *const orig_ptr            = reinterpret_cast<quint8 *>(buf);
-
-		const edb::address_t end_address  = orig_address + page_size() * count;
-
-		for(std::size_t c = 0; c < count; ++c) {
-			for(edb::address_t i = 0; i < page_size(); i += EDB_WORDSIZE) {
-				bool ok;
-				const long v = read_data(address, &ok);
-				if(!ok) {
-					return false;
-				}
+		quint8 *const ptr     = reinterpret_cast<quint8 *>(buf);
+		const std::size_t len = page_size() * count;
 
-				*ptr++ = v;
-				address += EDB_WORDSIZE;
+		for(std::size_t offset = 0; offset < len; offset += page_size()) {
+			if(!read_words(address + offset, ptr + offset, page_size())) {
+				return false;
 			}
 		}
 
-		// TODO: handle if breakponts have a size more than 1!
-		Q_FOREACH(const IBreakpoint::pointer &bp, breakpoints_) {
-			if(bp->address() >= orig_address && bp->address() < end_address) {
-				// show the original bytes in the buffer..
-				orig_ptr[bp->address() - orig_address] = bp->original_bytes()[0];
-			}
-		}
+		mask_breakpoints(address, ptr, len);
 	}
 
 	return true;
@@ -370,7 +415,8 @@ bool DebuggerCoreUNIX::read_pages(edb::address_t address, void *buf, std::size_t
 // Name: read_bytes
 // Desc: reads <len> bytes into <buf> starting at <address>
 // Note: if the read failed, the part of the buffer that could not be read will
-//       be filled with 0xff bytes
+//       be filled with 0xff bytes, this is done on a per page basis. Returns
+//       false if any of it could not be read
 //------------------------------------------------------------------------------
 bool DebuggerCoreUNIX::read_bytes(edb::address_t address, void *buf, std::size_t len) {
 
@@ -380,24 +426,59 @@ bool DebuggerCoreUNIX::read_bytes(edb::address_t address, void *buf, std::size_t
 		return false;
 	}
 
-	if(len != 0) {
-		bool ok;
-		quint8 *p = reinterpret_cast<quint8 *>(buf);
-		quint8 ch = read_byte(address, &ok);
-
-		while(ok && len) {
-			*p++ = ch;
-			if(--len) {
-				++address;
-				ch = read_byte(address, &ok);
-			}
+	quint8 *const ptr  = reinterpret_cast<quint8 *>(buf);
+	std::size_t offset = 0;
+	bool ok            = true;
+
+	// read one page at a time so that an unreadable page only costs us
+	// the bytes which are actually on it
+	while(offset != len) {
+		const edb::address_t page_end = ((address + offset) & ~(page_size() - 1)) + page_size();
+		const std::size_t n           = qMin<std::size_t>(page_end - (address + offset), len - offset);
+
+		if(!read_words(address + offset, ptr + offset, n)) {
+			std::memset(ptr + offset, 0xff, n);
+			ok = false;
 		}
 
-		if(!ok) {
-			while(len--) {
-				*p++ = 0xff;
+		offset += n;
+	}
+
+	mask_breakpoints(address, ptr, len);
+	return ok;
+}
+
+//------------------------------------------------------------------------------
+// Name: read_ranges
+// Desc: reads each range a page at a time, noting which ones were not fully
+//       readable
+//------------------------------------------------------------------------------
+bool DebuggerCoreUNIX::read_ranges(MemoryRangeList *ranges) {
+
+	Q_ASSERT(ranges);
+
+	if(!attached()) {
+		return false;
+	}
+
+	for(MemoryRangeList::iterator it = ranges->begin(); it != ranges->end(); ++it) {
+		quint8 *const ptr  = reinterpret_cast<quint8 *>(it->buffer);
+		std::size_t offset = 0;
+
+		it->ok = true;
+		while(offset != it->length) {
+			const edb::address_t page_end = ((it->address + offset) & ~(page_size() - 1)) + page_size();
+			const std::size_t n           = qMin<std::size_t>(page_end - (it->address + offset), it->length - offset);
+
+			if(!read_words(it->address + offset, ptr + offset, n)) {
+				std::memset(ptr + offset, 0xff, n);
+				it->ok = false;
 			}
+
+			offset += n;
 		}
+
+		mask_breakpoints(it->address, ptr, it->length);
 	}
 
 	return true;
@@ -406,23 +487,31 @@ bool DebuggerCoreUNIX::read_bytes(edb::address_t address, void *buf, std::size_t
 //------------------------------------------------------------------------------
 // Name: write_bytes
 // Desc: writes <len> bytes from <buf> starting at <address>
+// Note: writing over an enabled breakpoint leaves it in place, the new bytes
+//       will be restored when it is disabled
 //------------------------------------------------------------------------------
 bool DebuggerCoreUNIX::write_bytes(edb::address_t address, const void *buf, std::size_t len) {
 
 	Q_ASSERT(buf);
 
-	bool ok = false;
-	if(attached()) {
-		const quint8 *p = reinterpret_cast<const quint8 *>(buf);
+	if(!attached()) {
+		return false;
+	}
 
-		while(len--) {
-			write_byte(address++, *p++, &ok);
-			if(!ok) {
-				break;
-			}
-		}
+	invalidate_page_cache();
+
+	const quint8 *const ptr = reinterpret_cast<const quint8 *>(buf);
+
+	QByteArray                  patched;
+	QList<IBreakpoint::pointer> shadowed;
+	const quint8 *const data = shadow_breakpoints(address, ptr, len, &patched, &shadowed);
+
+	if(!write_words(address, data, len)) {
+		return false;
 	}
-	return ok;
+
+	update_shadows(address, ptr, shadowed);
+	return true;
 }
 
 //------------------------------------------------------------------------------
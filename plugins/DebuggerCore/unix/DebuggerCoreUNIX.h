@@ -42,18 +42,22 @@ public:
 	virtual ~DebuggerCoreUNIX() {}
 
 protected:
-	quint8 read_byte(edb::address_t address, bool *ok);      // TODO: remind me why these aren't const...
-	quint8 read_byte_base(edb::address_t address, bool *ok); // TODO: remind me why these aren't const...
+	bool read_words(edb::address_t address, quint8 *buf, std::size_t len);
+	void mask_breakpoints(edb::address_t address, quint8 *buf, std::size_t len) const;
+	bool write_words(edb::address_t address, const quint8 *buf, std::size_t len);
+	const quint8 *shadow_breakpoints(edb::address_t address, const quint8 *buf, std::size_t len, QByteArray *patched, QList<IBreakpoint::pointer> *shadowed) const;
+	void update_shadows(edb::address_t address, const quint8 *buf, const QList<IBreakpoint::pointer> &shadowed);
 	void execute_process(const QString &path, const QString &cwd, const QList<QByteArray> &args);
-	void write_byte(edb::address_t address, quint8 value, bool *ok);      // TODO: remind me why these aren't const...
-	void write_byte_base(edb::address_t address, quint8 value, bool *ok); // TODO: remind me why these aren't const...
+	void post_event_notification();
 
 public:
 	virtual bool read_pages(edb::address_t address, void *buf, std::size_t count);      // TODO: remind me why these aren't const...
 	virtual bool read_bytes(edb::address_t address, void *buf, std::size_t len);        // TODO: remind me why these aren't const...
+	virtual bool read_ranges(MemoryRangeList *ranges);
 	virtual bool write_bytes(edb::address_t address, const void *buf, std::size_t len); // TODO: remind me why these aren't const...
 	virtual int pointer_size() const;
 	virtual QMap<long, QString> exceptions() const;
+	virtual int event_fd() const;
 
 protected:
 	virtual long read_data(edb::address_t address, bool *ok) = 0;
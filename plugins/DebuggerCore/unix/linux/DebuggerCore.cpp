@@ -17,10 +17,9 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 */
 
 
-// TODO: research usage of process_vm_readv, process_vm_writev
-
 #include "DebuggerCore.h"
 #include "edb.h"
+#include "IStepHandler.h"
 #include "MemoryRegions.h"
 #include "PlatformEvent.h"
 #include "PlatformRegion.h"
@@ -32,6 +31,7 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #include <QDir>
 
 #include <cerrno>
+#include <cstddef>
 #include <cstring>
 
 #ifndef _GNU_SOURCE
@@ -41,14 +41,23 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #include <asm/ldt.h>
 #include <pwd.h>
 
+#include <fcntl.h>
 #include <link.h>
+#include <linux/audit.h>
+#include <linux/seccomp.h>
 #include <sys/mman.h>
+#include <sys/prctl.h>
 #include <sys/ptrace.h>
 #include <sys/user.h>
 #include <sys/wait.h>
 
 #if defined(__NR_process_vm_readv) || defined(__NR_process_vm_writev)
 #include <sys/uio.h>
+#include <climits>
+#endif
+
+#if defined(__NR_process_vm_readv) && !defined(IOV_MAX)
+#define IOV_MAX 1024
 #endif
 
 // doesn't always seem to be defined in the headers
@@ -64,6 +73,14 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #define PTRACE_GETSIGINFO static_cast<__ptrace_request>(0x4202)
 #endif
 
+#ifndef PTRACE_SINGLEBLOCK
+#define PTRACE_SINGLEBLOCK static_cast<__ptrace_request>(33)
+#endif
+
+#ifndef TRAP_TRACE
+#define TRAP_TRACE 2
+#endif
+
 #ifndef PTRACE_EVENT_CLONE
 #define PTRACE_EVENT_CLONE 3
 #endif
@@ -72,6 +89,46 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #define PTRACE_O_TRACECLONE (1 << PTRACE_EVENT_CLONE)
 #endif
 
+#ifndef PTRACE_EVENT_EXEC
+#define PTRACE_EVENT_EXEC 4
+#endif
+
+#ifndef PTRACE_O_TRACEEXEC
+#define PTRACE_O_TRACEEXEC (1 << PTRACE_EVENT_EXEC)
+#endif
+
+#ifndef PTRACE_EVENT_SECCOMP
+#define PTRACE_EVENT_SECCOMP 7
+#endif
+
+#ifndef PTRACE_O_TRACESECCOMP
+#define PTRACE_O_TRACESECCOMP (1 << PTRACE_EVENT_SECCOMP)
+#endif
+
+#ifndef __WNOTHREAD
+#define __WNOTHREAD 0x20000000
+#endif
+
+#ifndef PTRACE_O_EXITKILL
+#define PTRACE_O_EXITKILL (1 << 20)
+#endif
+
+#ifndef PTRACE_EVENT_STOP
+#define PTRACE_EVENT_STOP 128
+#endif
+
+#ifndef PTRACE_SEIZE
+#define PTRACE_SEIZE static_cast<__ptrace_request>(0x4206)
+#endif
+
+#ifndef PTRACE_INTERRUPT
+#define PTRACE_INTERRUPT static_cast<__ptrace_request>(0x4207)
+#endif
+
+#ifndef PR_SET_NO_NEW_PRIVS
+#define PR_SET_NO_NEW_PRIVS 38
+#endif
+
 namespace {
 
 //------------------------------------------------------------------------------
@@ -98,6 +155,12 @@ int resume_code(int status) {
 		return 0;
 	}
 
+	// the SIGTRAP of a ptrace event (a clone, an exec, an interrupt...) is
+	// no signal the thread is meant to get
+	if(WIFSTOPPED(status) && (status >> 16) != 0) {
+		return 0;
+	}
+
 	if(WIFSIGNALED(status)) {
 		return WTERMSIG(status);
 	}
@@ -121,6 +184,72 @@ bool is_clone_event(int status) {
 	return false;
 }
 
+//------------------------------------------------------------------------------
+// Name: is_exec_event
+// Desc:
+//------------------------------------------------------------------------------
+bool is_exec_event(int status) {
+	if(WIFSTOPPED(status) && WSTOPSIG(status) == SIGTRAP) {
+		return (((status >> 16) & 0xffff) == PTRACE_EVENT_EXEC);
+	}
+
+	return false;
+}
+
+//------------------------------------------------------------------------------
+// Name: is_seccomp_event
+// Desc: true if <status> is a stop on entry to a system call our filter picked
+//------------------------------------------------------------------------------
+bool is_seccomp_event(int status) {
+	if(WIFSTOPPED(status) && WSTOPSIG(status) == SIGTRAP) {
+		return (((status >> 16) & 0xffff) == PTRACE_EVENT_SECCOMP);
+	}
+
+	return false;
+}
+
+//------------------------------------------------------------------------------
+// Name: bpf_statement
+// Desc:
+//------------------------------------------------------------------------------
+sock_filter bpf_statement(quint16 code, quint32 k) {
+	const sock_filter insn = { code, 0, 0, k };
+	return insn;
+}
+
+//------------------------------------------------------------------------------
+// Name: bpf_jump
+// Desc:
+//------------------------------------------------------------------------------
+sock_filter bpf_jump(quint16 code, quint32 k, quint8 jt, quint8 jf) {
+	const sock_filter insn = { code, jt, jf, k };
+	return insn;
+}
+
+//------------------------------------------------------------------------------
+// Name: install_syscall_filter
+// Desc: puts <filter> in for the calling process, which is the child we are
+//       about to exec
+// Note: there is no taking it out again. It stays for the life of the program
+//       and is inherited by everything it starts, detaching or not. Without a
+//       tracer the calls it picks fail with ENOSYS, and setuid binaries run
+//       by the program no longer gain privileges
+//------------------------------------------------------------------------------
+bool install_syscall_filter(const QVector<sock_filter> &filter) {
+
+	sock_fprog program;
+	program.len    = filter.size();
+	program.filter = const_cast<sock_filter *>(filter.constData());
+
+	// an unprivileged process may only have a filter if it gives up gaining
+	// privileges, exec'ing a setuid binary under ptrace doesn't anyway
+	if(prctl(PR_SET_NO_NEW_PRIVS, 1, 0, 0, 0) == -1) {
+		return false;
+	}
+
+	return prctl(PR_SET_SECCOMP, SECCOMP_MODE_FILTER, &program) == 0;
+}
+
 //------------------------------------------------------------------------------
 // Name: process_map_line
 // Desc: parses the data from a line of a memory map file
@@ -163,6 +292,83 @@ IRegion::pointer process_map_line(const QString &line) {
 	return IRegion::pointer();
 }
 
+// arguments and results of a ptrace call made on the ptrace thread
+struct ptrace_call {
+	__ptrace_request request;
+	edb::tid_t       tid;
+	edb::address_t   addr;
+	edb::address_t   data;
+	long             result;
+	int              error;
+};
+
+// arguments and results of a waitpid call made on the ptrace thread
+struct waitpid_call {
+	edb::tid_t tid;
+	int        *status;
+	int        options;
+	pid_t      result;
+	int        error;
+};
+
+// arguments and results of a waitid call made on the ptrace thread
+struct waitid_call {
+	idtype_t  idtype;
+	id_t      id;
+	siginfo_t *info;
+	int       options;
+	int       result;
+	int       error;
+};
+
+//------------------------------------------------------------------------------
+// Name: do_ptrace
+// Desc:
+//------------------------------------------------------------------------------
+void do_ptrace(void *context) {
+	ptrace_call *const call = static_cast<ptrace_call *>(context);
+
+	errno = 0;
+	call->result = ptrace(call->request, call->tid, reinterpret_cast<void *>(call->addr), reinterpret_cast<void *>(call->data));
+	call->error  = errno;
+}
+
+//------------------------------------------------------------------------------
+// Name: do_waitpid
+// Desc:
+//------------------------------------------------------------------------------
+void do_waitpid(void *context) {
+	waitpid_call *const call = static_cast<waitpid_call *>(context);
+
+	errno = 0;
+	call->result = native::waitpid(call->tid, call->status, call->options);
+	call->error  = errno;
+}
+
+//------------------------------------------------------------------------------
+// Name: do_waitid
+// Desc:
+//------------------------------------------------------------------------------
+void do_waitid(void *context) {
+	waitid_call *const call = static_cast<waitid_call *>(context);
+
+	do {
+		errno = 0;
+		call->result = ::waitid(call->idtype, call->id, call->info, call->options);
+	} while(call->result == -1 && errno == EINTR);
+	call->error = errno;
+}
+
+#ifdef __NR_process_vm_readv
+// a page sized (or smaller) chunk of one of the ranges passed to read_ranges
+struct read_piece {
+	edb::address_t address;
+	quint8         *buffer;
+	std::size_t    length;
+	int            range;
+};
+#endif
+
 struct user_stat {
 /* 01 */ int pid;
 /* 02 */ char comm[256];
@@ -284,7 +490,7 @@ int get_user_stat(edb::pid_t pid, struct user_stat *user_stat) {
 // Name: DebuggerCore
 // Desc: constructor
 //------------------------------------------------------------------------------
-DebuggerCore::DebuggerCore() : binary_info_(0) {
+DebuggerCore::DebuggerCore() : binary_info_(0), process_vm_readv_supported_(true), seized_(true), non_stop_(0), memory_fd_(-1), state_epoch_(0) {
 #if defined(_SC_PAGESIZE)
 	page_size_ = sysconf(_SC_PAGESIZE);
 #elif defined(_SC_PAGE_SIZE)
@@ -292,6 +498,8 @@ DebuggerCore::DebuggerCore() : binary_info_(0) {
 #else
 	page_size_ = PAGE_SIZE;
 #endif
+
+	ptrace_thread_.start();
 }
 
 //------------------------------------------------------------------------------
@@ -320,20 +528,48 @@ DebuggerCore::~DebuggerCore() {
 }
 
 //------------------------------------------------------------------------------
-// Name: ptrace_getsiginfo
-// Desc:
+// Name: ptrace_request
+// Desc: makes a ptrace call on the ptrace thread, errno is set as if it had
+//       been made on the calling thread
 //------------------------------------------------------------------------------
-long DebuggerCore::ptrace_getsiginfo(edb::tid_t tid, siginfo_t *siginfo) {
-	Q_ASSERT(siginfo != 0);
-	return ptrace(PTRACE_GETSIGINFO, tid, 0, siginfo);
+long DebuggerCore::ptrace_request(__ptrace_request request, edb::tid_t tid, edb::address_t addr, edb::address_t data) {
+	ptrace_call call = { request, tid, addr, data, -1, 0 };
+	ptrace_thread_.execute(do_ptrace, &call);
+	errno = call.error;
+	return call.result;
+}
+
+//------------------------------------------------------------------------------
+// Name: waitpid_request
+// Desc: waits for <tid> on the ptrace thread, errno is set as if the wait had
+//       been done on the calling thread
+//------------------------------------------------------------------------------
+pid_t DebuggerCore::waitpid_request(edb::tid_t tid, int *status, int options) {
+	waitpid_call call = { tid, status, options, -1, 0 };
+	ptrace_thread_.execute(do_waitpid, &call);
+	errno = call.error;
+	return call.result;
+}
+
+//------------------------------------------------------------------------------
+// Name: waitid_request
+// Desc: waitid on the ptrace thread, errno is set as if the wait had been done
+//       on the calling thread
+//------------------------------------------------------------------------------
+int DebuggerCore::waitid_request(idtype_t idtype, id_t id, siginfo_t *info, int options) {
+	waitid_call call = { idtype, id, info, options, -1, 0 };
+	ptrace_thread_.execute(do_waitid, &call);
+	errno = call.error;
+	return call.result;
 }
 
 //------------------------------------------------------------------------------
-// Name: ptrace_traceme
+// Name: ptrace_getsiginfo
 // Desc:
 //------------------------------------------------------------------------------
-long DebuggerCore::ptrace_traceme() {
-	return ptrace(PTRACE_TRACEME, 0, 0, 0);
+long DebuggerCore::ptrace_getsiginfo(edb::tid_t tid, siginfo_t *siginfo) {
+	Q_ASSERT(siginfo != 0);
+	return ptrace_request(PTRACE_GETSIGINFO, tid, 0, siginfo);
 }
 
 //------------------------------------------------------------------------------
@@ -343,8 +579,9 @@ long DebuggerCore::ptrace_traceme() {
 long DebuggerCore::ptrace_continue(edb::tid_t tid, long status) {
 	Q_ASSERT(waited_threads_.contains(tid));
 	Q_ASSERT(tid != 0);
-	waited_threads_.remove(tid);
-	return ptrace(PTRACE_CONT, tid, 0, status);
+	remove_waited_thread(tid);
+	invalidate_state(tid);
+	return ptrace_request(PTRACE_CONT, tid, 0, status);
 }
 
 //------------------------------------------------------------------------------
@@ -354,8 +591,51 @@ long DebuggerCore::ptrace_continue(edb::tid_t tid, long status) {
 long DebuggerCore::ptrace_step(edb::tid_t tid, long status) {
 	Q_ASSERT(waited_threads_.contains(tid));
 	Q_ASSERT(tid != 0);
+	remove_waited_thread(tid);
+	invalidate_state(tid);
+	return ptrace_request(PTRACE_SINGLESTEP, tid, 0, status);
+}
+
+//------------------------------------------------------------------------------
+// Name: ptrace_block_step
+// Desc: like ptrace_step, but the thread runs until it takes a branch
+//------------------------------------------------------------------------------
+long DebuggerCore::ptrace_block_step(edb::tid_t tid, long status) {
+	Q_ASSERT(waited_threads_.contains(tid));
+	Q_ASSERT(tid != 0);
+	remove_waited_thread(tid);
+	invalidate_state(tid);
+	return ptrace_request(PTRACE_SINGLEBLOCK, tid, 0, status);
+}
+
+//------------------------------------------------------------------------------
+// Name: add_waited_thread
+// Desc: notes that <tid> is stopped and has been waited on
+// Note: only the thread which drives the debugger (or the ptrace thread on its
+//       behalf) changes waited_threads_, it takes the lock so that
+//       stopped_thread can look at it from anywhere
+//------------------------------------------------------------------------------
+void DebuggerCore::add_waited_thread(edb::tid_t tid) {
+	QMutexLocker locker(&waited_threads_mutex_);
+	waited_threads_.insert(tid);
+}
+
+//------------------------------------------------------------------------------
+// Name: remove_waited_thread
+// Desc: notes that <tid> is about to run, or is gone
+//------------------------------------------------------------------------------
+void DebuggerCore::remove_waited_thread(edb::tid_t tid) {
+	QMutexLocker locker(&waited_threads_mutex_);
 	waited_threads_.remove(tid);
-	return ptrace(PTRACE_SINGLESTEP, tid, 0, status);
+}
+
+//------------------------------------------------------------------------------
+// Name: invalidate_state
+// Desc: forgets the cached registers of <tid>, which is about to run
+//------------------------------------------------------------------------------
+void DebuggerCore::invalidate_state(edb::tid_t tid) {
+	QMutexLocker locker(&state_cache_mutex_);
+	state_cache_.remove(tid);
 }
 
 //------------------------------------------------------------------------------
@@ -365,7 +645,7 @@ long DebuggerCore::ptrace_step(edb::tid_t tid, long status) {
 long DebuggerCore::ptrace_set_options(edb::tid_t tid, long options) {
 	Q_ASSERT(waited_threads_.contains(tid));
 	Q_ASSERT(tid != 0);
-	return ptrace(PTRACE_SETOPTIONS, tid, 0, options);
+	return ptrace_request(PTRACE_SETOPTIONS, tid, 0, options);
 }
 
 //------------------------------------------------------------------------------
@@ -376,7 +656,7 @@ long DebuggerCore::ptrace_get_event_message(edb::tid_t tid, unsigned long *messa
 	Q_ASSERT(waited_threads_.contains(tid));
 	Q_ASSERT(tid != 0);
 	Q_ASSERT(message != 0);
-	return ptrace(PTRACE_GETEVENTMSG, tid, 0, message);
+	return ptrace_request(PTRACE_GETEVENTMSG, tid, 0, message);
 }
 
 //------------------------------------------------------------------------------
@@ -386,12 +666,23 @@ long DebuggerCore::ptrace_get_event_message(edb::tid_t tid, unsigned long *messa
 IDebugEvent::const_pointer DebuggerCore::handle_event(edb::tid_t tid, int status) {
 
 	// note that we have waited on this thread
-	waited_threads_.insert(tid);
+	add_waited_thread(tid);
+
+	// was it the stop we asked for while stopping the other threads, which
+	// was held back because the thread had something else to report first?
+	if(is_stop_request(status)) {
+		const threadmap_t::iterator it = threads_.find(tid);
+		if(it != threads_.end() && it->state == thread_info::THREAD_SIGNALED) {
+			it->state = thread_info::THREAD_STOPPED;
+			ptrace_continue(tid, 0);
+			return IDebugEvent::const_pointer();
+		}
+	}
 
 	// was it a thread exit event?
 	if(WIFEXITED(status)) {
 		threads_.remove(tid);
-		waited_threads_.remove(tid);
+		remove_waited_thread(tid);
 
 		// if this was the last thread, return true
 		// so we report it to the user.
@@ -413,16 +704,16 @@ IDebugEvent::const_pointer DebuggerCore::handle_event(edb::tid_t tid, int status
 
 			int thread_status = 0;
 			if(!waited_threads_.contains(new_tid)) {
-				if(native::waitpid(new_tid, &thread_status, __WALL) > 0) {
-					waited_threads_.insert(new_tid);
+				if(waitpid_request(new_tid, &thread_status, __WALL) > 0) {
+					add_waited_thread(new_tid);
 				}
 			}
 
-			if(!WIFSTOPPED(thread_status) || WSTOPSIG(thread_status) != SIGSTOP) {
-				qDebug("[warning] new thread [%d] received an event besides SIGSTOP", static_cast<int>(new_tid));
+			if(!is_stop_request(thread_status)) {
+				qDebug("[warning] new thread [%d] received an event besides its initial stop", static_cast<int>(new_tid));
 			}
 
-			// TODO: what the heck do we do if this isn't a SIGSTOP?
+			// TODO: what the heck do we do if this isn't the initial stop?
 			ptrace_continue(new_tid, resume_code(thread_status));
 		}
 
@@ -430,8 +721,31 @@ IDebugEvent::const_pointer DebuggerCore::handle_event(edb::tid_t tid, int status
 		return IDebugEvent::const_pointer();
 	}
 
+	// a signal which is to go straight to the program, the other threads are
+	// never stopped and the debugger never hears of it
+	if(passes_signal(tid, status)) {
+		ptrace_continue(tid, WSTOPSIG(status));
+		return IDebugEvent::const_pointer();
+	}
+
+	// the program exec'd, which took every other thread with it. The one that
+	// did it goes on as the process and is reported like any other event
+	if(is_exec_event(status)) {
+		Q_FOREACH(edb::tid_t thread, threads_.keys()) {
+			if(thread != tid) {
+				threads_.remove(thread);
+				remove_waited_thread(thread);
+			}
+		}
+
+		// the old file still refers to the old address space
+		close_memory_file();
+	}
+
 	// normal event
 
+	// anything which was read while the process was running is suspect
+	invalidate_page_cache();
 
 	PlatformEvent *const e = new PlatformEvent;
 
@@ -442,138 +756,716 @@ IDebugEvent::const_pointer DebuggerCore::handle_event(edb::tid_t tid, int status
 		// TODO: handle no info?
 	}
 
+	const edb::tid_t previous_thread = active_thread_;
+
 	active_thread_       = tid;
 	event_thread_        = tid;
 	threads_[tid].status = status;
 
-	stop_threads();
+	// in non-stop mode the other threads carry on
+	if(!non_stop()) {
+		stop_threads();
+	}
+
+	if(skip_breakpoint(tid, e)) {
+		delete e;
+
+		// the debugger never hears of this one, so it goes on looking at the
+		// thread it was looking at, if that is still stopped
+		if(non_stop() && waited_threads_.contains(previous_thread)) {
+			active_thread_ = previous_thread;
+		}
+		return IDebugEvent::const_pointer();
+	}
+
 	return IDebugEvent::const_pointer(e);
 }
 
 //------------------------------------------------------------------------------
-// Name: stop_threads
-// Desc:
+// Name: skip_breakpoint
+// Desc: a breakpoint which isn't due to stop yet, because of its ignore count
+//       or a condition which doesn't hold, is stepped over and the process is
+//       resumed right here, without the debugger ever seeing the event. So is
+//       a tracepoint, once its hit has been recorded, and a coverage
+//       breakpoint, which is removed instead of stepped over.
+//       Returns true if that is what happened, otherwise the decision goes
+//       along with the event so that the debugger needn't make it again
 //------------------------------------------------------------------------------
-void DebuggerCore::stop_threads() {
-	for(threadmap_t::iterator it = threads_.begin(); it != threads_.end(); ++it) {
-		if(!waited_threads_.contains(it.key())) {
-			const edb::tid_t tid = it.key();
+bool DebuggerCore::skip_breakpoint(edb::tid_t tid, PlatformEvent *event) {
+
+	if(!event->is_trap() || event->trap_reason() != IDebugEvent::TRAP_BREAKPOINT) {
+		return false;
+	}
 
-			syscall(SYS_tgkill, pid(), tid, SIGSTOP);
+	State state;
+	get_state(&state);
 
-			int thread_status;
-			if(native::waitpid(tid, &thread_status, __WALL) > 0) {
-				waited_threads_.insert(tid);
-				it->status = thread_status;
+	const edb::address_t address = state.instruction_pointer() - breakpoint_size();
 
-				if(!WIFSTOPPED(thread_status) || WSTOPSIG(thread_status) != SIGSTOP) {
-					qDebug("[warning] paused thread [%d] received an event besides SIGSTOP", tid);
-				}
-			}
-		}
+	const IBreakpoint::pointer bp = find_breakpoint(address);
+	if(!bp || !bp->enabled()) {
+		return false;
 	}
-}
-
-//------------------------------------------------------------------------------
-// Name: wait_debug_event
-// Desc: waits for a debug event, msecs is a timeout
-//      it will return false if an error or timeout occurs
-//------------------------------------------------------------------------------
-IDebugEvent::const_pointer DebuggerCore::wait_debug_event(int msecs) {
 
-	if(attached()) {
-		if(!native::wait_for_sigchld(msecs)) {
-			Q_FOREACH(edb::tid_t thread, thread_ids()) {
-				int status;
-				const edb::tid_t tid = native::waitpid(thread, &status, __WALL | WNOHANG);
-				if(tid > 0) {
-					return handle_event(tid, status);
-				}
-			}
-		}
+	// the condition sees the thread as the debugger would, sitting right on
+	// the breakpoint
+	state.set_instruction_pointer(address);
+
+	// a coverage breakpoint is only ever hit once, so it is taken out for good
+	// and the thread simply goes on from the start of the block
+	if(bp->coverage) {
+		bp->hit();
+		edb::v1::record_coverage(address);
+		bp->disable();
+		remove_breakpoint(address);
+		set_state(state);
+
+		threads_[tid].status = 0;
+		resume(edb::DEBUG_CONTINUE);
+		return true;
 	}
-	return IDebugEvent::const_pointer();
-}
 
-//------------------------------------------------------------------------------
-// Name: read_data
-// Desc:
-// Note: this will fail on newer versions of linux if called from a
-//       different thread than the one which attached to process
-//------------------------------------------------------------------------------
-long DebuggerCore::read_data(edb::address_t address, bool *ok) {
+	if(bp->one_time()) {
+		return false;
+	}
 
-	Q_ASSERT(ok);
+	// hits which stop, and errors, are left for the debugger to report
+	const edb::BREAKPOINT_ACTION action = edb::v1::breakpoint_action(bp, state, &event->breakpoint_error_);
+	if(action == edb::BREAKPOINT_STOP || action == edb::BREAKPOINT_ERROR) {
+		event->breakpoint_action_ = action;
+		return false;
+	}
 
-	errno = 0;
-	const long v = ptrace(PTRACE_PEEKTEXT, pid(), address, 0);
-	SET_OK(*ok, v);
-	return v;
-}
+	set_state(state);
 
-//------------------------------------------------------------------------------
-// Name: read_pages
-// Desc:
-//------------------------------------------------------------------------------
-bool DebuggerCore::read_pages(edb::address_t address, void *buf, std::size_t count) {
+	// in non-stop mode the other threads are held for as long as the
+	// breakpoint is out of the way
+	QSet<edb::tid_t> held;
+	if(non_stop()) {
+		held = hold_threads();
+	}
 
-	const std::size_t len = count * page_size();
+	// take the breakpoint out of the way just long enough to step over it,
+	// every other thread is stopped so none of them can miss it
+	int step_status = 0;
+	Q_FOREVER {
+		bp->disable();
+		ptrace_step(tid, 0);
 
-	QFile memory_file(QString("/proc/%1/mem").arg(pid_));
-	if(memory_file.open(QIODevice::ReadOnly)) {
+		step_status = 0;
+		if(waitpid_request(tid, &step_status, __WALL) == static_cast<pid_t>(tid)) {
+			add_waited_thread(tid);
+		}
 
-		memory_file.seek(address);
-		const qint64 n = memory_file.read(reinterpret_cast<char *>(buf), len);
+		bp->enable();
 
-		// TODO: handle if breakponts have a size more than 1!
-		Q_FOREACH(const IBreakpoint::pointer &bp, breakpoints_) {
-			if(bp->address() >= address && bp->address() < (address + n)) {
-				// show the original bytes in the buffer..
-				reinterpret_cast<quint8 *>(buf)[bp->address() - address] = bp->original_bytes()[0];
-			}
+		// a stop we asked for earlier which only now got through, the thread
+		// hasn't moved yet
+		if(is_stop_request(step_status) && threads_[tid].state == thread_info::THREAD_SIGNALED) {
+			threads_[tid].state = thread_info::THREAD_STOPPED;
+			continue;
 		}
 
-		memory_file.close();
+		break;
+	}
+
+	release_threads(held);
+
+	// a signal stops the thread before it gets past the breakpoint, it gets
+	// to it again once the signal has been dealt with and that is the hit
+	// which counts. Anything else means it has moved on
+	if(WIFSTOPPED(step_status) && (WSTOPSIG(step_status) == SIGTRAP || (step_status >> 16) != 0)) {
+		edb::v1::complete_breakpoint_hit(bp, action, state);
+	}
+
+	// a signal which is only passed on goes along with the resume
+	if(passes_signal(tid, step_status)) {
+		threads_[tid].status = step_status;
+		resume(edb::DEBUG_EXCEPTION_NOT_HANDLED);
+		return true;
 	}
 
+	if(!WIFSTOPPED(step_status) || WSTOPSIG(step_status) != SIGTRAP || is_seccomp_event(step_status)) {
+		// something else came up on the way, it is reported like any other
+		// event the next time we are asked
+		threads_[tid].status = step_status;
+		deferred_events_.enqueue(tid);
+		post_event_notification();
+		return true;
+	}
+
+	threads_[tid].status = 0;
+	resume(edb::DEBUG_CONTINUE);
 	return true;
 }
 
+//------------------------------------------------------------------------------
+// Name: hold_threads
+// Desc: stops the threads which are running and returns them, for the little
+//       while in non-stop mode that they must not run
+//------------------------------------------------------------------------------
+QSet<edb::tid_t> DebuggerCore::hold_threads() {
+
+	const QSet<edb::tid_t> waited = waited_threads_;
+
+	stop_threads();
+
+	// threads created in the meantime are collected too, held along with the rest
+	QSet<edb::tid_t> held = waited_threads_;
+	held.subtract(waited);
+	return held;
+}
 
 //------------------------------------------------------------------------------
-// Name: write_data
-// Desc:
+// Name: release_threads
+// Desc: lets the threads hold_threads stopped carry on, except for those which
+//       came up with an event of their own. They stay stopped until it has
+//       been reported
 //------------------------------------------------------------------------------
-bool DebuggerCore::write_data(edb::address_t address, long value) {
-	return ptrace(PTRACE_POKETEXT, pid(), address, value) != -1;
+void DebuggerCore::release_threads(const QSet<edb::tid_t> &held) {
+	Q_FOREACH(edb::tid_t tid, held) {
+		if(threads_.contains(tid) && waited_threads_.contains(tid) && !deferred_events_.contains(tid)) {
+			ptrace_continue(tid, resume_code(threads_[tid].status));
+		}
+	}
 }
 
 //------------------------------------------------------------------------------
-// Name: attach_thread
-// Desc:
+// Name: stop_threads
+// Desc: stops every thread which is still running. All of them are asked
+//       up front and then collected in whatever order they happen to stop,
+//       so that the cost doesn't grow with a round trip per thread
+// Note: a thread may report something else (a breakpoint, a signal) before
+//       our stop request gets to it. That event is kept to be reported later
+//       and the stop, which is still pending, is dropped when it shows up
 //------------------------------------------------------------------------------
-bool DebuggerCore::attach_thread(edb::tid_t tid) {
-	if(ptrace(PTRACE_ATTACH, tid, 0, 0) == 0) {
-		// I *think* that the PTRACE_O_TRACECLONE is only valid on
-		// on stopped threads
-		int status;
-		if(native::waitpid(tid, &status, __WALL) > 0) {
+void DebuggerCore::stop_threads() {
 
-			const thread_info info = { status, thread_info::THREAD_STOPPED };
-			threads_[tid] = info;
+	QSet<edb::tid_t> stopping;
+
+	for(threadmap_t::iterator it = threads_.begin(); it != threads_.end(); ++it) {
+		if(!waited_threads_.contains(it.key()) && stop_thread(it.key())) {
+			it->state = thread_info::THREAD_SIGNALED;
+			stopping.insert(it.key());
+		}
+	}
+
+	while(!stopping.isEmpty()) {
+		int thread_status;
+		const edb::tid_t tid = wait_stopping_thread(stopping, &thread_status);
+		if(tid <= 0) {
+			qDebug("[DebuggerCore] failed to wait for %d stopping threads: %s", stopping.size(), strerror(errno));
+			break;
+		}
+
+		stopping.remove(tid);
+
+		const threadmap_t::iterator it = threads_.find(tid);
+		if(it == threads_.end()) {
+			continue;
+		}
+
+		if(WIFEXITED(thread_status) || WIFSIGNALED(thread_status)) {
+			threads_.erase(it);
+			continue;
+		}
 
-			waited_threads_.insert(tid);
-			if(ptrace_set_options(tid, PTRACE_O_TRACECLONE) == -1) {
-				qDebug("[DebuggerCore] failed to set PTRACE_O_TRACECLONE: [%d] %s", tid, strerror(errno));
+		add_waited_thread(tid);
+
+		if(is_clone_event(thread_status)) {
+			// the new thread starts out stopped, so it just needs to be
+			// collected along with the rest
+			unsigned long new_tid;
+			if(ptrace_get_event_message(tid, &new_tid) != -1 && !threads_.contains(new_tid)) {
+				const thread_info info = { 0, thread_info::THREAD_STOPPED };
+				threads_.insert(new_tid, info);
+				stopping.insert(new_tid);
 			}
+
+			// our stop request is still pending for this thread
+			it->status = 0;
+			continue;
+		}
+
+		it->status = thread_status;
+
+		if(is_stop_request(thread_status)) {
+			it->state = thread_info::THREAD_STOPPED;
+		} else if(!passes_signal(tid, thread_status)) {
+			// signals which are passed on need no reporting, resume() hands
+			// them over along with the thread's status
+			deferred_events_.enqueue(tid);
 		}
-		return true;
 	}
-	return false;
 }
 
 //------------------------------------------------------------------------------
-// Name: attach
+// Name: stop_thread
+// Desc: asks <tid> to stop, which it reports like any other event. A seized
+//       thread is interrupted, otherwise it is sent a SIGSTOP
+//------------------------------------------------------------------------------
+bool DebuggerCore::stop_thread(edb::tid_t tid) {
+	if(seized_) {
+		return ptrace_request(PTRACE_INTERRUPT, tid, 0, 0) == 0;
+	}
+
+	return syscall(SYS_tgkill, pid(), tid, SIGSTOP) == 0;
+}
+
+//------------------------------------------------------------------------------
+// Name: is_stop_request
+// Desc: true if <status> is the stop stop_thread asked for, or the one a new
+//       thread starts out with
+//------------------------------------------------------------------------------
+bool DebuggerCore::is_stop_request(int status) const {
+	if(!WIFSTOPPED(status)) {
+		return false;
+	}
+
+	if(seized_) {
+		return WSTOPSIG(status) == SIGTRAP && ((status >> 16) & 0xffff) == PTRACE_EVENT_STOP;
+	}
+
+	return WSTOPSIG(status) == SIGSTOP;
+}
+
+//------------------------------------------------------------------------------
+// Name: wait_stopping_thread
+// Desc: blocks until one of the threads in <stopping> has stopped and returns
+//       it, whichever one gets there first
+// Note: __WNOTHREAD keeps the peek to children of the ptrace thread, see
+//       wait_thread
+//------------------------------------------------------------------------------
+edb::tid_t DebuggerCore::wait_stopping_thread(const QSet<edb::tid_t> &stopping, int *status) {
+
+	Q_ASSERT(!stopping.isEmpty());
+	Q_ASSERT(status);
+
+	siginfo_t info;
+	std::memset(&info, 0, sizeof(info));
+
+	if(waitid_request(P_ALL, 0, &info, WEXITED | WSTOPPED | WNOWAIT | __WALL | __WNOTHREAD) == 0 && stopping.contains(info.si_pid)) {
+		return waitpid_request(info.si_pid, status, __WALL);
+	}
+
+	// whatever is first in line isn't one we are after, so pick one of ours
+	return waitpid_request(*stopping.constBegin(), status, __WALL);
+}
+
+//------------------------------------------------------------------------------
+// Name: wait_debug_event
+// Desc: waits for a debug event, msecs is a timeout
+//      it will return false if an error or timeout occurs
+// Note: one SIGCHLD may stand for several events, so we keep going until
+//       there is nothing left or we have something to report
+//------------------------------------------------------------------------------
+IDebugEvent::const_pointer DebuggerCore::wait_debug_event(int msecs) {
+
+	if(attached()) {
+
+		// events which came up while stopping the threads go first, the
+		// threads they belong to have been stopped the whole time
+		while(!deferred_events_.isEmpty()) {
+			const edb::tid_t tid = deferred_events_.dequeue();
+			if(threads_.contains(tid)) {
+				return reported_event(handle_event(tid, threads_[tid].status));
+			}
+		}
+
+		if(!native::wait_for_sigchld(msecs)) {
+			Q_FOREVER {
+				wait_call call = { this, 0, 0 };
+				ptrace_thread_.execute(do_wait_thread, &call);
+
+				if(call.tid <= 0) {
+					break;
+				}
+
+				if(IDebugEvent::const_pointer e = handle_event(call.tid, call.status)) {
+					return reported_event(e);
+				}
+
+				if(!attached()) {
+					break;
+				}
+			}
+		}
+	}
+	return IDebugEvent::const_pointer();
+}
+
+//------------------------------------------------------------------------------
+// Name: reported_event
+// Desc: in non-stop mode the other threads carry on while <event> is reported
+//       and may well have stopped with something of their own already. The
+//       SIGCHLDs for that have been used up, so we make sure to come back
+//------------------------------------------------------------------------------
+IDebugEvent::const_pointer DebuggerCore::reported_event(const IDebugEvent::const_pointer &event) {
+	if(event && non_stop()) {
+		post_event_notification();
+	}
+	return event;
+}
+
+//------------------------------------------------------------------------------
+// Name: do_wait_thread
+// Desc:
+//------------------------------------------------------------------------------
+void DebuggerCore::do_wait_thread(void *context) {
+	wait_call *const call = static_cast<wait_call *>(context);
+	call->tid = call->core->wait_thread(&call->status);
+}
+
+//------------------------------------------------------------------------------
+// Name: wait_thread
+// Desc: reaps the next event of any of our threads without blocking, returns
+//       the thread it belongs to or 0 if there is none
+// Note: rather than asking each thread in turn, we peek at whichever child the
+//       kernel has ready and reap it if it is one of ours. This runs on the
+//       ptrace thread, which is the tracer of all of our threads and the parent
+//       of the process if we started it, so __WNOTHREAD hides the children of
+//       the other threads (such as the terminal QProcess started, which it
+//       will reap itself) and they can't get in the way. The scan is only
+//       needed for a new thread which reports before its PTRACE_EVENT_CLONE
+//       has been handled
+//------------------------------------------------------------------------------
+edb::tid_t DebuggerCore::wait_thread(int *status) {
+
+	Q_ASSERT(status);
+
+	siginfo_t info;
+	std::memset(&info, 0, sizeof(info));
+
+	int r;
+	do {
+		r = ::waitid(P_ALL, 0, &info, WEXITED | WSTOPPED | WNOHANG | WNOWAIT | __WALL | __WNOTHREAD);
+	} while(r == -1 && errno == EINTR);
+
+	if(r == 0) {
+		if(info.si_pid == 0) {
+			// nobody has anything to report
+			return 0;
+		}
+
+		if(threads_.contains(info.si_pid)) {
+			const edb::tid_t tid = native::waitpid(info.si_pid, status, __WALL | __WNOTHREAD | WNOHANG);
+			if(tid > 0) {
+				return tid;
+			}
+		}
+	}
+
+	for(threadmap_t::const_iterator it = threads_.begin(); it != threads_.end(); ++it) {
+		const edb::tid_t tid = native::waitpid(it.key(), status, __WALL | WNOHANG);
+		if(tid > 0) {
+			return tid;
+		}
+	}
+
+	return 0;
+}
+
+//------------------------------------------------------------------------------
+// Name: read_data
+// Desc:
+// Note: linux only allows this from the thread which attached to process,
+//       ptrace_request takes care of that for us
+//------------------------------------------------------------------------------
+long DebuggerCore::read_data(edb::address_t address, bool *ok) {
+
+	Q_ASSERT(ok);
+
+	errno = 0;
+	const long v = memory_request(PTRACE_PEEKTEXT, address, 0);
+	SET_OK(*ok, v);
+	return v;
+}
+
+//------------------------------------------------------------------------------
+// Name: read_pages
+// Desc: reads <count> pages from the process starting at <address>
+// Note: pages which can't be read are filled with 0xff bytes, and make this
+//       return false
+//------------------------------------------------------------------------------
+bool DebuggerCore::read_pages(edb::address_t address, void *buf, std::size_t count) {
+
+	Q_ASSERT(buf);
+
+	if(!attached()) {
+		return false;
+	}
+
+	quint8 *const ptr     = reinterpret_cast<quint8 *>(buf);
+	const std::size_t len = count * page_size();
+	std::size_t offset    = 0;
+	bool ok               = true;
+
+	while(offset != len) {
+		const ssize_t n = read_memory_file(address + offset, ptr + offset, len - offset);
+		if(n > 0) {
+			offset += n;
+			continue;
+		}
+
+		// try the page we got stuck on with ptrace, then move past it
+		const edb::address_t page_end = ((address + offset) & ~(page_size() - 1)) + page_size();
+		const std::size_t chunk       = qMin<std::size_t>(page_end - (address + offset), len - offset);
+
+		if(!read_words(address + offset, ptr + offset, chunk)) {
+			std::memset(ptr + offset, 0xff, chunk);
+			ok = false;
+		}
+
+		offset += chunk;
+	}
+
+	mask_breakpoints(address, ptr, len);
+	return ok;
+}
+
+//------------------------------------------------------------------------------
+// Name: write_data
+// Desc:
+//------------------------------------------------------------------------------
+bool DebuggerCore::write_data(edb::address_t address, long value) {
+	return memory_request(PTRACE_POKETEXT, address, value) != -1;
+}
+
+//------------------------------------------------------------------------------
+// Name: memory_request
+// Desc: makes a PTRACE_PEEKTEXT or PTRACE_POKETEXT request through a thread
+//       which is stopped, as ptrace only allows. In non-stop mode the main
+//       thread may well be running. errno is set as for ptrace_request
+//------------------------------------------------------------------------------
+long DebuggerCore::memory_request(__ptrace_request request, edb::address_t addr, edb::address_t data) {
+	memory_call call = { this, request, addr, data, -1, 0 };
+	ptrace_thread_.execute(do_memory_request, &call);
+	errno = call.error;
+	return call.result;
+}
+
+//------------------------------------------------------------------------------
+// Name: do_memory_request
+// Desc: the thread is picked on the ptrace thread, so it can't be resumed
+//       between being picked and being used
+//------------------------------------------------------------------------------
+void DebuggerCore::do_memory_request(void *context) {
+	memory_call *const call = static_cast<memory_call *>(context);
+
+	ptrace_call request = { call->request, call->core->stopped_thread(), call->addr, call->data, -1, 0 };
+	do_ptrace(&request);
+
+	call->result = request.result;
+	call->error  = request.error;
+}
+
+//------------------------------------------------------------------------------
+// Name: stopped_thread
+// Desc: a thread which is stopped, or the process if there is none
+// Note: may be called from any thread
+//------------------------------------------------------------------------------
+edb::tid_t DebuggerCore::stopped_thread() const {
+	QMutexLocker locker(&waited_threads_mutex_);
+
+	if(!waited_threads_.isEmpty()) {
+		return *waited_threads_.constBegin();
+	}
+
+	return pid();
+}
+
+//------------------------------------------------------------------------------
+// Name: set_signal_policy
+// Desc:
+//------------------------------------------------------------------------------
+void DebuggerCore::set_signal_policy(int signal, edb::SIGNAL_POLICY policy) {
+	if(policy == edb::SIGNAL_STOP) {
+		signal_policies_.remove(signal);
+	} else {
+		signal_policies_.insert(signal, policy);
+	}
+}
+
+//------------------------------------------------------------------------------
+// Name: set_syscall_stops
+// Desc: builds the seccomp filter which open() puts in the next program. For
+//       each ABI it checks the system call number against the ones we stop
+//       on, anything else is allowed without the tracer hearing of it. With
+//       nothing to stop on there is no filter and programs start without one
+//------------------------------------------------------------------------------
+bool DebuggerCore::set_syscall_stops(const QMap<QString, QList<int> > &syscalls) {
+
+	QVector<sock_filter> filter;
+
+	for(QMap<QString, QList<int> >::const_iterator it = syscalls.begin(); it != syscalls.end(); ++it) {
+
+		quint32 arch;
+		if(it.key() == "x86") {
+			arch = AUDIT_ARCH_I386;
+		} else if(it.key() == "x86-64") {
+			arch = AUDIT_ARCH_X86_64;
+		} else {
+			continue;
+		}
+
+		if(it->isEmpty()) {
+			continue;
+		}
+
+		// a different ABI jumps over this block, the jump offsets of a
+		// conditional are only 8 bits wide so that takes an unconditional one
+		filter.push_back(bpf_statement(BPF_LD | BPF_W | BPF_ABS, offsetof(seccomp_data, arch)));
+		filter.push_back(bpf_jump(BPF_JMP | BPF_JEQ | BPF_K, arch, 1, 0));
+		const int skip = filter.size();
+		filter.push_back(bpf_statement(BPF_JMP | BPF_JA, 0));
+
+		filter.push_back(bpf_statement(BPF_LD | BPF_W | BPF_ABS, offsetof(seccomp_data, nr)));
+		Q_FOREACH(int nr, *it) {
+			filter.push_back(bpf_jump(BPF_JMP | BPF_JEQ | BPF_K, nr, 0, 1));
+			filter.push_back(bpf_statement(BPF_RET | BPF_K, SECCOMP_RET_TRACE));
+		}
+		filter.push_back(bpf_statement(BPF_RET | BPF_K, SECCOMP_RET_ALLOW));
+
+		filter[skip].k = filter.size() - skip - 1;
+	}
+
+	if(!filter.isEmpty()) {
+		filter.push_back(bpf_statement(BPF_RET | BPF_K, SECCOMP_RET_ALLOW));
+	}
+
+	if(filter.size() > BPF_MAXINSNS) {
+		qDebug("[DebuggerCore] too many system calls to stop on, the filter is %d instructions long", filter.size());
+		syscall_filter_.clear();
+		return false;
+	}
+
+	syscall_filter_ = filter;
+	return true;
+}
+
+//------------------------------------------------------------------------------
+// Name: trace_options_request
+// Desc: makes <request>, PTRACE_SEIZE or PTRACE_SETOPTIONS, with as many of
+//       our options as the kernel knows about. Clones and execs are always
+//       followed. Seccomp stops and killing the process should we go away
+//       depend on how new the kernel is; without seccomp filters in the
+//       kernel, there can't be one in the program either
+//------------------------------------------------------------------------------
+long DebuggerCore::trace_options_request(__ptrace_request request, edb::tid_t tid) {
+
+	static const long options[] = {
+		PTRACE_O_TRACECLONE | PTRACE_O_TRACEEXEC | PTRACE_O_TRACESECCOMP | PTRACE_O_EXITKILL,
+		PTRACE_O_TRACECLONE | PTRACE_O_TRACEEXEC | PTRACE_O_TRACESECCOMP,
+		PTRACE_O_TRACECLONE | PTRACE_O_TRACEEXEC
+	};
+
+	long r = -1;
+	for(std::size_t i = 0; i < sizeof(options) / sizeof(options[0]); ++i) {
+		r = ptrace_request(request, tid, 0, options[i]);
+		if(r == 0 || errno != EINVAL) {
+			break;
+		}
+	}
+
+	return r;
+}
+
+//------------------------------------------------------------------------------
+// Name: set_non_stop
+// Desc:
+//------------------------------------------------------------------------------
+bool DebuggerCore::set_non_stop(bool enable) {
+	non_stop_.fetchAndStoreRelaxed(enable);
+	return true;
+}
+
+//------------------------------------------------------------------------------
+// Name: non_stop
+// Desc: may be called from any thread
+//------------------------------------------------------------------------------
+bool DebuggerCore::non_stop() const {
+	return non_stop_.fetchAndAddRelaxed(0) != 0;
+}
+
+//------------------------------------------------------------------------------
+// Name: thread_running
+// Desc: a thread we haven't waited on since it was last resumed is running
+//------------------------------------------------------------------------------
+bool DebuggerCore::thread_running(edb::tid_t tid) const {
+	return threads_.contains(tid) && !waited_threads_.contains(tid);
+}
+
+//------------------------------------------------------------------------------
+// Name: passes_signal
+// Desc: returns true if <status> is a signal which the policy says to hand
+//       straight back to the thread, noting it in the log if asked to.
+//       Traps and our own SIGSTOPs are never passed
+//------------------------------------------------------------------------------
+bool DebuggerCore::passes_signal(edb::tid_t tid, int status) const {
+
+	if(signal_policies_.isEmpty() || !WIFSTOPPED(status) || (status >> 16) != 0) {
+		return false;
+	}
+
+	const int signal = WSTOPSIG(status);
+	if(signal == SIGTRAP || signal == SIGSTOP) {
+		return false;
+	}
+
+	switch(signal_policies_.value(signal, edb::SIGNAL_STOP)) {
+	case edb::SIGNAL_LOG:
+		qDebug("[DebuggerCore] passing signal %d to thread %d", signal, static_cast<int>(tid));
+		return true;
+	case edb::SIGNAL_PASS:
+		return true;
+	default:
+		return false;
+	}
+}
+
+//------------------------------------------------------------------------------
+// Name: attach_thread
+// Desc:
+//------------------------------------------------------------------------------
+bool DebuggerCore::attach_thread(edb::tid_t tid) {
+
+	// seizing a thread leaves it running and sets the options in the same
+	// breath, it gets stopped along with the rest afterwards
+	if(seized_) {
+		if(trace_options_request(PTRACE_SEIZE, tid) == 0) {
+			const thread_info info = { 0, thread_info::THREAD_STOPPED };
+			threads_[tid] = info;
+			return true;
+		}
+
+		// a kernel from before PTRACE_SEIZE, it is signals then
+		if(errno != EIO) {
+			return false;
+		}
+		seized_ = false;
+	}
+
+	if(ptrace_request(PTRACE_ATTACH, tid, 0, 0) == 0) {
+		// I *think* that the PTRACE_O_TRACECLONE is only valid on
+		// on stopped threads
+		int status;
+		if(waitpid_request(tid, &status, __WALL) > 0) {
+
+			const thread_info info = { status, thread_info::THREAD_STOPPED };
+			threads_[tid] = info;
+
+			add_waited_thread(tid);
+			if(trace_options_request(PTRACE_SETOPTIONS, tid) == -1) {
+				qDebug("[DebuggerCore] failed to set PTRACE_SETOPTIONS: [%d] %s", tid, strerror(errno));
+			}
+		}
+		return true;
+	}
+	return false;
+}
+
+//------------------------------------------------------------------------------
+// Name: attach
 // Desc:
 //------------------------------------------------------------------------------
 bool DebuggerCore::attach(edb::pid_t pid) {
@@ -599,6 +1491,13 @@ bool DebuggerCore::attach(edb::pid_t pid) {
 		pid_            = pid;
 		active_thread_  = pid;
 		event_thread_   = pid;
+
+		// seized threads are still running, anything they report on the way
+		// to stopping is kept for the first wait
+		if(seized_) {
+			stop_threads();
+		}
+
 		binary_info_    = edb::v1::get_binary_info(edb::v1::primary_code_region());
 		return true;
 	}
@@ -618,167 +1517,550 @@ void DebuggerCore::detach() {
 		clear_breakpoints();
 
 		Q_FOREACH(edb::tid_t thread, thread_ids()) {
-			if(ptrace(PTRACE_DETACH, thread, 0, 0) == 0) {
-				native::waitpid(thread, 0, __WALL);
+			if(ptrace_request(PTRACE_DETACH, thread, 0, 0) == 0) {
+				waitpid_request(thread, 0, __WALL);
+			}
+		}
+
+		reset();
+	}
+}
+
+//------------------------------------------------------------------------------
+// Name: kill
+// Desc:
+//------------------------------------------------------------------------------
+void DebuggerCore::kill() {
+	if(attached()) {
+		clear_breakpoints();
+
+		ptrace_request(PTRACE_KILL, pid(), 0, 0);
+
+		// TODO: do i need to actually do this wait?
+		waitpid_request(pid(), 0, __WALL);
+
+		reset();
+	}
+}
+
+//------------------------------------------------------------------------------
+// Name: pause
+// Desc: stops *all* threads of a process, except in non-stop mode where only
+//       one thread is stopped (the active one if it is running) and the rest
+//       carry on
+//------------------------------------------------------------------------------
+void DebuggerCore::pause() {
+	if(attached()) {
+		// belive it or not, I belive that this is sufficient for all threads
+		// this is because in the debug event handler above, the other threads
+		// are stopped when any event arrives, so no need to explicitly do
+		// it here. We just need any thread to stop.
+		if(seized_ || non_stop()) {
+			// an interrupt leaves no signal behind to be told apart from the
+			// program's own. The stop is to be reported even if one we asked
+			// for earlier is still on its way, they arrive as one. In non-stop
+			// mode only this thread stops, the active one if it is running
+			QList<edb::tid_t> threads = threads_.keys();
+			threads.removeOne(active_thread_);
+			threads.prepend(active_thread_);
+
+			Q_FOREACH(edb::tid_t tid, threads) {
+				if(thread_running(tid) && stop_thread(tid)) {
+					threads_[tid].state = thread_info::THREAD_STOPPED;
+					break;
+				}
+			}
+		} else {
+			// target the pid() which will send it to any one of the threads
+			// in the process.
+			::kill(pid(), SIGSTOP);
+		}
+	}
+}
+
+//------------------------------------------------------------------------------
+// Name: resume
+// Desc:
+//------------------------------------------------------------------------------
+void DebuggerCore::resume(edb::EVENT_STATUS status) {
+	// TODO: assert that we are paused
+
+	if(attached()) {
+		if(status != edb::DEBUG_STOP) {
+			invalidate_page_cache();
+
+			const edb::tid_t tid = active_thread();
+			if(defer_resume(tid, status)) {
+				return;
+			}
+
+			const int code = (status == edb::DEBUG_EXCEPTION_NOT_HANDLED) ? resume_code(threads_[tid].status) : 0;
+			ptrace_continue(tid, code);
+
+			// in non-stop mode every thread is resumed on its own
+			if(non_stop()) {
+				return;
 			}
+
+			// resume the other threads passing the signal they originally reported had
+			for(threadmap_t::const_iterator it = threads_.begin(); it != threads_.end(); ++it) {
+				if(waited_threads_.contains(it.key())) {
+					ptrace_continue(it.key(), resume_code(it->status));
+				}
+			}
+		}
+	}
+}
+
+//------------------------------------------------------------------------------
+// Name: defer_resume
+// Desc: if there are still events to report, nothing is resumed. What was
+//       decided for <tid>'s event is remembered for when the threads finally
+//       do get to run, and the next event is announced straight away
+//------------------------------------------------------------------------------
+bool DebuggerCore::defer_resume(edb::tid_t tid, edb::EVENT_STATUS status) {
+	if(deferred_events_.isEmpty()) {
+		return false;
+	}
+
+	if(status != edb::DEBUG_EXCEPTION_NOT_HANDLED) {
+		threads_[tid].status = 0;
+	}
+
+	post_event_notification();
+
+	// in non-stop mode only the threads with events wait for them to be
+	// reported, the one being resumed needn't
+	return !non_stop();
+}
+
+//------------------------------------------------------------------------------
+// Name: step
+// Desc:
+//------------------------------------------------------------------------------
+void DebuggerCore::step(edb::EVENT_STATUS status) {
+	// TODO: assert that we are paused
+
+	if(attached()) {
+		if(status != edb::DEBUG_STOP) {
+			invalidate_page_cache();
+
+			const edb::tid_t tid = active_thread();
+			if(defer_resume(tid, status)) {
+				return;
+			}
+
+			const int code = (status == edb::DEBUG_EXCEPTION_NOT_HANDLED) ? resume_code(threads_[tid].status) : 0;
+			ptrace_step(tid, code);
+		}
+	}
+}
+
+//------------------------------------------------------------------------------
+// Name: step_many
+// Desc: the whole run of steps is done in one trip to the ptrace thread, so a
+//       step costs the ptrace calls it needs and nothing else
+//------------------------------------------------------------------------------
+int DebuggerCore::step_many(IStepHandler *handler, int count, StepMode mode) {
+
+	Q_ASSERT(handler);
+
+	if(!attached() || count <= 0) {
+		return 0;
+	}
+
+	invalidate_page_cache();
+
+	// whatever is still waiting to be reported goes first
+	if(!deferred_events_.isEmpty()) {
+		post_event_notification();
+		return 0;
+	}
+
+	step_call call = { this, handler, count, mode, 0 };
+	ptrace_thread_.execute(do_step_many, &call);
+	return call.steps;
+}
+
+//------------------------------------------------------------------------------
+// Name: do_step_many
+// Desc:
+//------------------------------------------------------------------------------
+void DebuggerCore::do_step_many(void *context) {
+	step_call *const call = static_cast<step_call *>(context);
+	call->steps = call->core->step_thread(call->handler, call->count, call->mode);
+}
+
+//------------------------------------------------------------------------------
+// Name: is_step_trap
+// Desc: true if <status> is nothing more than the end of a step
+//------------------------------------------------------------------------------
+bool DebuggerCore::is_step_trap(edb::tid_t tid, int status) {
+
+	if(!WIFSTOPPED(status) || WSTOPSIG(status) != SIGTRAP || (status >> 16) != 0) {
+		return false;
+	}
+
+	// an int3 in the program's own code is a SIGTRAP too
+	siginfo_t siginfo;
+	return ptrace_getsiginfo(tid, &siginfo) != -1 && siginfo.si_code == TRAP_TRACE;
+}
+
+//------------------------------------------------------------------------------
+// Name: step_thread
+// Desc: does the work of step_many, on the ptrace thread
+//------------------------------------------------------------------------------
+int DebuggerCore::step_thread(IStepHandler *handler, int count, StepMode mode) {
+
+	const edb::tid_t tid = active_thread();
+	if(!waited_threads_.contains(tid)) {
+		return 0;
+	}
+
+	// a signal the thread was stopped with isn't delivered by tracing
+	threads_[tid].status = 0;
+
+	// the handler sees the same state get_state would, cache entry and all,
+	// so that the registers which are loaded lazily can be found
+	State state;
+	PlatformState *const state_impl = static_cast<PlatformState *>(state.impl_);
+	read_state(tid, state_impl);
+	cache_state(*state_impl);
+
+	// a breakpoint we are sitting on is taken out of the way for the first
+	// step, any other one ends the stepping before it is reached
+	IBreakpoint::pointer bp = find_breakpoint(state.instruction_pointer());
+	if(bp && !bp->enabled()) {
+		bp.clear();
+	}
+
+	int  steps  = 0;
+	long signal = 0;
+	while(steps < count) {
+
+		if(bp) {
+			bp->disable();
+		}
+
+		const long r = (mode == STEP_BLOCK) ? ptrace_block_step(tid, signal) : ptrace_step(tid, signal);
+		signal = 0;
+
+		if(r == -1) {
+			// the thread never went anywhere, block stepping isn't supported
+			// everywhere
+			add_waited_thread(tid);
+			if(bp) {
+				bp->enable();
+			}
+			return steps == 0 ? -1 : steps;
+		}
+
+		int status = 0;
+		const bool waited = waitpid_request(tid, &status, __WALL) == static_cast<pid_t>(tid);
+		if(!waited) {
+			qDebug("[DebuggerCore] failed to wait for thread %d while stepping: %s", static_cast<int>(tid), strerror(errno));
+		}
+
+		if(bp) {
+			bp->enable();
+		}
+
+		// there is no status to go on, so there is nothing to report either
+		if(!waited) {
+			break;
+		}
+
+		add_waited_thread(tid);
+
+		if(!is_step_trap(tid, status)) {
+			// a stop we asked for earlier which only now got through, the
+			// thread hasn't moved yet
+			if(is_stop_request(status) && threads_[tid].state == thread_info::THREAD_SIGNALED) {
+				threads_[tid].state = thread_info::THREAD_STOPPED;
+				continue;
+			}
+
+			// a signal which is passed on is delivered with the next step, the
+			// thread hasn't moved yet
+			if(passes_signal(tid, status)) {
+				signal = WSTOPSIG(status);
+				continue;
+			}
+
+			// reported like any other event the next time we are asked
+			threads_[tid].status = status;
+			deferred_events_.enqueue(tid);
+			post_event_notification();
+			break;
+		}
+
+		++steps;
+		bp.clear();
+
+		read_state(tid, state_impl);
+		cache_state(*state_impl);
+		if(!handler->handle_step(state)) {
+			break;
+		}
+
+		const IBreakpoint::pointer next = find_breakpoint(state.instruction_pointer());
+		if(next && next->enabled()) {
+			break;
+		}
+	}
+
+	return steps;
+}
+
+//------------------------------------------------------------------------------
+// Name: get_state
+// Desc: the registers of a thread can't change while it is stopped, so they are
+//       read once per stop and kept until the thread is resumed
+//------------------------------------------------------------------------------
+void DebuggerCore::get_state(State *state) {
+	// TODO: assert that we are paused
+
+	if(PlatformState *const state_impl = static_cast<PlatformState *>(state->impl_)) {
+		if(attached()) {
+			const edb::tid_t tid = active_thread();
+
+			QMutexLocker locker(&state_cache_mutex_);
+
+			const QHash<edb::tid_t, PlatformState>::const_iterator it = state_cache_.constFind(tid);
+			if(it != state_cache_.constEnd()) {
+				*state_impl = *it;
+				return;
+			}
+
+			read_state(tid, state_impl);
+			state_cache_.insert(tid, *state_impl);
+		} else {
+			state_impl->clear();
+		}
+	}
+}
+
+//------------------------------------------------------------------------------
+// Name: read_state
+// Desc: reads the general purpose registers of <tid> from the kernel, the FPU
+//       and debug registers are left for when (if ever) they are needed
+//------------------------------------------------------------------------------
+void DebuggerCore::read_state(edb::tid_t tid, PlatformState *state_impl) {
+
+	Q_ASSERT(state_impl);
+
+	state_impl->core_          = this;
+	state_impl->tid_           = tid;
+	state_impl->epoch_         = ++state_epoch_;
+	state_impl->fpregs_loaded_ = false;
+	state_impl->dr_loaded_     = false;
+
+	// whatever was loaded before belongs to an earlier stop
+	std::memset(&state_impl->fpregs_, 0, sizeof(state_impl->fpregs_));
+	std::memset(state_impl->dr_, 0, sizeof(state_impl->dr_));
+
+	if(ptrace_request(PTRACE_GETREGS, tid, 0, &state_impl->regs_) != -1) {
+	#if defined(EDB_X86)
+		struct user_desc desc;
+		std::memset(&desc, 0, sizeof(desc));
+
+		if(ptrace_request(PTRACE_GET_THREAD_AREA, tid, (state_impl->regs_.xgs / LDT_ENTRY_SIZE), &desc) != -1) {
+			state_impl->gs_base = desc.base_addr;
+		} else {
+			state_impl->gs_base = 0;
 		}
 
-		reset();
+		if(ptrace_request(PTRACE_GET_THREAD_AREA, tid, (state_impl->regs_.xfs / LDT_ENTRY_SIZE), &desc) != -1) {
+			state_impl->fs_base = desc.base_addr;
+		} else {
+			state_impl->fs_base = 0;
+		}
+	#elif defined(EDB_X86_64)
+	#endif
 	}
 }
 
 //------------------------------------------------------------------------------
-// Name: kill
-// Desc:
+// Name: cache_state
+// Desc: keeps <state>, freshly read by read_state, as the registers of its
+//       thread until the thread runs again
 //------------------------------------------------------------------------------
-void DebuggerCore::kill() {
-	if(attached()) {
-		clear_breakpoints();
-
-		ptrace(PTRACE_KILL, pid(), 0, 0);
-
-		// TODO: do i need to actually do this wait?
-		native::waitpid(pid(), 0, __WALL);
+void DebuggerCore::cache_state(const PlatformState &state) {
+	QMutexLocker locker(&state_cache_mutex_);
+	state_cache_.insert(state.tid_, state);
+}
 
-		reset();
+//------------------------------------------------------------------------------
+// Name: cached_state
+// Desc: returns the cached state <state> was copied from, or 0 if the thread
+//       has run since then
+// Note: state_cache_mutex_ must be held
+//------------------------------------------------------------------------------
+PlatformState *DebuggerCore::cached_state(const PlatformState *state) {
+	const QHash<edb::tid_t, PlatformState>::iterator it = state_cache_.find(state->tid_);
+	if(it == state_cache_.end() || it->epoch_ != state->epoch_) {
+		return 0;
 	}
+
+	return &*it;
 }
 
 //------------------------------------------------------------------------------
-// Name: pause
-// Desc: stops *all* threads of a process
+// Name: read_fpu_registers
+// Desc: reads the FPU registers of <tid> into <fpregs>, zeros if they can't be
+//       read
 //------------------------------------------------------------------------------
-void DebuggerCore::pause() {
-	if(attached()) {
-		// belive it or not, I belive that this is sufficient for all threads
-		// this is because in the debug event handler above, a SIGSTOP is sent
-		// to all threads when any event arrives, so no need to explicitly do
-		// it here. We just need any thread to stop. So we'll just target the
-		// pid() which will send it to any one of the threads in the process.
-		::kill(pid(), SIGSTOP);
+void DebuggerCore::read_fpu_registers(edb::tid_t tid, struct user_fpregs_struct *fpregs) {
+	if(ptrace_request(PTRACE_GETFPREGS, tid, 0, fpregs) == -1) {
+		std::memset(fpregs, 0, sizeof(*fpregs));
 	}
 }
 
 //------------------------------------------------------------------------------
-// Name: resume
-// Desc:
+// Name: read_debug_registers
+// Desc: reads the debug registers of <tid> into <dr>, the ones which can't be
+//       read are 0 (4 and 5 are just aliases of 6 and 7)
 //------------------------------------------------------------------------------
-void DebuggerCore::resume(edb::EVENT_STATUS status) {
-	// TODO: assert that we are paused
-
-	if(attached()) {
-		if(status != edb::DEBUG_STOP) {
-			const edb::tid_t tid = active_thread();
-			const int code = (status == edb::DEBUG_EXCEPTION_NOT_HANDLED) ? resume_code(threads_[tid].status) : 0;
-			ptrace_continue(tid, code);
+void DebuggerCore::read_debug_registers(edb::tid_t tid, edb::reg_t *dr) {
+	for(int i = 0; i < 8; ++i) {
+		dr[i] = 0;
+		if(i == 4 || i == 5) {
+			continue;
+		}
 
-			// resume the other threads passing the signal they originally reported had
-			for(threadmap_t::const_iterator it = threads_.begin(); it != threads_.end(); ++it) {
-				if(waited_threads_.contains(it.key())) {
-					ptrace_continue(it.key(), resume_code(it->status));
-				}
-			}
+		const long v = ptrace_request(PTRACE_PEEKUSER, tid, offsetof(struct user, u_debugreg[0]) + i * sizeof(dr[0]), 0);
+		if(v != -1 || errno == 0) {
+			dr[i] = v;
 		}
 	}
 }
 
 //------------------------------------------------------------------------------
-// Name: step
-// Desc:
+// Name: load_fpu_registers
+// Desc: fills in the FPU registers of a state returned by get_state, they are
+//       read once per stop no matter how many copies of the state ask for them
+// Note: a state without a cache entry (set_state dropped it, or the thread has
+//       run since) gets whatever the thread has now, which is what set_state
+//       would be writing over anyway
 //------------------------------------------------------------------------------
-void DebuggerCore::step(edb::EVENT_STATUS status) {
-	// TODO: assert that we are paused
+void DebuggerCore::load_fpu_registers(const PlatformState *state) {
 
-	if(attached()) {
-		if(status != edb::DEBUG_STOP) {
-			const edb::tid_t tid = active_thread();
-			const int code = (status == edb::DEBUG_EXCEPTION_NOT_HANDLED) ? resume_code(threads_[tid].status) : 0;
-			ptrace_step(tid, code);
+	Q_ASSERT(state);
+
+	QMutexLocker locker(&state_cache_mutex_);
+
+	if(PlatformState *const cached = cached_state(state)) {
+		if(!cached->fpregs_loaded_) {
+			read_fpu_registers(cached->tid_, &cached->fpregs_);
+			cached->fpregs_loaded_ = true;
 		}
+
+		state->fpregs_ = cached->fpregs_;
+	} else {
+		read_fpu_registers(state->tid_, &state->fpregs_);
 	}
 }
 
 //------------------------------------------------------------------------------
-// Name: get_state
-// Desc:
+// Name: load_debug_registers
+// Desc: fills in the debug registers of a state returned by get_state, they are
+//       read once per stop no matter how many copies of the state ask for them
+// Note: a state without a cache entry gets whatever the thread has now, see
+//       load_fpu_registers
 //------------------------------------------------------------------------------
-void DebuggerCore::get_state(State *state) {
-	// TODO: assert that we are paused
-
-	if(PlatformState *const state_impl = static_cast<PlatformState *>(state->impl_)) {
-		if(attached()) {
-			if(ptrace(PTRACE_GETREGS, active_thread(), 0, &state_impl->regs_) != -1) {
-			#if defined(EDB_X86)
-				struct user_desc desc;
-				std::memset(&desc, 0, sizeof(desc));
-
-				if(ptrace(PTRACE_GET_THREAD_AREA, active_thread(), (state_impl->regs_.xgs / LDT_ENTRY_SIZE), &desc) != -1) {
-					state_impl->gs_base = desc.base_addr;
-				} else {
-					state_impl->gs_base = 0;
-				}
-
-				if(ptrace(PTRACE_GET_THREAD_AREA, active_thread(), (state_impl->regs_.xfs / LDT_ENTRY_SIZE), &desc) != -1) {
-					state_impl->fs_base = desc.base_addr;
-				} else {
-					state_impl->fs_base = 0;
-				}
-			#elif defined(EDB_X86_64)
-			#endif
-			}
+void DebuggerCore::load_debug_registers(const PlatformState *state) {
 
-			// floating point registers
-			if(ptrace(PTRACE_GETFPREGS, active_thread(), 0, &state_impl->fpregs_) != -1) {
-			}
+	Q_ASSERT(state);
 
-			// debug registers
-			state_impl->dr_[0] = ptrace(PTRACE_PEEKUSER, active_thread(), offsetof(struct user, u_debugreg[0]), 0);
-			state_impl->dr_[1] = ptrace(PTRACE_PEEKUSER, active_thread(), offsetof(struct user, u_debugreg[1]), 0);
-			state_impl->dr_[2] = ptrace(PTRACE_PEEKUSER, active_thread(), offsetof(struct user, u_debugreg[2]), 0);
-			state_impl->dr_[3] = ptrace(PTRACE_PEEKUSER, active_thread(), offsetof(struct user, u_debugreg[3]), 0);
-			state_impl->dr_[4] = 0;
-			state_impl->dr_[5] = 0;
-			state_impl->dr_[6] = ptrace(PTRACE_PEEKUSER, active_thread(), offsetof(struct user, u_debugreg[6]), 0);
-			state_impl->dr_[7] = ptrace(PTRACE_PEEKUSER, active_thread(), offsetof(struct user, u_debugreg[7]), 0);
+	QMutexLocker locker(&state_cache_mutex_);
 
-		} else {
-			state_impl->clear();
+	if(PlatformState *const cached = cached_state(state)) {
+		if(!cached->dr_loaded_) {
+			read_debug_registers(cached->tid_, cached->dr_);
+			cached->dr_loaded_ = true;
 		}
+
+		std::memcpy(state->dr_, cached->dr_, sizeof(state->dr_));
+	} else {
+		read_debug_registers(state->tid_, state->dr_);
 	}
 }
 
 //------------------------------------------------------------------------------
 // Name: set_state
-// Desc:
+// Desc: only the registers which differ from what the thread already has are
+//       written back, debug registers which were never loaded can't have been
+//       changed and are left alone
 //------------------------------------------------------------------------------
 void DebuggerCore::set_state(const State &state) {
 
 	// TODO: assert that we are paused
 
-
 	if(attached()) {
 
 		if(PlatformState *const state_impl = static_cast<PlatformState *>(state.impl_)) {
-			ptrace(PTRACE_SETREGS, active_thread(), 0, &state_impl->regs_);
+			const edb::tid_t tid = active_thread();
+
+			QMutexLocker locker(&state_cache_mutex_);
+
+			const QHash<edb::tid_t, PlatformState>::const_iterator it = state_cache_.constFind(tid);
+			const PlatformState *const current = (it != state_cache_.constEnd()) ? &*it : 0;
+
+			if(!current || std::memcmp(&current->regs_, &state_impl->regs_, sizeof(state_impl->regs_)) != 0) {
+				ptrace_request(PTRACE_SETREGS, tid, 0, &state_impl->regs_);
+			}
+
+			// debug registers (4 and 5 are just aliases of 6 and 7)
+			if(state_impl->dr_loaded_) {
+				const bool compare = current && current->dr_loaded_;
+				for(int i = 0; i < 8; ++i) {
+					if(i == 4 || i == 5) {
+						continue;
+					}
+
+					if(!compare || current->dr_[i] != state_impl->dr_[i]) {
+						ptrace_request(PTRACE_POKEUSER, tid, offsetof(struct user, u_debugreg[0]) + i * sizeof(state_impl->dr_[0]), state_impl->dr_[i]);
+					}
+				}
+			}
 
-			// debug registers
-			ptrace(PTRACE_POKEUSER, active_thread(), offsetof(struct user, u_debugreg[0]), state_impl->dr_[0]);
-			ptrace(PTRACE_POKEUSER, active_thread(), offsetof(struct user, u_debugreg[1]), state_impl->dr_[1]);
-			ptrace(PTRACE_POKEUSER, active_thread(), offsetof(struct user, u_debugreg[2]), state_impl->dr_[2]);
-			ptrace(PTRACE_POKEUSER, active_thread(), offsetof(struct user, u_debugreg[3]), state_impl->dr_[3]);
-			//ptrace(PTRACE_POKEUSER, active_thread(), offsetof(struct user, u_debugreg[4]), state_impl->dr_[4]);
-			//ptrace(PTRACE_POKEUSER, active_thread(), offsetof(struct user, u_debugreg[5]), state_impl->dr_[5]);
-			ptrace(PTRACE_POKEUSER, active_thread(), offsetof(struct user, u_debugreg[6]), state_impl->dr_[6]);
-			ptrace(PTRACE_POKEUSER, active_thread(), offsetof(struct user, u_debugreg[7]), state_impl->dr_[7]);
+			// the kernel may not take everything as is (reserved flag bits for
+			// example), so just read it back next time it's asked for
+			state_cache_.remove(tid);
 		}
 	}
 }
 
 //------------------------------------------------------------------------------
 // Name: open
-// Desc:
+// Desc: the fork has to happen on the ptrace thread, because whichever thread
+//       forks the child is the one which gets to trace it
 //------------------------------------------------------------------------------
 bool DebuggerCore::open(const QString &path, const QString &cwd, const QList<QByteArray> &args, const QString &tty) {
+	open_call call = { this, &path, &cwd, &args, &tty, false };
+	ptrace_thread_.execute(do_open, &call);
+
+	if(call.result) {
+		binary_info_ = edb::v1::get_binary_info(edb::v1::primary_code_region());
+	}
+
+	return call.result;
+}
+
+//------------------------------------------------------------------------------
+// Name: do_open
+// Desc:
+//------------------------------------------------------------------------------
+void DebuggerCore::do_open(void *context) {
+	open_call *const call = static_cast<open_call *>(context);
+	call->result = call->core->open_process(*call->path, *call->cwd, *call->args, *call->tty);
+}
+
+//------------------------------------------------------------------------------
+// Name: open_process
+// Desc:
+//------------------------------------------------------------------------------
+bool DebuggerCore::open_process(const QString &path, const QString &cwd, const QList<QByteArray> &args, const QString &tty) {
 	detach();
 	pid_t pid;
 
@@ -786,9 +2068,6 @@ bool DebuggerCore::open(const QString &path, const QString &cwd, const QList<QBy
 	case 0:
 		// we are in the child now...
 
-		// set ourselves (the child proc) up to be traced
-		ptrace_traceme();
-
 		// redirect it's I/O
 		if(!tty.isEmpty()) {
 			FILE *const std_out = freopen(qPrintable(tty), "r+b", stdout);
@@ -800,6 +2079,19 @@ bool DebuggerCore::open(const QString &path, const QString &cwd, const QList<QBy
 			Q_UNUSED(std_err);
 		}
 
+		// wait for the parent to take hold of us, then everything from here
+		// on is traced with the options already in place. That includes
+		// seccomp stops, without which the system calls our filter picks
+		// would simply fail
+		::raise(SIGSTOP);
+
+		// only if there is something to stop on, as it is there for good
+		if(!syscall_filter_.isEmpty()) {
+			if(!install_syscall_filter(syscall_filter_)) {
+				perror("failed to install the system call filter");
+			}
+		}
+
 		// do the actual exec
 		execute_process(path, cwd, args);
 
@@ -816,39 +2108,59 @@ bool DebuggerCore::open(const QString &path, const QString &cwd, const QList<QBy
 			reset();
 
 			int status;
-			if(native::waitpid(pid, &status, __WALL) == -1) {
+			if(waitpid_request(pid, &status, __WALL | WUNTRACED) == -1) {
 				return false;
 			}
 
-			// the very first event should be a STOP of type SIGTRAP
-			if(!WIFSTOPPED(status) || WSTOPSIG(status) != SIGTRAP) {
-				detach();
-				return false;
+			if(!WIFSTOPPED(status) || WSTOPSIG(status) != SIGSTOP || !attach_thread(pid)) {
+				break;
 			}
 
-			waited_threads_.insert(pid);
+			// a seized child reports the stop it is in once more, now to us
+			if(!waited_threads_.contains(pid)) {
+				if(waitpid_request(pid, &status, __WALL) == -1) {
+					break;
+				}
+				add_waited_thread(pid);
+			}
 
-			// enable following clones (threads)
-			if(ptrace_set_options(pid, PTRACE_O_TRACECLONE) == -1) {
-				qDebug("[DebuggerCore] failed to set PTRACE_SETOPTIONS: %s", strerror(errno));
-				detach();
-				return false;
+			// it takes a SIGCONT to end that stop. Whatever the child does on
+			// the way to the exec (the SIGCONT, system calls our filter picks)
+			// is of no interest, if it dies instead the exec failed
+			::kill(pid, SIGCONT);
+
+			Q_FOREVER {
+				ptrace_continue(pid, resume_code(status));
+				if(waitpid_request(pid, &status, __WALL) == -1 || !WIFSTOPPED(status)) {
+					break;
+				}
+
+				add_waited_thread(pid);
+				if(is_exec_event(status)) {
+					break;
+				}
 			}
 
-			// setup the first event data for the primary thread
-			waited_threads_.insert(pid);
+			if(!is_exec_event(status)) {
+				break;
+			}
 
+			// setup the first event data for the primary thread
 			const thread_info info = { status, thread_info::THREAD_STOPPED };
 			threads_[pid]   = info;
 
 			pid_            = pid;
 			active_thread_  = pid;
 			event_thread_   = pid;
-			binary_info_    = edb::v1::get_binary_info(edb::v1::primary_code_region());
 
 			return true;
 		} while(0);
-		break;
+
+		qDebug("[DebuggerCore] failed to start tracing the new process: %s", strerror(errno));
+		::kill(pid, SIGKILL);
+		waitpid_request(pid, 0, __WALL);
+		reset();
+		return false;
 	}
 }
 
@@ -858,11 +2170,14 @@ bool DebuggerCore::open(const QString &path, const QString &cwd, const QList<QBy
 //------------------------------------------------------------------------------
 void DebuggerCore::set_active_thread(edb::tid_t tid) {
 	if(threads_.contains(tid)) {
-#if 0
+		// the registers of a running thread can't be looked at, which only
+		// happens in non-stop mode
+		if(!waited_threads_.contains(tid)) {
+			qDebug("[DebuggerCore] warning, attempted to set running thread as active: %d", tid);
+			return;
+		}
+
 		active_thread_ = tid;
-#else
-		qDebug("[DebuggerCore::set_active_thread] not implemented yet");
-#endif
 	} else {
 		qDebug("[DebuggerCore] warning, attempted to set invalid thread as active: %d", tid);
 	}
@@ -873,8 +2188,32 @@ void DebuggerCore::set_active_thread(edb::tid_t tid) {
 // Desc:
 //------------------------------------------------------------------------------
 void DebuggerCore::reset() {
+	invalidate_page_cache();
+
+	close_memory_file();
+
+	{
+		QMutexLocker locker(&maps_mutex_);
+		maps_contents_.clear();
+		maps_regions_.clear();
+	}
+
+	{
+		QMutexLocker locker(&state_cache_mutex_);
+		state_cache_.clear();
+	}
+
+	{
+		QMutexLocker locker(&waited_threads_mutex_);
+		waited_threads_.clear();
+	}
+
 	threads_.clear();
-	waited_threads_.clear();
+	deferred_events_.clear();
+
+	// whether process_vm_readv is allowed may differ for the next process
+	process_vm_readv_supported_ = true;
+	seized_        = true;
 	active_thread_ = 0;
 	pid_           = 0;
 	event_thread_  = 0;
@@ -975,15 +2314,23 @@ QList<IRegion::pointer> DebuggerCore::memory_regions() const {
 		QFile file(map_file);
         if(file.open(QIODevice::ReadOnly | QIODevice::Text)) {
 
-			QTextStream in(&file);
-			QString line = in.readLine();
+			// procfs files have no size, so read it all and compare it with
+			// what we parsed last time, most events don't change the map at all
+			const QByteArray contents = file.readAll();
+
+			QMutexLocker locker(&maps_mutex_);
+			if(contents == maps_contents_) {
+				return maps_regions_;
+			}
 
-			while(!line.isNull()) {
-				if(IRegion::pointer region = process_map_line(line)) {
+			Q_FOREACH(const QByteArray &line, contents.split('\n')) {
+				if(IRegion::pointer region = process_map_line(QString::fromLocal8Bit(line))) {
 					regions.push_back(region);
 				}
-				line = in.readLine();
 			}
+
+			maps_contents_ = contents;
+			maps_regions_  = regions;
 		}
 	}
 
@@ -1127,59 +2474,363 @@ QDateTime DebuggerCore::process_start(edb::pid_t pid) const {
 	return info.created();
 }
 
-#if 0
 #ifdef __NR_process_vm_readv
-	bool DebuggerCore::read_bytes(edb::address_t address, void *buf, std::size_t len) {
+//------------------------------------------------------------------------------
+// Name: fetch_pages
+// Desc: reads up to <count> whole pages starting at <page> into <buffer> with
+//       a single process_vm_readv, and adds them to the page cache unless in
+//       non-stop mode. Returns how many pages were read
+// Note: each page gets its own remote iovec, the kernel stops at the first one
+//       which faults, so a short read always ends on a page boundary
+//------------------------------------------------------------------------------
+std::size_t DebuggerCore::fetch_pages(edb::address_t page, std::size_t count, quint8 *buffer) {
 
-		if(pid_ != 0) {
-			struct iovec local[1];
-			struct iovec remote[1];
+	Q_ASSERT((page & (page_size() - 1)) == 0);
+	Q_ASSERT(count <= IOV_MAX);
+	Q_ASSERT(buffer);
 
-			local[0].iov_base  = buf;
-			local[0].iov_len   = len;
-			remote[0].iov_base = reinterpret_cast<void *>(address);
-			remote[0].iov_len  = len;
+	struct iovec local[1];
+	struct iovec remote[IOV_MAX];
 
-			const ssize_t n = syscall(__NR_process_vm_readv, (long)pid_, local, 1, remote, 1, 0);
+	for(std::size_t i = 0; i < count; ++i) {
+		remote[i].iov_base = reinterpret_cast<void *>(page + i * page_size());
+		remote[i].iov_len  = page_size();
+	}
 
-			if(n > 0) {
-				// TODO: handle if breakponts have a size more than 1!
-				Q_FOREACH(const IBreakpoint::pointer &bp, breakpoints_) {
-					if(bp->address() >= address && bp->address() < (address + n)) {
-						// show the original bytes in the buffer..
-						reinterpret_cast<quint8 *>(buf)[bp->address() - address] = bp->original_bytes()[0];
-					}
+	local[0].iov_base = buffer;
+	local[0].iov_len  = count * page_size();
+
+	const ssize_t n = syscall(__NR_process_vm_readv, static_cast<long>(pid_), local, 1, remote, count, 0);
+
+	// not there at all, or not allowed for this process (Yama, seccomp in a
+	// container...), either way there is no point in asking again
+	if(n == -1 && (errno == ENOSYS || errno == EPERM)) {
+		process_vm_readv_supported_ = false;
+	}
+
+	if(n <= 0) {
+		return 0;
+	}
+
+	const std::size_t pages = static_cast<std::size_t>(n) / page_size();
+	if(!non_stop()) {
+		for(std::size_t i = 0; i < pages; ++i) {
+			cache_page(page + i * page_size(), QByteArray(reinterpret_cast<const char *>(buffer + i * page_size()), page_size()));
+		}
+	}
+
+	return pages;
+}
+
+//------------------------------------------------------------------------------
+// Name: read_bytes
+// Desc: reads <len> bytes into <buf> starting at <address>
+// Note: if the read failed, the part of the buffer that could not be read will
+//       be filled with 0xff bytes, this is done on a per page basis. Returns
+//       false if any of it could not be read
+// Note: pages are read whole and kept until the process runs again, pages which
+//       process_vm_readv can't reach (such as ones without read permissions)
+//       are retried with ptrace, which can see them, but are not cached
+//------------------------------------------------------------------------------
+bool DebuggerCore::read_bytes(edb::address_t address, void *buf, std::size_t len) {
+
+	Q_ASSERT(buf);
+
+	if(!attached()) {
+		return false;
+	}
+
+	if(!process_vm_readv_supported_) {
+		return DebuggerCoreUNIX::read_bytes(address, buf, len);
+	}
+
+	quint8 *const ptr              = reinterpret_cast<quint8 *>(buf);
+	const edb::address_t last_page = (address + len - 1) & ~(page_size() - 1);
+	std::size_t offset             = 0;
+	bool ok                        = true;
+
+	// the pages read ahead by the last fetch, the buffer is sized for the first
+	// (and largest) one and reused for the rest
+	QByteArray     ahead;
+	edb::address_t ahead_page  = 0;
+	std::size_t    ahead_count = 0;
+
+	while(offset != len) {
+		const edb::address_t current = address + offset;
+		const edb::address_t page    = current & ~(page_size() - 1);
+		const std::size_t n          = qMin<std::size_t>(page + page_size() - current, len - offset);
+
+		const char *data = 0;
+		QByteArray cached;
+
+		if(page >= ahead_page && page < ahead_page + ahead_count * page_size()) {
+			data = ahead.constData() + (page - ahead_page);
+		} else {
+			// in non-stop mode the running threads may change memory at any
+			// time, so the cache is left out
+			if(!non_stop()) {
+				cached = cached_page(page);
+			}
+
+			if(!cached.isNull()) {
+				data = cached.constData();
+			} else if(process_vm_readv_supported_) {
+				// the rest of the request in one go. A page which can't be read
+				// ends it, that page is left to ptrace and the next fetch goes
+				// on from the one after it
+				const std::size_t count = qMin<std::size_t>((last_page - page) / page_size() + 1, IOV_MAX);
+				if(static_cast<std::size_t>(ahead.size()) < count * page_size()) {
+					ahead.resize(count * page_size());
+				}
+
+				ahead_page  = page;
+				ahead_count = fetch_pages(page, count, reinterpret_cast<quint8 *>(ahead.data()));
+				if(ahead_count != 0) {
+					data = ahead.constData();
 				}
-				return true;
 			}
 		}
 
+		if(data) {
+			std::memcpy(ptr + offset, data + (current - page), n);
+		} else if(!read_words(current, ptr + offset, n)) {
+			std::memset(ptr + offset, 0xff, n);
+			ok = false;
+		}
+
+		offset += n;
+	}
+
+	mask_breakpoints(address, ptr, len);
+	return ok;
+}
+
+//------------------------------------------------------------------------------
+// Name: read_ranges
+// Desc: reads all of the ranges using as few process_vm_readv calls as
+//       possible, every range is split into per page iovecs so that a
+//       fault only costs us the page it happened on
+//------------------------------------------------------------------------------
+bool DebuggerCore::read_ranges(MemoryRangeList *ranges) {
+
+	Q_ASSERT(ranges);
+
+	if(!attached()) {
 		return false;
 	}
-#endif
 
-#ifdef __NR_process_vm_writev
-	bool DebuggerCore::write_bytes(edb::address_t address, const void *buf, std::size_t len) {
-		if(pid_ != 0) {
-			struct iovec local[1];
-			struct iovec remote[1];
+	if(!process_vm_readv_supported_) {
+		return DebuggerCoreUNIX::read_ranges(ranges);
+	}
+
+	QVector<read_piece> pieces;
+	for(int i = 0; i < ranges->size(); ++i) {
+		MemoryRange &r     = (*ranges)[i];
+		quint8 *const ptr  = reinterpret_cast<quint8 *>(r.buffer);
+		std::size_t offset = 0;
+
+		r.ok = true;
+		while(offset != r.length) {
+			const edb::address_t page_end = ((r.address + offset) & ~(page_size() - 1)) + page_size();
+			const read_piece p = {
+				r.address + offset,
+				ptr + offset,
+				qMin<std::size_t>(page_end - (r.address + offset), r.length - offset),
+				i
+			};
+
+			pieces.push_back(p);
+			offset += p.length;
+		}
+	}
+
+	QVector<struct iovec> local(qMin(pieces.size(), IOV_MAX));
+	QVector<struct iovec> remote(local.size());
+
+	int index = 0;
+	while(index != pieces.size()) {
+
+		const int count = qMin(pieces.size() - index, IOV_MAX);
+		for(int i = 0; i < count; ++i) {
+			local[i].iov_base  = pieces[index + i].buffer;
+			local[i].iov_len   = pieces[index + i].length;
+			remote[i].iov_base = reinterpret_cast<void *>(pieces[index + i].address);
+			remote[i].iov_len  = pieces[index + i].length;
+		}
 
-			local[0].iov_base  = const_cast<void *>(buf);
-			local[0].iov_len   = len;
-			remote[0].iov_base = reinterpret_cast<void *>(address);
-			remote[0].iov_len  = len;
+		const ssize_t n = syscall(__NR_process_vm_readv, static_cast<long>(pid_), local.data(), count, remote.data(), count, 0);
+		if(n == -1 && (errno == ENOSYS || errno == EPERM)) {
+			process_vm_readv_supported_ = false;
+		}
 
-			const ssize_t n = syscall(__NR_process_vm_writev, (long)pid_, local, 1, remote, 1, 0);
+		// skip past everything which was read in full
+		const int end = index + count;
+		std::size_t done = (n > 0) ? n : 0;
+		while(index != end && done >= pieces[index].length) {
+			done -= pieces[index].length;
+			++index;
+		}
 
-			if(n > 0) {
-				return true;
+		// the piece we stopped on faulted, fall back to word sized reads for it
+		if(index != end) {
+			const read_piece &p = pieces[index];
+			if(!read_words(p.address, p.buffer, p.length)) {
+				std::memset(p.buffer, 0xff, p.length);
+				(*ranges)[p.range].ok = false;
 			}
+			++index;
+		}
+	}
+
+	for(MemoryRangeList::iterator it = ranges->begin(); it != ranges->end(); ++it) {
+		mask_breakpoints(it->address, reinterpret_cast<quint8 *>(it->buffer), it->length);
+	}
+
+	return true;
+}
+#endif
+
+//------------------------------------------------------------------------------
+// Name: open_memory_file
+// Desc: returns a descriptor for /proc/<pid>/mem, it is opened read-write if we
+//       are permitted to and read-only otherwise, then kept until we detach
+// Note: memory_fd_mutex_ must be held, and stay held for as long as the
+//       descriptor is used, or it may be closed (and its number reused) by
+//       another thread
+//------------------------------------------------------------------------------
+int DebuggerCore::open_memory_file() {
+	if(memory_fd_ == -1 && attached()) {
+		char path[64];
+		qsnprintf(path, sizeof(path), "/proc/%d/mem", pid_);
+
+		memory_fd_ = ::open(path, O_RDWR | O_CLOEXEC);
+		if(memory_fd_ == -1) {
+			memory_fd_ = ::open(path, O_RDONLY | O_CLOEXEC);
+		}
+	}
+	return memory_fd_;
+}
+
+//------------------------------------------------------------------------------
+// Name: read_memory_file
+// Desc: preads up to <len> bytes at <address> from /proc/<pid>/mem, returns
+//       what pread64 does, or -1 if the file can't be opened
+//------------------------------------------------------------------------------
+ssize_t DebuggerCore::read_memory_file(edb::address_t address, void *buf, std::size_t len) {
+	QMutexLocker locker(&memory_fd_mutex_);
+
+	bool reopened = false;
+	Q_FOREVER {
+		const int fd = open_memory_file();
+		if(fd == -1) {
+			return -1;
+		}
+
+		const ssize_t n = ::pread64(fd, buf, len, address);
+		if(n == -1 && errno == EINTR) {
+			continue;
+		}
+
+		// a /proc/<pid>/mem descriptor is tied to the address space which
+		// existed when it was opened, after an exec it just reads as empty
+		if(n == 0 && !reopened) {
+			::close(memory_fd_);
+			memory_fd_ = -1;
+			reopened   = true;
+			continue;
+		}
+
+		return n;
+	}
+}
+
+//------------------------------------------------------------------------------
+// Name: write_memory_file
+// Desc: pwrites up to <len> bytes at <address> to /proc/<pid>/mem, returns
+//       what pwrite64 does, or -1 if the file can't be opened
+//------------------------------------------------------------------------------
+ssize_t DebuggerCore::write_memory_file(edb::address_t address, const void *buf, std::size_t len) {
+	QMutexLocker locker(&memory_fd_mutex_);
+
+	bool reopened = false;
+	Q_FOREVER {
+		const int fd = open_memory_file();
+		if(fd == -1) {
+			return -1;
+		}
+
+		const ssize_t n = ::pwrite64(fd, buf, len, address);
+		if(n == -1 && errno == EINTR) {
+			continue;
 		}
 
+		// see read_memory_file
+		if(n == 0 && !reopened) {
+			::close(memory_fd_);
+			memory_fd_ = -1;
+			reopened   = true;
+			continue;
+		}
+
+		return n;
+	}
+}
+
+//------------------------------------------------------------------------------
+// Name: close_memory_file
+// Desc:
+//------------------------------------------------------------------------------
+void DebuggerCore::close_memory_file() {
+	QMutexLocker locker(&memory_fd_mutex_);
+
+	if(memory_fd_ != -1) {
+		::close(memory_fd_);
+		memory_fd_ = -1;
+	}
+}
+
+//------------------------------------------------------------------------------
+// Name: write_bytes
+// Desc: writes <len> bytes from <buf> starting at <address>
+// Note: /proc/<pid>/mem takes the whole buffer in one go, even for read-only
+//       pages. If that isn't possible, what is left is poked in word by word
+// Note: writing over an enabled breakpoint leaves it in place, the new bytes
+//       will be restored when it is disabled
+//------------------------------------------------------------------------------
+bool DebuggerCore::write_bytes(edb::address_t address, const void *buf, std::size_t len) {
+
+	Q_ASSERT(buf);
+
+	if(!attached()) {
 		return false;
 	}
-#endif
-#endif
+
+	invalidate_page_cache();
+
+	const quint8 *const ptr = reinterpret_cast<const quint8 *>(buf);
+
+	QByteArray                  patched;
+	QList<IBreakpoint::pointer> shadowed;
+	const quint8 *const data = shadow_breakpoints(address, ptr, len, &patched, &shadowed);
+
+	std::size_t offset = 0;
+
+	while(offset != len) {
+		const ssize_t n = write_memory_file(address + offset, data + offset, len - offset);
+		if(n <= 0) {
+			break;
+		}
+
+		offset += n;
+	}
+
+	if(offset != len && !write_words(address + offset, data + offset, len - offset)) {
+		return false;
+	}
+
+	update_shadows(address, ptr, shadowed);
+	return true;
+}
 
 //------------------------------------------------------------------------------
 // Name:
@@ -20,15 +20,24 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #define DEBUGGERCORE_20090529_H_
 
 #include "DebuggerCoreUNIX.h"
+#include "PlatformState.h"
+#include "PtraceThread.h"
+#include <QAtomicInt>
 #include <QHash>
+#include <QQueue>
 #include <QSet>
+#include <QVector>
 #include <csignal>
+#include <linux/filter.h>
+#include <sys/ptrace.h>
+#include <sys/wait.h>
 #include <sys/syscall.h>   /* For SYS_xxx definitions */
 #include <unistd.h>
 
 // These system calls were added in Linux 3.2. Support is provided in glibc since version 2.15.
 
 class IBinary;
+class PlatformEvent;
 
 class DebuggerCore : public DebuggerCoreUNIX {
 	Q_OBJECT
@@ -38,6 +47,7 @@ class DebuggerCore : public DebuggerCoreUNIX {
 	Q_INTERFACES(IDebuggerCore)
 	Q_CLASSINFO("author", "Evan Teran")
 	Q_CLASSINFO("url", "http://www.codef00.com")
+	friend class PlatformState;
 
 public:
 	DebuggerCore();
@@ -53,6 +63,10 @@ public:
 	virtual void pause();
 	virtual void resume(edb::EVENT_STATUS status);
 	virtual void step(edb::EVENT_STATUS status);
+	virtual int step_many(IStepHandler *handler, int count, StepMode mode);
+	virtual void set_signal_policy(int signal, edb::SIGNAL_POLICY policy);
+	virtual bool set_syscall_stops(const QMap<QString, QList<int> > &syscalls);
+	virtual bool set_non_stop(bool enable);
 	virtual void get_state(State *state);
 	virtual void set_state(const State &state);
 	virtual bool open(const QString &path, const QString &cwd, const QList<QByteArray> &args, const QString &tty);
@@ -63,6 +77,7 @@ public:
 	virtual QList<edb::tid_t> thread_ids() const { return threads_.keys(); }
 	virtual edb::tid_t active_thread() const     { return active_thread_; }
 	virtual void set_active_thread(edb::tid_t);
+	virtual bool thread_running(edb::tid_t tid) const;
 
 public:
 	virtual QList<IRegion::pointer> memory_regions() const;
@@ -84,15 +99,12 @@ public:
 
 
 public:
-#if 0
 #ifdef __NR_process_vm_readv
 	virtual bool read_bytes(edb::address_t address, void *buf, std::size_t len);        // TODO: remind me why these aren't const...
+	virtual bool read_ranges(MemoryRangeList *ranges);
 #endif
 
-#ifdef __NR_process_vm_writev
 	virtual bool write_bytes(edb::address_t address, const void *buf, std::size_t len); // TODO: remind me why these aren't const...
-#endif
-#endif
 
 private:
 	virtual QMap<edb::pid_t, Process> enumerate_processes() const;
@@ -106,17 +118,106 @@ private:
 	virtual bool write_data(edb::address_t address, long value);
 
 private:
+	// these may be called from any thread, the work is done on the ptrace thread.
+	// That makes reading and writing memory safe from anywhere, but the thread
+	// bookkeeping (threads_, waited_threads_, deferred_events_, active_thread_)
+	// is not synchronized, so attaching, resuming, stepping, get_state and the
+	// like are for the thread which drives the debugger alone
+	long ptrace_request(__ptrace_request request, edb::tid_t tid, edb::address_t addr, edb::address_t data);
+	pid_t waitpid_request(edb::tid_t tid, int *status, int options);
+	int waitid_request(idtype_t idtype, id_t id, siginfo_t *info, int options);
+
+	template <class T>
+	long ptrace_request(__ptrace_request request, edb::tid_t tid, edb::address_t addr, T *data) {
+		return ptrace_request(request, tid, addr, reinterpret_cast<edb::address_t>(data));
+	}
+
 	long ptrace_getsiginfo(edb::tid_t tid, siginfo_t *siginfo);
 	long ptrace_continue(edb::tid_t tid, long status);
 	long ptrace_step(edb::tid_t tid, long status);
+	long ptrace_block_step(edb::tid_t tid, long status);
 	long ptrace_set_options(edb::tid_t tid, long options);
+	long trace_options_request(__ptrace_request request, edb::tid_t tid);
 	long ptrace_get_event_message(edb::tid_t tid, unsigned long *message);
-	long ptrace_traceme();
+	void invalidate_state(edb::tid_t tid);
+	void read_state(edb::tid_t tid, PlatformState *state_impl);
+	void cache_state(const PlatformState &state);
+	PlatformState *cached_state(const PlatformState *state);
+	void read_fpu_registers(edb::tid_t tid, struct user_fpregs_struct *fpregs);
+	void read_debug_registers(edb::tid_t tid, edb::reg_t *dr);
+	void load_fpu_registers(const PlatformState *state);
+	void load_debug_registers(const PlatformState *state);
+
+private:
+	int open_memory_file();
+	ssize_t read_memory_file(edb::address_t address, void *buf, std::size_t len);
+	ssize_t write_memory_file(edb::address_t address, const void *buf, std::size_t len);
+	void close_memory_file();
+
+#ifdef __NR_process_vm_readv
+	std::size_t fetch_pages(edb::address_t page, std::size_t count, quint8 *buffer);
+#endif
+
+private:
+	struct open_call {
+		DebuggerCore            *core;
+		const QString           *path;
+		const QString           *cwd;
+		const QList<QByteArray> *args;
+		const QString           *tty;
+		bool                    result;
+	};
+
+	struct wait_call {
+		DebuggerCore *core;
+		edb::tid_t   tid;
+		int          status;
+	};
+
+	struct step_call {
+		DebuggerCore *core;
+		IStepHandler *handler;
+		int          count;
+		StepMode     mode;
+		int          steps;
+	};
+
+	struct memory_call {
+		DebuggerCore     *core;
+		__ptrace_request request;
+		edb::address_t   addr;
+		edb::address_t   data;
+		long             result;
+		int              error;
+	};
+
+	static void do_open(void *context);
+	static void do_wait_thread(void *context);
+	static void do_step_many(void *context);
+	static void do_memory_request(void *context);
+	long memory_request(__ptrace_request request, edb::address_t addr, edb::address_t data);
+	bool open_process(const QString &path, const QString &cwd, const QList<QByteArray> &args, const QString &tty);
+	edb::tid_t wait_thread(int *status);
+	int step_thread(IStepHandler *handler, int count, StepMode mode);
+	bool is_step_trap(edb::tid_t tid, int status);
 
 private:
 	void reset();
 	void stop_threads();
+	bool stop_thread(edb::tid_t tid);
+	bool is_stop_request(int status) const;
+	edb::tid_t stopped_thread() const;
+	void add_waited_thread(edb::tid_t tid);
+	void remove_waited_thread(edb::tid_t tid);
+	edb::tid_t wait_stopping_thread(const QSet<edb::tid_t> &stopping, int *status);
+	bool defer_resume(edb::tid_t tid, edb::EVENT_STATUS status);
+	bool non_stop() const;
+	QSet<edb::tid_t> hold_threads();
+	void release_threads(const QSet<edb::tid_t> &held);
+	IDebugEvent::const_pointer reported_event(const IDebugEvent::const_pointer &event);
 	IDebugEvent::const_pointer handle_event(edb::tid_t tid, int status);
+	bool skip_breakpoint(edb::tid_t tid, PlatformEvent *event);
+	bool passes_signal(edb::tid_t tid, int status) const;
 	bool attach_thread(edb::tid_t tid);
 
 private:
@@ -130,11 +231,31 @@ private:
 
 	typedef QHash<edb::tid_t, thread_info> threadmap_t;
 
-	edb::address_t   page_size_;
-	threadmap_t      threads_;
-	QSet<edb::tid_t> waited_threads_;
-	edb::tid_t       event_thread_;
-	IBinary          *binary_info_;
+	edb::address_t     page_size_;
+	threadmap_t        threads_;
+	QSet<edb::tid_t>   waited_threads_;
+	mutable QMutex     waited_threads_mutex_;
+	QQueue<edb::tid_t> deferred_events_;
+	QHash<int, edb::SIGNAL_POLICY> signal_policies_;
+	QVector<sock_filter> syscall_filter_;
+	edb::tid_t         event_thread_;
+	IBinary            *binary_info_;
+	bool               process_vm_readv_supported_;
+	bool               seized_;
+	mutable QAtomicInt non_stop_;
+	int                memory_fd_;
+	QMutex             memory_fd_mutex_;
+	PtraceThread       ptrace_thread_;
+
+	// the last memory map we read and what it parsed to
+	mutable QMutex                   maps_mutex_;
+	mutable QByteArray               maps_contents_;
+	mutable QList<IRegion::pointer>  maps_regions_;
+
+	// registers of stopped threads, dropped as soon as a thread is resumed
+	QMutex                           state_cache_mutex_;
+	QHash<edb::tid_t, PlatformState> state_cache_;
+	quint64                          state_epoch_;
 };
 
 #endif
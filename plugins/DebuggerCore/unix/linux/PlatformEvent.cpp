@@ -19,10 +19,20 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #include "PlatformEvent.h"
 #include "edb.h"
 
+#include <sys/ptrace.h>
+
+#ifndef PTRACE_EVENT_SECCOMP
+#define PTRACE_EVENT_SECCOMP 7
+#endif
+
+#ifndef PTRACE_EVENT_STOP
+#define PTRACE_EVENT_STOP 128
+#endif
+
 //------------------------------------------------------------------------------
 // Name: 
 //------------------------------------------------------------------------------
-PlatformEvent::PlatformEvent() : pid_(0), tid_(0), status_(0) {
+PlatformEvent::PlatformEvent() : pid_(0), tid_(0), status_(0), breakpoint_action_(edb::BREAKPOINT_UNDECIDED) {
 	std::memset(&siginfo_, 0, sizeof(siginfo_t));
 }
 
@@ -130,6 +140,12 @@ IDebugEvent::REASON PlatformEvent::reason() const {
 // Name: 
 //------------------------------------------------------------------------------
 IDebugEvent::TRAP_REASON PlatformEvent::trap_reason() const {
+
+	// a seccomp filter sent us here, on the way into a system call
+	if(((status_ >> 16) & 0xffff) == PTRACE_EVENT_SECCOMP) {
+		return TRAP_SYSCALL;
+	}
+
 	switch(siginfo_.si_code) {
 	case TRAP_TRACE: return TRAP_STEPPING;
 	default:         return TRAP_BREAKPOINT;
@@ -224,6 +240,11 @@ edb::tid_t PlatformEvent::thread() const {
 //------------------------------------------------------------------------------
 int PlatformEvent::code() const {
 	if(stopped()) {
+		// a stop asked for with PTRACE_INTERRUPT says SIGTRAP, but is nothing
+		// more than a stop
+		if(((status_ >> 16) & 0xffff) == PTRACE_EVENT_STOP) {
+			return SIGSTOP;
+		}
 		return WSTOPSIG(status_);
 	}
 	
@@ -237,3 +258,20 @@ int PlatformEvent::code() const {
 	
 	return 0;
 }
+
+//------------------------------------------------------------------------------
+// Name: breakpoint_action
+// Desc: set by the core when it has looked at the breakpoint hit this event is
+//       for and decided to report it
+//------------------------------------------------------------------------------
+edb::BREAKPOINT_ACTION PlatformEvent::breakpoint_action() const {
+	return breakpoint_action_;
+}
+
+//------------------------------------------------------------------------------
+// Name: breakpoint_error
+// Desc:
+//------------------------------------------------------------------------------
+QString PlatformEvent::breakpoint_error() const {
+	return breakpoint_error_;
+}
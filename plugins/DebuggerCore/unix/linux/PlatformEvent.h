@@ -48,11 +48,17 @@ public:
 	virtual edb::tid_t thread() const;
 	virtual int code() const;
 
+public:
+	virtual edb::BREAKPOINT_ACTION breakpoint_action() const;
+	virtual QString breakpoint_error() const;
+
 private:
-	siginfo_t  siginfo_;
-	edb::pid_t pid_;
-	edb::tid_t tid_;
-	int        status_;
+	siginfo_t              siginfo_;
+	edb::pid_t             pid_;
+	edb::tid_t             tid_;
+	int                    status_;
+	edb::BREAKPOINT_ACTION breakpoint_action_;
+	QString                breakpoint_error_;
 };
 
 #endif
@@ -17,12 +17,185 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 */
 
 #include "PlatformState.h"
+#include "DebuggerCore.h"
+
+#include <QHash>
+#include <cstddef>
+
+namespace {
+
+// where the value of a register lives
+enum register_source {
+	SOURCE_REGS,   // in regs_
+	SOURCE_FS_BASE,
+	SOURCE_GS_BASE
+};
+
+// describes where to find a register and how to pull it out of the (possibly
+// larger) register which holds it
+struct register_info {
+	const char      *name;
+	std::size_t     offset;
+	int             shift;
+	edb::reg_t      mask;
+	Register::Type  type;
+	register_source source;
+};
+
+#define REG_OFFSET(field) offsetof(struct user_regs_struct, field)
+
+const edb::reg_t FULL = static_cast<edb::reg_t>(-1);
+
+const register_info registers[] = {
+#if defined(EDB_X86)
+	{ "eax",     REG_OFFSET(eax),     0, FULL,       Register::TYPE_GPR,  SOURCE_REGS },
+	{ "ebx",     REG_OFFSET(ebx),     0, FULL,       Register::TYPE_GPR,  SOURCE_REGS },
+	{ "ecx",     REG_OFFSET(ecx),     0, FULL,       Register::TYPE_GPR,  SOURCE_REGS },
+	{ "edx",     REG_OFFSET(edx),     0, FULL,       Register::TYPE_GPR,  SOURCE_REGS },
+	{ "ebp",     REG_OFFSET(ebp),     0, FULL,       Register::TYPE_GPR,  SOURCE_REGS },
+	{ "esp",     REG_OFFSET(esp),     0, FULL,       Register::TYPE_GPR,  SOURCE_REGS },
+	{ "esi",     REG_OFFSET(esi),     0, FULL,       Register::TYPE_GPR,  SOURCE_REGS },
+	{ "edi",     REG_OFFSET(edi),     0, FULL,       Register::TYPE_GPR,  SOURCE_REGS },
+	{ "eip",     REG_OFFSET(eip),     0, FULL,       Register::TYPE_IP,   SOURCE_REGS },
+	{ "ax",      REG_OFFSET(eax),     0, 0xffff,     Register::TYPE_GPR,  SOURCE_REGS },
+	{ "bx",      REG_OFFSET(ebx),     0, 0xffff,     Register::TYPE_GPR,  SOURCE_REGS },
+	{ "cx",      REG_OFFSET(ecx),     0, 0xffff,     Register::TYPE_GPR,  SOURCE_REGS },
+	{ "dx",      REG_OFFSET(edx),     0, 0xffff,     Register::TYPE_GPR,  SOURCE_REGS },
+	{ "bp",      REG_OFFSET(ebp),     0, 0xffff,     Register::TYPE_GPR,  SOURCE_REGS },
+	{ "sp",      REG_OFFSET(esp),     0, 0xffff,     Register::TYPE_GPR,  SOURCE_REGS },
+	{ "si",      REG_OFFSET(esi),     0, 0xffff,     Register::TYPE_GPR,  SOURCE_REGS },
+	{ "di",      REG_OFFSET(edi),     0, 0xffff,     Register::TYPE_GPR,  SOURCE_REGS },
+	{ "al",      REG_OFFSET(eax),     0, 0xff,       Register::TYPE_GPR,  SOURCE_REGS },
+	{ "bl",      REG_OFFSET(ebx),     0, 0xff,       Register::TYPE_GPR,  SOURCE_REGS },
+	{ "cl",      REG_OFFSET(ecx),     0, 0xff,       Register::TYPE_GPR,  SOURCE_REGS },
+	{ "dl",      REG_OFFSET(edx),     0, 0xff,       Register::TYPE_GPR,  SOURCE_REGS },
+	{ "ah",      REG_OFFSET(eax),     8, 0xff,       Register::TYPE_GPR,  SOURCE_REGS },
+	{ "bh",      REG_OFFSET(ebx),     8, 0xff,       Register::TYPE_GPR,  SOURCE_REGS },
+	{ "ch",      REG_OFFSET(ecx),     8, 0xff,       Register::TYPE_GPR,  SOURCE_REGS },
+	{ "dh",      REG_OFFSET(edx),     8, 0xff,       Register::TYPE_GPR,  SOURCE_REGS },
+	{ "cs",      REG_OFFSET(xcs),     0, FULL,       Register::TYPE_SEG,  SOURCE_REGS },
+	{ "ds",      REG_OFFSET(xds),     0, FULL,       Register::TYPE_SEG,  SOURCE_REGS },
+	{ "es",      REG_OFFSET(xes),     0, FULL,       Register::TYPE_SEG,  SOURCE_REGS },
+	{ "fs",      REG_OFFSET(xfs),     0, FULL,       Register::TYPE_SEG,  SOURCE_REGS },
+	{ "gs",      REG_OFFSET(xgs),     0, FULL,       Register::TYPE_SEG,  SOURCE_REGS },
+	{ "ss",      REG_OFFSET(xss),     0, FULL,       Register::TYPE_SEG,  SOURCE_REGS },
+	{ "fs_base", 0,                   0, FULL,       Register::TYPE_SEG,  SOURCE_FS_BASE },
+	{ "gs_base", 0,                   0, FULL,       Register::TYPE_SEG,  SOURCE_GS_BASE },
+	{ "eflags",  REG_OFFSET(eflags),  0, FULL,       Register::TYPE_COND, SOURCE_REGS },
+#elif defined(EDB_X86_64)
+	{ "rax",     REG_OFFSET(rax),     0, FULL,       Register::TYPE_GPR,  SOURCE_REGS },
+	{ "rbx",     REG_OFFSET(rbx),     0, FULL,       Register::TYPE_GPR,  SOURCE_REGS },
+	{ "rcx",     REG_OFFSET(rcx),     0, FULL,       Register::TYPE_GPR,  SOURCE_REGS },
+	{ "rdx",     REG_OFFSET(rdx),     0, FULL,       Register::TYPE_GPR,  SOURCE_REGS },
+	{ "rbp",     REG_OFFSET(rbp),     0, FULL,       Register::TYPE_GPR,  SOURCE_REGS },
+	{ "rsp",     REG_OFFSET(rsp),     0, FULL,       Register::TYPE_GPR,  SOURCE_REGS },
+	{ "rsi",     REG_OFFSET(rsi),     0, FULL,       Register::TYPE_GPR,  SOURCE_REGS },
+	{ "rdi",     REG_OFFSET(rdi),     0, FULL,       Register::TYPE_GPR,  SOURCE_REGS },
+	{ "rip",     REG_OFFSET(rip),     0, FULL,       Register::TYPE_IP,   SOURCE_REGS },
+	{ "r8",      REG_OFFSET(r8),      0, FULL,       Register::TYPE_GPR,  SOURCE_REGS },
+	{ "r9",      REG_OFFSET(r9),      0, FULL,       Register::TYPE_GPR,  SOURCE_REGS },
+	{ "r10",     REG_OFFSET(r10),     0, FULL,       Register::TYPE_GPR,  SOURCE_REGS },
+	{ "r11",     REG_OFFSET(r11),     0, FULL,       Register::TYPE_GPR,  SOURCE_REGS },
+	{ "r12",     REG_OFFSET(r12),     0, FULL,       Register::TYPE_GPR,  SOURCE_REGS },
+	{ "r13",     REG_OFFSET(r13),     0, FULL,       Register::TYPE_GPR,  SOURCE_REGS },
+	{ "r14",     REG_OFFSET(r14),     0, FULL,       Register::TYPE_GPR,  SOURCE_REGS },
+	{ "r15",     REG_OFFSET(r15),     0, FULL,       Register::TYPE_GPR,  SOURCE_REGS },
+	{ "eax",     REG_OFFSET(rax),     0, 0xffffffff, Register::TYPE_GPR,  SOURCE_REGS },
+	{ "ebx",     REG_OFFSET(rbx),     0, 0xffffffff, Register::TYPE_GPR,  SOURCE_REGS },
+	{ "ecx",     REG_OFFSET(rcx),     0, 0xffffffff, Register::TYPE_GPR,  SOURCE_REGS },
+	{ "edx",     REG_OFFSET(rdx),     0, 0xffffffff, Register::TYPE_GPR,  SOURCE_REGS },
+	{ "ebp",     REG_OFFSET(rbp),     0, 0xffffffff, Register::TYPE_GPR,  SOURCE_REGS },
+	{ "esp",     REG_OFFSET(rsp),     0, 0xffffffff, Register::TYPE_GPR,  SOURCE_REGS },
+	{ "esi",     REG_OFFSET(rsi),     0, 0xffffffff, Register::TYPE_GPR,  SOURCE_REGS },
+	{ "edi",     REG_OFFSET(rdi),     0, 0xffffffff, Register::TYPE_GPR,  SOURCE_REGS },
+	{ "r8d",     REG_OFFSET(r8),      0, 0xffffffff, Register::TYPE_GPR,  SOURCE_REGS },
+	{ "r9d",     REG_OFFSET(r9),      0, 0xffffffff, Register::TYPE_GPR,  SOURCE_REGS },
+	{ "r10d",    REG_OFFSET(r10),     0, 0xffffffff, Register::TYPE_GPR,  SOURCE_REGS },
+	{ "r11d",    REG_OFFSET(r11),     0, 0xffffffff, Register::TYPE_GPR,  SOURCE_REGS },
+	{ "r12d",    REG_OFFSET(r12),     0, 0xffffffff, Register::TYPE_GPR,  SOURCE_REGS },
+	{ "r13d",    REG_OFFSET(r13),     0, 0xffffffff, Register::TYPE_GPR,  SOURCE_REGS },
+	{ "r14d",    REG_OFFSET(r14),     0, 0xffffffff, Register::TYPE_GPR,  SOURCE_REGS },
+	{ "r15d",    REG_OFFSET(r15),     0, 0xffffffff, Register::TYPE_GPR,  SOURCE_REGS },
+	{ "ax",      REG_OFFSET(rax),     0, 0xffff,     Register::TYPE_GPR,  SOURCE_REGS },
+	{ "bx",      REG_OFFSET(rbx),     0, 0xffff,     Register::TYPE_GPR,  SOURCE_REGS },
+	{ "cx",      REG_OFFSET(rcx),     0, 0xffff,     Register::TYPE_GPR,  SOURCE_REGS },
+	{ "dx",      REG_OFFSET(rdx),     0, 0xffff,     Register::TYPE_GPR,  SOURCE_REGS },
+	{ "bp",      REG_OFFSET(rbp),     0, 0xffff,     Register::TYPE_GPR,  SOURCE_REGS },
+	{ "sp",      REG_OFFSET(rsp),     0, 0xffff,     Register::TYPE_GPR,  SOURCE_REGS },
+	{ "si",      REG_OFFSET(rsi),     0, 0xffff,     Register::TYPE_GPR,  SOURCE_REGS },
+	{ "di",      REG_OFFSET(rdi),     0, 0xffff,     Register::TYPE_GPR,  SOURCE_REGS },
+	{ "r8w",     REG_OFFSET(r8),      0, 0xffff,     Register::TYPE_GPR,  SOURCE_REGS },
+	{ "r9w",     REG_OFFSET(r9),      0, 0xffff,     Register::TYPE_GPR,  SOURCE_REGS },
+	{ "r10w",    REG_OFFSET(r10),     0, 0xffff,     Register::TYPE_GPR,  SOURCE_REGS },
+	{ "r11w",    REG_OFFSET(r11),     0, 0xffff,     Register::TYPE_GPR,  SOURCE_REGS },
+	{ "r12w",    REG_OFFSET(r12),     0, 0xffff,     Register::TYPE_GPR,  SOURCE_REGS },
+	{ "r13w",    REG_OFFSET(r13),     0, 0xffff,     Register::TYPE_GPR,  SOURCE_REGS },
+	{ "r14w",    REG_OFFSET(r14),     0, 0xffff,     Register::TYPE_GPR,  SOURCE_REGS },
+	{ "r15w",    REG_OFFSET(r15),     0, 0xffff,     Register::TYPE_GPR,  SOURCE_REGS },
+	{ "al",      REG_OFFSET(rax),     0, 0xff,       Register::TYPE_GPR,  SOURCE_REGS },
+	{ "bl",      REG_OFFSET(rbx),     0, 0xff,       Register::TYPE_GPR,  SOURCE_REGS },
+	{ "cl",      REG_OFFSET(rcx),     0, 0xff,       Register::TYPE_GPR,  SOURCE_REGS },
+	{ "dl",      REG_OFFSET(rdx),     0, 0xff,       Register::TYPE_GPR,  SOURCE_REGS },
+	{ "ah",      REG_OFFSET(rax),     8, 0xff,       Register::TYPE_GPR,  SOURCE_REGS },
+	{ "bh",      REG_OFFSET(rbx),     8, 0xff,       Register::TYPE_GPR,  SOURCE_REGS },
+	{ "ch",      REG_OFFSET(rcx),     8, 0xff,       Register::TYPE_GPR,  SOURCE_REGS },
+	{ "dh",      REG_OFFSET(rdx),     8, 0xff,       Register::TYPE_GPR,  SOURCE_REGS },
+	{ "spl",     REG_OFFSET(rsp),     0, 0xff,       Register::TYPE_GPR,  SOURCE_REGS },
+	{ "bpl",     REG_OFFSET(rbp),     0, 0xff,       Register::TYPE_GPR,  SOURCE_REGS },
+	{ "sil",     REG_OFFSET(rsi),     0, 0xff,       Register::TYPE_GPR,  SOURCE_REGS },
+	{ "dil",     REG_OFFSET(rdi),     0, 0xff,       Register::TYPE_GPR,  SOURCE_REGS },
+	{ "r8b",     REG_OFFSET(r8),      0, 0xff,       Register::TYPE_GPR,  SOURCE_REGS },
+	{ "r9b",     REG_OFFSET(r9),      0, 0xff,       Register::TYPE_GPR,  SOURCE_REGS },
+	{ "r10b",    REG_OFFSET(r10),     0, 0xff,       Register::TYPE_GPR,  SOURCE_REGS },
+	{ "r11b",    REG_OFFSET(r11),     0, 0xff,       Register::TYPE_GPR,  SOURCE_REGS },
+	{ "r12b",    REG_OFFSET(r12),     0, 0xff,       Register::TYPE_GPR,  SOURCE_REGS },
+	{ "r13b",    REG_OFFSET(r13),     0, 0xff,       Register::TYPE_GPR,  SOURCE_REGS },
+	{ "r14b",    REG_OFFSET(r14),     0, 0xff,       Register::TYPE_GPR,  SOURCE_REGS },
+	{ "r15b",    REG_OFFSET(r15),     0, 0xff,       Register::TYPE_GPR,  SOURCE_REGS },
+	{ "cs",      REG_OFFSET(cs),      0, FULL,       Register::TYPE_SEG,  SOURCE_REGS },
+	{ "ds",      REG_OFFSET(ds),      0, FULL,       Register::TYPE_SEG,  SOURCE_REGS },
+	{ "es",      REG_OFFSET(es),      0, FULL,       Register::TYPE_SEG,  SOURCE_REGS },
+	{ "fs",      REG_OFFSET(fs),      0, FULL,       Register::TYPE_SEG,  SOURCE_REGS },
+	{ "gs",      REG_OFFSET(gs),      0, FULL,       Register::TYPE_SEG,  SOURCE_REGS },
+	{ "ss",      REG_OFFSET(ss),      0, FULL,       Register::TYPE_SEG,  SOURCE_REGS },
+	{ "fs_base", REG_OFFSET(fs_base), 0, FULL,       Register::TYPE_SEG,  SOURCE_REGS },
+	{ "gs_base", REG_OFFSET(gs_base), 0, FULL,       Register::TYPE_SEG,  SOURCE_REGS },
+	{ "rflags",  REG_OFFSET(eflags),  0, FULL,       Register::TYPE_COND, SOURCE_REGS },
+#endif
+};
+
+#undef REG_OFFSET
+
+const int register_count = sizeof(registers) / sizeof(registers[0]);
+
+//------------------------------------------------------------------------------
+// Name: make_register_index
+// Desc: maps each register name to its slot in the table above
+//------------------------------------------------------------------------------
+QHash<QString, int> make_register_index() {
+	QHash<QString, int> index;
+	for(int i = 0; i < register_count; ++i) {
+		index.insert(QLatin1String(registers[i].name), i);
+	}
+	return index;
+}
+
+//------------------------------------------------------------------------------
+// Name: register_index
+// Desc:
+//------------------------------------------------------------------------------
+const QHash<QString, int> &register_index() {
+	static const QHash<QString, int> index = make_register_index();
+	return index;
+}
+
+}
 
 //------------------------------------------------------------------------------
 // Name: PlatformState
 // Desc:
 //------------------------------------------------------------------------------
-PlatformState::PlatformState() {
+PlatformState::PlatformState() : core_(0), tid_(0), epoch_(0), fpregs_loaded_(true), dr_loaded_(true) {
 	memset(&regs_, 0, sizeof(regs_));
 	memset(&fpregs_, 0, sizeof(fpregs_));
 	memset(&dr_, 0, sizeof(dr_));
@@ -40,6 +213,28 @@ IState *PlatformState::clone() const {
 	return new PlatformState(*this);
 }
 
+//------------------------------------------------------------------------------
+// Name: load_fpu_registers
+// Desc:
+//------------------------------------------------------------------------------
+void PlatformState::load_fpu_registers() const {
+	if(!fpregs_loaded_) {
+		core_->load_fpu_registers(this);
+		fpregs_loaded_ = true;
+	}
+}
+
+//------------------------------------------------------------------------------
+// Name: load_debug_registers
+// Desc:
+//------------------------------------------------------------------------------
+void PlatformState::load_debug_registers() const {
+	if(!dr_loaded_) {
+		core_->load_debug_registers(this);
+		dr_loaded_ = true;
+	}
+}
+
 //------------------------------------------------------------------------------
 // Name: flags_to_string
 // Desc: returns the flags in a string form appropriate for this platform
@@ -70,130 +265,60 @@ QString PlatformState::flags_to_string() const {
 }
 
 //------------------------------------------------------------------------------
-// Name: value
-// Desc: returns a Register object which represents the register with the name
-//       supplied
+// Name: register_id
+// Desc: returns the id of the register named <reg>, or -1 if there is no such
+//       register. Names are case insensitive
 //------------------------------------------------------------------------------
-Register PlatformState::value(const QString &reg) const {
-	const QString lreg = reg.toLower();
+int PlatformState::register_id(const QString &reg) const {
+	const QHash<QString, int> &index = register_index();
+
+	QHash<QString, int>::const_iterator it = index.constFind(reg);
+	if(it == index.constEnd()) {
+		it = index.constFind(reg.toLower());
+		if(it == index.constEnd()) {
+			return -1;
+		}
+	}
+
+	return *it;
+}
 
+//------------------------------------------------------------------------------
+// Name: raw_value
+// Desc: returns the whole register which holds register <id>
+//------------------------------------------------------------------------------
+edb::reg_t PlatformState::raw_value(int id) const {
+	const register_info &info = registers[id];
+
+	switch(info.source) {
 #if defined(EDB_X86)
-	if(lreg == "eax")          return Register("eax", regs_.eax, Register::TYPE_GPR);
-	else if(lreg == "ebx")     return Register("ebx", regs_.ebx, Register::TYPE_GPR);
-	else if(lreg == "ecx")     return Register("ecx", regs_.ecx, Register::TYPE_GPR);
-	else if(lreg == "edx")     return Register("edx", regs_.edx, Register::TYPE_GPR);
-	else if(lreg == "ebp")     return Register("ebp", regs_.ebp, Register::TYPE_GPR);
-	else if(lreg == "esp")     return Register("esp", regs_.esp, Register::TYPE_GPR);
-	else if(lreg == "esi")     return Register("esi", regs_.esi, Register::TYPE_GPR);
-	else if(lreg == "edi")     return Register("edi", regs_.edi, Register::TYPE_GPR);
-	else if(lreg == "eip")     return Register("eip", regs_.eip, Register::TYPE_IP);
-	else if(lreg == "ax")      return Register("ax", regs_.eax & 0xffff, Register::TYPE_GPR);
-	else if(lreg == "bx")      return Register("bx", regs_.ebx & 0xffff, Register::TYPE_GPR);
-	else if(lreg == "cx")      return Register("cx", regs_.ecx & 0xffff, Register::TYPE_GPR);
-	else if(lreg == "dx")      return Register("dx", regs_.edx & 0xffff, Register::TYPE_GPR);
-	else if(lreg == "bp")      return Register("bp", regs_.ebp & 0xffff, Register::TYPE_GPR);
-	else if(lreg == "sp")      return Register("sp", regs_.esp & 0xffff, Register::TYPE_GPR);
-	else if(lreg == "si")      return Register("si", regs_.esi & 0xffff, Register::TYPE_GPR);
-	else if(lreg == "di")      return Register("di", regs_.edi & 0xffff, Register::TYPE_GPR);
-	else if(lreg == "al")      return Register("al", regs_.eax & 0xff, Register::TYPE_GPR);
-	else if(lreg == "bl")      return Register("bl", regs_.ebx & 0xff, Register::TYPE_GPR);
-	else if(lreg == "cl")      return Register("cl", regs_.ecx & 0xff, Register::TYPE_GPR);
-	else if(lreg == "dl")      return Register("dl", regs_.edx & 0xff, Register::TYPE_GPR);
-	else if(lreg == "ah")      return Register("ah", (regs_.eax >> 8) & 0xff, Register::TYPE_GPR);
-	else if(lreg == "bh")      return Register("bh", (regs_.ebx >> 8) & 0xff, Register::TYPE_GPR);
-	else if(lreg == "ch")      return Register("ch", (regs_.ecx >> 8) & 0xff, Register::TYPE_GPR);
-	else if(lreg == "dh")      return Register("dh", (regs_.edx >> 8) & 0xff, Register::TYPE_GPR);
-	else if(lreg == "cs")      return Register("cs", regs_.xcs, Register::TYPE_SEG);
-	else if(lreg == "ds")      return Register("ds", regs_.xds, Register::TYPE_SEG);
-	else if(lreg == "es")      return Register("es", regs_.xes, Register::TYPE_SEG);
-	else if(lreg == "fs")      return Register("fs", regs_.xfs, Register::TYPE_SEG);
-	else if(lreg == "gs")      return Register("gs", regs_.xgs, Register::TYPE_SEG);
-	else if(lreg == "ss")      return Register("ss", regs_.xss, Register::TYPE_SEG);
-	else if(lreg == "fs_base") return Register("fs_base", fs_base, Register::TYPE_SEG);
-	else if(lreg == "gs_base") return Register("gs_base", gs_base, Register::TYPE_SEG);
-	else if(lreg == "eflags")  return Register("eflags", regs_.eflags, Register::TYPE_COND);
-#elif defined(EDB_X86_64)
-	if(lreg == "rax")          return Register("rax", regs_.rax, Register::TYPE_GPR);
-	else if(lreg == "rbx")     return Register("rbx", regs_.rbx, Register::TYPE_GPR);
-	else if(lreg == "rcx")     return Register("rcx", regs_.rcx, Register::TYPE_GPR);
-	else if(lreg == "rdx")     return Register("rdx", regs_.rdx, Register::TYPE_GPR);
-	else if(lreg == "rbp")     return Register("rbp", regs_.rbp, Register::TYPE_GPR);
-	else if(lreg == "rsp")     return Register("rsp", regs_.rsp, Register::TYPE_GPR);
-	else if(lreg == "rsi")     return Register("rsi", regs_.rsi, Register::TYPE_GPR);
-	else if(lreg == "rdi")     return Register("rdi", regs_.rdi, Register::TYPE_GPR);
-	else if(lreg == "rip")     return Register("rip", regs_.rip, Register::TYPE_IP);
-	else if(lreg == "r8")      return Register("r8", regs_.r8, Register::TYPE_GPR);
-	else if(lreg == "r9")      return Register("r9", regs_.r9, Register::TYPE_GPR);
-	else if(lreg == "r10")     return Register("r10", regs_.r10, Register::TYPE_GPR);
-	else if(lreg == "r11")     return Register("r11", regs_.r11, Register::TYPE_GPR);
-	else if(lreg == "r12")     return Register("r12", regs_.r12, Register::TYPE_GPR);
-	else if(lreg == "r13")     return Register("r13", regs_.r13, Register::TYPE_GPR);
-	else if(lreg == "r14")     return Register("r14", regs_.r14, Register::TYPE_GPR);
-	else if(lreg == "r15")     return Register("r15", regs_.r15, Register::TYPE_GPR);
-	else if(lreg == "eax")     return Register("eax", regs_.rax & 0xffffffff, Register::TYPE_GPR);
-	else if(lreg == "ebx")     return Register("ebx", regs_.rbx & 0xffffffff, Register::TYPE_GPR);
-	else if(lreg == "ecx")     return Register("ecx", regs_.rcx & 0xffffffff, Register::TYPE_GPR);
-	else if(lreg == "edx")     return Register("edx", regs_.rdx & 0xffffffff, Register::TYPE_GPR);
-	else if(lreg == "ebp")     return Register("ebp", regs_.rbp & 0xffffffff, Register::TYPE_GPR);
-	else if(lreg == "esp")     return Register("esp", regs_.rsp & 0xffffffff, Register::TYPE_GPR);
-	else if(lreg == "esi")     return Register("esi", regs_.rsi & 0xffffffff, Register::TYPE_GPR);
-	else if(lreg == "edi")     return Register("edi", regs_.rdi & 0xffffffff, Register::TYPE_GPR);
-	else if(lreg == "r8d")     return Register("r8d", regs_.r8 & 0xffffffff, Register::TYPE_GPR);
-	else if(lreg == "r9d")     return Register("r9d", regs_.r9 & 0xffffffff, Register::TYPE_GPR);
-	else if(lreg == "r10d")    return Register("r10d", regs_.r10 & 0xffffffff, Register::TYPE_GPR);
-	else if(lreg == "r11d")    return Register("r11d", regs_.r11 & 0xffffffff, Register::TYPE_GPR);
-	else if(lreg == "r12d")    return Register("r12d", regs_.r12 & 0xffffffff, Register::TYPE_GPR);
-	else if(lreg == "r13d")    return Register("r13d", regs_.r13 & 0xffffffff, Register::TYPE_GPR);
-	else if(lreg == "r14d")    return Register("r14d", regs_.r14 & 0xffffffff, Register::TYPE_GPR);
-	else if(lreg == "r15d")    return Register("r15d", regs_.r15 & 0xffffffff, Register::TYPE_GPR);
-	else if(lreg == "ax")      return Register("ax", regs_.rax & 0xffff, Register::TYPE_GPR);
-	else if(lreg == "bx")      return Register("bx", regs_.rbx & 0xffff, Register::TYPE_GPR);
-	else if(lreg == "cx")      return Register("cx", regs_.rcx & 0xffff, Register::TYPE_GPR);
-	else if(lreg == "dx")      return Register("dx", regs_.rdx & 0xffff, Register::TYPE_GPR);
-	else if(lreg == "bp")      return Register("bp", regs_.rbp & 0xffff, Register::TYPE_GPR);
-	else if(lreg == "sp")      return Register("sp", regs_.rsp & 0xffff, Register::TYPE_GPR);
-	else if(lreg == "si")      return Register("si", regs_.rsi & 0xffff, Register::TYPE_GPR);
-	else if(lreg == "di")      return Register("di", regs_.rdi & 0xffff, Register::TYPE_GPR);
-	else if(lreg == "r8w")     return Register("r8w", regs_.r8 & 0xffff, Register::TYPE_GPR);
-	else if(lreg == "r9w")     return Register("r9w", regs_.r9 & 0xffff, Register::TYPE_GPR);
-	else if(lreg == "r10w")    return Register("r10w", regs_.r10 & 0xffff, Register::TYPE_GPR);
-	else if(lreg == "r11w")    return Register("r11w", regs_.r11 & 0xffff, Register::TYPE_GPR);
-	else if(lreg == "r12w")    return Register("r12w", regs_.r12 & 0xffff, Register::TYPE_GPR);
-	else if(lreg == "r13w")    return Register("r13w", regs_.r13 & 0xffff, Register::TYPE_GPR);
-	else if(lreg == "r14w")    return Register("r14w", regs_.r14 & 0xffff, Register::TYPE_GPR);
-	else if(lreg == "r15w")    return Register("r15w", regs_.r15 & 0xffff, Register::TYPE_GPR);
-	else if(lreg == "al")      return Register("al", regs_.rax & 0xff, Register::TYPE_GPR);
-	else if(lreg == "bl")      return Register("bl", regs_.rbx & 0xff, Register::TYPE_GPR);
-	else if(lreg == "cl")      return Register("cl", regs_.rcx & 0xff, Register::TYPE_GPR);
-	else if(lreg == "dl")      return Register("dl", regs_.rdx & 0xff, Register::TYPE_GPR);
-	else if(lreg == "ah")      return Register("ah", (regs_.rax >> 8) & 0xff, Register::TYPE_GPR);
-	else if(lreg == "bh")      return Register("bh", (regs_.rbx >> 8) & 0xff, Register::TYPE_GPR);
-	else if(lreg == "ch")      return Register("ch", (regs_.rcx >> 8) & 0xff, Register::TYPE_GPR);
-	else if(lreg == "dh")      return Register("dh", (regs_.rdx >> 8) & 0xff, Register::TYPE_GPR);
-	else if(lreg == "spl")     return Register("spl", (regs_.rsp >> 8) & 0xff, Register::TYPE_GPR);
-	else if(lreg == "bpl")     return Register("bpl", (regs_.rbp >> 8) & 0xff, Register::TYPE_GPR);
-	else if(lreg == "sil")     return Register("sil", (regs_.rsi >> 8) & 0xff, Register::TYPE_GPR);
-	else if(lreg == "dil")     return Register("dil", (regs_.rdi >> 8) & 0xff, Register::TYPE_GPR);
-	else if(lreg == "r8b")     return Register("r8b", regs_.r8 & 0xff, Register::TYPE_GPR);
-	else if(lreg == "r9b")     return Register("r9b", regs_.r9 & 0xff, Register::TYPE_GPR);
-	else if(lreg == "r10b")    return Register("r10b", regs_.r10 & 0xff, Register::TYPE_GPR);
-	else if(lreg == "r11b")    return Register("r11b", regs_.r11 & 0xff, Register::TYPE_GPR);
-	else if(lreg == "r12b")    return Register("r12b", regs_.r12 & 0xff, Register::TYPE_GPR);
-	else if(lreg == "r13b")    return Register("r13b", regs_.r13 & 0xff, Register::TYPE_GPR);
-	else if(lreg == "r14b")    return Register("r14b", regs_.r14 & 0xff, Register::TYPE_GPR);
-	else if(lreg == "r15b")    return Register("r15b", regs_.r15 & 0xff, Register::TYPE_GPR);
-	else if(lreg == "cs")      return Register("cs", regs_.cs, Register::TYPE_SEG);
-	else if(lreg == "ds")      return Register("ds", regs_.ds, Register::TYPE_SEG);
-	else if(lreg == "es")      return Register("es", regs_.es, Register::TYPE_SEG);
-	else if(lreg == "fs")      return Register("fs", regs_.fs, Register::TYPE_SEG);
-	else if(lreg == "gs")      return Register("gs", regs_.gs, Register::TYPE_SEG);
-	else if(lreg == "ss")      return Register("ss", regs_.ss, Register::TYPE_SEG);
-	else if(lreg == "fs_base") return Register("fs_base", regs_.fs_base, Register::TYPE_SEG);
-	else if(lreg == "gs_base") return Register("gs_base", regs_.gs_base, Register::TYPE_SEG);
-	else if(lreg == "rflags")  return Register("rflags", regs_.eflags, Register::TYPE_COND);
+	case SOURCE_FS_BASE: return fs_base;
+	case SOURCE_GS_BASE: return gs_base;
 #endif
+	default:
+		return *reinterpret_cast<const edb::reg_t *>(reinterpret_cast<const char *>(&regs_) + info.offset);
+	}
+}
+
+//------------------------------------------------------------------------------
+// Name: value
+// Desc: returns the register with the given id (see register_id)
+//------------------------------------------------------------------------------
+Register PlatformState::value(int id) const {
+	if(id < 0 || id >= register_count) {
+		return Register();
+	}
+
+	const register_info &info = registers[id];
+	return Register(QLatin1String(info.name), (raw_value(id) >> info.shift) & info.mask, info.type);
+}
 
-	return Register();
+//------------------------------------------------------------------------------
+// Name: value
+// Desc:
+//------------------------------------------------------------------------------
+Register PlatformState::value(const QString &reg) const {
+	return value(register_id(reg));
 }
 
 //------------------------------------------------------------------------------
@@ -237,6 +362,7 @@ edb::address_t PlatformState::stack_pointer() const {
 // Desc:
 //------------------------------------------------------------------------------
 edb::reg_t PlatformState::debug_register(int n) const {
+	load_debug_registers();
 	return dr_[n];
 }
 
@@ -258,6 +384,8 @@ edb::reg_t PlatformState::flags() const {
 //------------------------------------------------------------------------------
 long double PlatformState::fpu_register(int n) const {
 
+	load_fpu_registers();
+
 	if(sizeof(long double) == 16) {
 		// st_space is an array of 128 bytes, 16 bytes for each of 8 FPU registers
 		const long double *const p = reinterpret_cast<const long double *>(fpregs_.st_space);
@@ -290,6 +418,11 @@ void PlatformState::clear() {
 	fs_base = 0;
 	gs_base = 0;
 #endif
+	core_          = 0;
+	tid_           = 0;
+	epoch_         = 0;
+	fpregs_loaded_ = true;
+	dr_loaded_     = true;
 }
 
 //------------------------------------------------------------------------------
@@ -297,6 +430,8 @@ void PlatformState::clear() {
 // Desc:
 //------------------------------------------------------------------------------
 void PlatformState::set_debug_register(int n, edb::reg_t value) {
+	// the others need to hold their real values when this is written back
+	load_debug_registers();
 	dr_[n] = value;
 }
 
@@ -328,54 +463,30 @@ void PlatformState::set_instruction_pointer(edb::address_t value) {
 
 //------------------------------------------------------------------------------
 // Name: set_register
-// Desc:
+// Desc: only whole registers may be set, not parts of them
 //------------------------------------------------------------------------------
 void PlatformState::set_register(const QString &name, edb::reg_t value) {
 
-	const QString lreg = name.toLower();
-#if defined(EDB_X86)
-	if(lreg == "eax") { regs_.eax = value; }
-	else if(lreg == "ebx") { regs_.ebx = value; }
-	else if(lreg == "ecx") { regs_.ecx = value; }
-	else if(lreg == "edx") { regs_.edx = value; }
-	else if(lreg == "ebp") { regs_.ebp = value; }
-	else if(lreg == "esp") { regs_.esp = value; }
-	else if(lreg == "esi") { regs_.esi = value; }
-	else if(lreg == "edi") { regs_.edi = value; }
-	else if(lreg == "eip") { regs_.eip = value; regs_.orig_eax = -1; }
-	else if(lreg == "cs") { regs_.xcs = value; }
-	else if(lreg == "ds") { regs_.xds = value; }
-	else if(lreg == "es") { regs_.xes = value; }
-	else if(lreg == "fs") { regs_.xfs = value; }
-	else if(lreg == "gs") { regs_.xgs = value; }
-	else if(lreg == "ss") { regs_.xss = value; }
-	else if(lreg == "eflags") { regs_.eflags = value; }
-#elif defined(EDB_X86_64)
-	if(lreg == "rax") { regs_.rax = value; }
-	else if(lreg == "rbx") { regs_.rbx = value; }
-	else if(lreg == "rcx") { regs_.rcx = value; }
-	else if(lreg == "rdx") { regs_.rdx = value; }
-	else if(lreg == "rbp") { regs_.rbp = value; }
-	else if(lreg == "rsp") { regs_.rsp = value; }
-	else if(lreg == "rsi") { regs_.rsi = value; }
-	else if(lreg == "rdi") { regs_.rdi = value; }
-	else if(lreg == "r8") { regs_.r8 = value; }
-	else if(lreg == "r9") { regs_.r9 = value; }
-	else if(lreg == "r10") { regs_.r10 = value; }
-	else if(lreg == "r11") { regs_.r11 = value; }
-	else if(lreg == "r12") { regs_.r12 = value; }
-	else if(lreg == "r13") { regs_.r13 = value; }
-	else if(lreg == "r14") { regs_.r14 = value; }
-	else if(lreg == "r15") { regs_.r15 = value; }
-	else if(lreg == "rip") { regs_.rip = value; regs_.orig_rax = -1; }
-	else if(lreg == "cs") { regs_.cs = value; }
-	else if(lreg == "ds") { regs_.ds = value; }
-	else if(lreg == "es") { regs_.es = value; }
-	else if(lreg == "fs") { regs_.fs = value; }
-	else if(lreg == "gs") { regs_.gs = value; }
-	else if(lreg == "ss") { regs_.ss = value; }
-	else if(lreg == "rflags") { regs_.eflags = value; }
-#endif
+	const int id = register_id(name);
+	if(id == -1) {
+		return;
+	}
+
+	const register_info &info = registers[id];
+	if(info.source != SOURCE_REGS || info.shift != 0 || info.mask != FULL) {
+		return;
+	}
+
+	*reinterpret_cast<edb::reg_t *>(reinterpret_cast<char *>(&regs_) + info.offset) = value;
+
+	// don't let the kernel restart an interrupted system call at the old address
+	if(info.type == Register::TYPE_IP) {
+	#if defined(EDB_X86)
+		regs_.orig_eax = -1;
+	#elif defined(EDB_X86_64)
+		regs_.orig_rax = -1;
+	#endif
+	}
 }
 
 //------------------------------------------------------------------------------
@@ -392,6 +503,14 @@ quint64 PlatformState::mmx_register(int n) const {
 // Desc:
 //------------------------------------------------------------------------------
 QByteArray PlatformState::xmm_register(int n) const {
+#if defined(EDB_X86_64)
+	// xmm_space holds the 16 XMM registers, 16 bytes each
+	if(n >= 0 && n < 16) {
+		load_fpu_registers();
+		return QByteArray(reinterpret_cast<const char *>(&fpregs_.xmm_space[n * 4]), 16);
+	}
+#else
 	Q_UNUSED(n);
+#endif
 	return QByteArray();
 }
@@ -23,6 +23,8 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #include "Types.h"
 #include <sys/user.h>
 
+class DebuggerCore;
+
 class PlatformState : public IState {
 	friend class DebuggerCore;
 
@@ -36,6 +38,8 @@ public:
 	virtual QString flags_to_string() const;
 	virtual QString flags_to_string(edb::reg_t flags) const;
 	virtual Register value(const QString &reg) const;
+	virtual Register value(int id) const;
+	virtual int register_id(const QString &reg) const;
 	virtual edb::address_t frame_pointer() const;
 	virtual edb::address_t instruction_pointer() const;
 	virtual edb::address_t stack_pointer() const;
@@ -52,13 +56,26 @@ public:
 	virtual QByteArray xmm_register(int n) const;
 
 private:
-	struct user_regs_struct   regs_;
-	struct user_fpregs_struct fpregs_;
-	edb::reg_t                dr_[8];
+	edb::reg_t raw_value(int id) const;
+	void load_fpu_registers() const;
+	void load_debug_registers() const;
+
+private:
+	struct user_regs_struct           regs_;
+	mutable struct user_fpregs_struct fpregs_;
+	mutable edb::reg_t                dr_[8];
 #if defined(EDB_X86)
-	edb::address_t            fs_base;
-	edb::address_t            gs_base;
+	edb::address_t                    fs_base;
+	edb::address_t                    gs_base;
 #endif
+
+	// the FPU and debug registers are only read from the thread when they are
+	// first asked for, these say where from and whether it has happened yet
+	DebuggerCore                      *core_;
+	edb::tid_t                        tid_;
+	quint64                           epoch_;
+	mutable bool                      fpregs_loaded_;
+	mutable bool                      dr_loaded_;
 };
 
 #endif
@@ -0,0 +1,103 @@
+/*
+Copyright (C) 2006 - 2013 Evan Teran
+                          eteran@alum.rit.edu
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "PtraceThread.h"
+
+//------------------------------------------------------------------------------
+// Name: PtraceThread
+// Desc: constructor
+//------------------------------------------------------------------------------
+PtraceThread::PtraceThread() : quit_(false) {
+}
+
+//------------------------------------------------------------------------------
+// Name: ~PtraceThread
+// Desc: destructor
+//------------------------------------------------------------------------------
+PtraceThread::~PtraceThread() {
+	stop();
+}
+
+//------------------------------------------------------------------------------
+// Name: stop
+// Desc: finishes whatever is queued and then ends the thread
+//------------------------------------------------------------------------------
+void PtraceThread::stop() {
+	{
+		QMutexLocker locker(&mutex_);
+		quit_ = true;
+		request_ready_.wakeAll();
+	}
+
+	wait();
+}
+
+//------------------------------------------------------------------------------
+// Name: execute
+// Desc: runs <function> on the ptrace thread and blocks until it is done.
+//       when called from the ptrace thread itself (or before the thread has
+//       been started), the function is simply called directly
+//------------------------------------------------------------------------------
+void PtraceThread::execute(function_t function, void *context) {
+
+	Q_ASSERT(function);
+
+	if(QThread::currentThread() == this || !isRunning()) {
+		function(context);
+		return;
+	}
+
+	request r = { function, context, false };
+
+	QMutexLocker locker(&mutex_);
+	requests_.enqueue(&r);
+	request_ready_.wakeOne();
+
+	while(!r.done) {
+		request_done_.wait(&mutex_);
+	}
+}
+
+//------------------------------------------------------------------------------
+// Name: run
+// Desc: services requests in the order they were made
+//------------------------------------------------------------------------------
+void PtraceThread::run() {
+
+	QMutexLocker locker(&mutex_);
+
+	Q_FOREVER {
+		if(requests_.isEmpty()) {
+			if(quit_) {
+				break;
+			}
+
+			request_ready_.wait(&mutex_);
+			continue;
+		}
+
+		request *const r = requests_.dequeue();
+
+		locker.unlock();
+		r->function(r->context);
+		locker.relock();
+
+		r->done = true;
+		request_done_.wakeAll();
+	}
+}
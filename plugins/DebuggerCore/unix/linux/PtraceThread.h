@@ -0,0 +1,60 @@
+/*
+Copyright (C) 2006 - 2013 Evan Teran
+                          eteran@alum.rit.edu
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef PTRACE_THREAD_20131015_H_
+#define PTRACE_THREAD_20131015_H_
+
+#include <QMutex>
+#include <QQueue>
+#include <QThread>
+#include <QWaitCondition>
+
+// linux only lets the thread which attached to a process trace it. So every
+// ptrace and waitpid call (and the fork in DebuggerCore::open) is made from
+// this one thread, and any other thread hands its work over and waits for it
+class PtraceThread : public QThread {
+public:
+	typedef void (*function_t)(void *context);
+
+public:
+	PtraceThread();
+	virtual ~PtraceThread();
+
+public:
+	void execute(function_t function, void *context);
+	void stop();
+
+protected:
+	virtual void run();
+
+private:
+	struct request {
+		function_t function;
+		void       *context;
+		bool       done;
+	};
+
+private:
+	QMutex            mutex_;
+	QWaitCondition    request_ready_;
+	QWaitCondition    request_done_;
+	QQueue<request *> requests_;
+	bool              quit_;
+};
+
+#endif
@@ -105,6 +105,8 @@ void DialogFunctions::do_find() {
 		ui->tableWidget->setRowCount(0);
 		ui->tableWidget->setSortingEnabled(false);
 
+		const bool coverage = edb::v1::coverage_enabled();
+
 		Q_FOREACH(const QModelIndex &selected_item, sel) {
 
 			const QModelIndex index = filter_model_->mapToSource(selected_item);
@@ -150,6 +152,20 @@ void DialogFunctions::do_find() {
 						ui->tableWidget->setItem(row, 4, new QTableWidgetItem(tr("Standard Function")));
 						break;
 					}
+
+					// how many of its blocks have been executed
+					if(coverage && !info.empty()) {
+						int covered = 0;
+						for(Function::const_iterator it = info.begin(); it != info.end(); ++it) {
+							if(!it->empty() && edb::v1::is_covered(it->first_address())) {
+								++covered;
+							}
+						}
+
+						QTableWidgetItem *const coverage_item = new QTableWidgetItem;
+						coverage_item->setData(Qt::DisplayRole, covered * 100 / static_cast<int>(info.size()));
+						ui->tableWidget->setItem(row, 5, coverage_item);
+					}
 				}
 			}
 		}
@@ -172,3 +188,19 @@ void DialogFunctions::on_btnFind_clicked() {
 	ui->progressBar->setValue(100);
 	ui->btnFind->setEnabled(true);
 }
+
+//------------------------------------------------------------------------------
+// Name: on_btnBreakAll_clicked
+// Desc: puts a breakpoint on the entry point of every function found
+//------------------------------------------------------------------------------
+void DialogFunctions::on_btnBreakAll_clicked() {
+
+	QList<edb::address_t> addresses;
+	for(int row = 0; row < ui->tableWidget->rowCount(); ++row) {
+		if(QTableWidgetItem *const item = ui->tableWidget->item(row, 0)) {
+			addresses.push_back(item->data(Qt::UserRole).toULongLong());
+		}
+	}
+
+	edb::v1::create_breakpoints(addresses);
+}
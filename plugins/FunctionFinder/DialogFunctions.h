@@ -36,6 +36,7 @@ public:
 
 public Q_SLOTS:
 	void on_btnFind_clicked();
+	void on_btnBreakAll_clicked();
 	void on_tableWidget_cellDoubleClicked (int row, int column);
 
 private:
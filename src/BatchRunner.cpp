@@ -0,0 +1,753 @@
+/*
+Copyright (C) 2006 - 2013 Evan Teran
+                          eteran@alum.rit.edu
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "BatchRunner.h"
+#include "Configuration.h"
+#include "Expression.h"
+#include "IDebuggerCore.h"
+#include "ISymbolManager.h"
+#include "MemoryRegions.h"
+#include "State.h"
+#include "Symbol.h"
+#include "edb.h"
+#include "version.h"
+
+#include <QCoreApplication>
+#include <QDateTime>
+#include <QDir>
+#include <QRegExp>
+#include <QSocketNotifier>
+#include <QTimer>
+#include <QtDebug>
+
+#include <cstdio>
+#include <iostream>
+
+namespace {
+
+// the same limits the trace recorder uses, a typo shouldn't fill the disk
+const quint32 max_memory_size     = 4096;
+const quint32 max_backtrace_depth = 64;
+
+//------------------------------------------------------------------------------
+// Name: default_registers
+// Desc: what "dump registers" shows when it isn't told
+//------------------------------------------------------------------------------
+QStringList default_registers() {
+	if(edb::v1::pointer_size() == 8) {
+		return QString("rax,rbx,rcx,rdx,rsi,rdi,rbp,rsp,r8,r9,r10,r11,r12,r13,r14,r15,rip,rflags").split(',');
+	} else {
+		return QString("eax,ebx,ecx,edx,esi,edi,ebp,esp,eip,eflags").split(',');
+	}
+}
+
+}
+
+//------------------------------------------------------------------------------
+// Name: BatchRunner
+// Desc:
+//------------------------------------------------------------------------------
+BatchRunner::BatchRunner(QObject *parent) : QObject(parent),
+		timeout_(0),
+		timer_(new QTimer(this)),
+		timeout_timer_(new QTimer(this)),
+		event_notifier_(0),
+		stops_(0),
+		finished_(false) {
+
+	connect(timer_, SIGNAL(timeout()), this, SLOT(next_debug_event()));
+
+	timeout_timer_->setSingleShot(true);
+	connect(timeout_timer_, SIGNAL(timeout()), this, SLOT(timed_out()));
+}
+
+//------------------------------------------------------------------------------
+// Name: ~BatchRunner
+// Desc:
+//------------------------------------------------------------------------------
+BatchRunner::~BatchRunner() {
+}
+
+//------------------------------------------------------------------------------
+// Name: script_error
+// Desc:
+//------------------------------------------------------------------------------
+void BatchRunner::script_error(int line_number, const QString &message) {
+	std::cerr << qPrintable(script_name_) << ":" << line_number << ": " << qPrintable(message) << std::endl;
+}
+
+//------------------------------------------------------------------------------
+// Name: load_script
+// Desc: reads the whole script up front so that mistakes are reported before
+//       the target is started
+//------------------------------------------------------------------------------
+bool BatchRunner::load_script(const QString &filename) {
+
+	QFile file(filename);
+	if(!file.open(QIODevice::ReadOnly | QIODevice::Text)) {
+		std::cerr << "could not open script " << qPrintable(filename) << std::endl;
+		return false;
+	}
+
+	script_name_ = filename;
+
+	bool ok = true;
+	QTextStream in(&file);
+	for(int line_number = 1; !in.atEnd(); ++line_number) {
+		QString line = in.readLine();
+
+		const int comment = line.indexOf('#');
+		if(comment != -1) {
+			line.truncate(comment);
+		}
+
+		line = line.trimmed();
+		if(!line.isEmpty() && !parse_line(line, line_number)) {
+			ok = false;
+		}
+	}
+
+	return ok;
+}
+
+//------------------------------------------------------------------------------
+// Name: parse_line
+// Desc:
+//------------------------------------------------------------------------------
+bool BatchRunner::parse_line(const QString &line, int line_number) {
+
+	const QStringList words = line.split(QRegExp("\\s+"), QString::SkipEmptyParts);
+	const QString command = words[0];
+
+	if(command == "break") {
+		if(words.size() < 2) {
+			script_error(line_number, tr("break needs an address"));
+			return false;
+		}
+
+		Placement placement;
+		placement.line       = line_number;
+		placement.expression = words[1];
+
+		if(words.size() > 2) {
+			if(words[2] != "if" || words.size() < 4) {
+				script_error(line_number, tr("expected \"if <condition>\" after the address"));
+				return false;
+			}
+
+			// the condition is the rest of the line, spaces and all
+			placement.condition = line.mid(line.indexOf(QRegExp("\\sif\\s")) + 3).trimmed();
+		}
+
+		placements_.push_back(placement);
+		return true;
+	} else if(command == "trace") {
+		if(words.size() < 2) {
+			script_error(line_number, tr("trace needs an address"));
+			return false;
+		}
+
+		Placement placement;
+		placement.line       = line_number;
+		placement.expression = words[1];
+		if(!parse_tracepoint(words, line_number, &placement.tracepoint)) {
+			return false;
+		}
+
+		placements_.push_back(placement);
+		return true;
+	} else if(command == "dump") {
+		return parse_dump(words, line_number);
+	} else if(command == "output" && words.size() == 2) {
+		if(output_name_.isEmpty()) {
+			output_name_ = words[1];
+		}
+		return true;
+	} else if(command == "tracefile" && words.size() == 2) {
+		trace_copy_name_ = words[1];
+		return true;
+	} else if(command == "timeout" && words.size() == 2) {
+		bool ok;
+		timeout_ = words[1].toInt(&ok);
+		if(!ok || timeout_ < 0) {
+			script_error(line_number, tr("timeout needs a number of seconds"));
+			return false;
+		}
+		return true;
+	}
+
+	script_error(line_number, tr("unknown command \"%1\"").arg(line));
+	return false;
+}
+
+//------------------------------------------------------------------------------
+// Name: parse_tracepoint
+// Desc: trace <expression> [registers <r1,r2,...>] [memory <expression> <size>] [backtrace <depth>]
+//------------------------------------------------------------------------------
+bool BatchRunner::parse_tracepoint(const QStringList &words, int line_number, Tracepoint::pointer *tracepoint) {
+
+	Q_ASSERT(tracepoint);
+
+	Tracepoint::pointer tp(new Tracepoint);
+
+	for(int i = 2; i < words.size(); ++i) {
+		bool ok = true;
+		if(words[i] == "registers" && i + 1 < words.size()) {
+			tp->registers = words[++i].split(',', QString::SkipEmptyParts);
+		} else if(words[i] == "memory" && i + 2 < words.size()) {
+			tp->memory_expression = words[++i];
+			tp->memory_size       = words[++i].toUInt(&ok, 0);
+		} else if(words[i] == "backtrace" && i + 1 < words.size()) {
+			tp->backtrace_depth   = words[++i].toUInt(&ok, 0);
+		} else {
+			ok = false;
+		}
+
+		if(!ok) {
+			script_error(line_number, tr("bad tracepoint option \"%1\"").arg(words[i]));
+			return false;
+		}
+	}
+
+	*tracepoint = tp;
+	return true;
+}
+
+//------------------------------------------------------------------------------
+// Name: parse_dump
+// Desc:
+//------------------------------------------------------------------------------
+bool BatchRunner::parse_dump(const QStringList &words, int line_number) {
+
+	Dump dump;
+	dump.size = 0;
+
+	bool ok = true;
+	if(words.size() >= 2 && words[1] == "registers" && words.size() <= 3) {
+		dump.type = Dump::DUMP_REGISTERS;
+		if(words.size() == 3) {
+			dump.registers = words[2].split(',', QString::SkipEmptyParts);
+		}
+	} else if(words.size() == 4 && words[1] == "memory") {
+		dump.type       = Dump::DUMP_MEMORY;
+		dump.expression = words[2];
+		dump.size       = words[3].toUInt(&ok, 0);
+	} else if(words.size() == 3 && words[1] == "backtrace") {
+		dump.type = Dump::DUMP_BACKTRACE;
+		dump.size = words[2].toUInt(&ok, 0);
+	} else if(words.size() == 2 && words[1] == "regions") {
+		dump.type = Dump::DUMP_REGIONS;
+	} else {
+		ok = false;
+	}
+
+	if(!ok) {
+		script_error(line_number, tr("expected \"dump registers|memory|backtrace|regions\""));
+		return false;
+	}
+
+	dumps_.push_back(dump);
+	return true;
+}
+
+//------------------------------------------------------------------------------
+// Name: set_output
+// Desc: the command line wins over an "output" line in the script
+//------------------------------------------------------------------------------
+void BatchRunner::set_output(const QString &filename) {
+	output_name_ = filename;
+}
+
+//------------------------------------------------------------------------------
+// Name: run
+// Desc:
+//------------------------------------------------------------------------------
+bool BatchRunner::run(const QString &program, const QList<QByteArray> &args) {
+
+	Q_ASSERT(edb::v1::debugger_core);
+
+	if(!QFile(program).exists()) {
+		std::cerr << "the specified file (" << qPrintable(program) << ") does not exist" << std::endl;
+		return false;
+	}
+
+	if(!edb::v1::debugger_core->open(program, QDir::currentPath(), args)) {
+		std::cerr << "failed to start " << qPrintable(program) << std::endl;
+		return false;
+	}
+
+	return start();
+}
+
+//------------------------------------------------------------------------------
+// Name: attach
+// Desc:
+//------------------------------------------------------------------------------
+bool BatchRunner::attach(edb::pid_t pid) {
+
+	Q_ASSERT(edb::v1::debugger_core);
+
+	if(!edb::v1::debugger_core->attach(pid)) {
+		std::cerr << "failed to attach to " << pid << std::endl;
+		return false;
+	}
+
+	return start();
+}
+
+//------------------------------------------------------------------------------
+// Name: start
+// Desc: the target is stopped at this point, everything is put in place and it
+//       is let go
+//------------------------------------------------------------------------------
+bool BatchRunner::start() {
+
+	if(output_name_.isEmpty()) {
+		output_file_.open(stdout, QIODevice::WriteOnly | QIODevice::Text);
+	} else {
+		output_file_.setFileName(output_name_);
+		if(!output_file_.open(QIODevice::WriteOnly | QIODevice::Truncate | QIODevice::Text)) {
+			std::cerr << "could not open " << qPrintable(output_name_) << " for writing" << std::endl;
+			edb::v1::debugger_core->kill();
+			return false;
+		}
+	}
+
+	out_.setDevice(&output_file_);
+
+	const edb::pid_t pid = edb::v1::debugger_core->pid();
+	out_ << "edb " << edb::version << " batch run of " << edb::v1::debugger_core->process_exe(pid)
+	     << " (pid " << pid << ") at " << QDateTime::currentDateTime().toString(Qt::ISODate) << endl;
+
+	edb::v1::symbol_manager().set_symbol_path(edb::v1::config().symbol_path);
+	edb::v1::memory_regions().sync();
+
+	place_breakpoints();
+
+	// wake up only when the core has something for us if it can tell us that,
+	// otherwise poll it like the main window does
+	const int fd = edb::v1::debugger_core->event_fd();
+	if(fd != -1) {
+		event_notifier_ = new QSocketNotifier(fd, QSocketNotifier::Read, this);
+		connect(event_notifier_, SIGNAL(activated(int)), this, SLOT(next_debug_event()));
+	} else {
+		timer_->start(0);
+	}
+
+	if(timeout_ != 0) {
+		timeout_timer_->start(timeout_ * 1000);
+	}
+
+	resume(edb::DEBUG_CONTINUE);
+	return true;
+}
+
+//------------------------------------------------------------------------------
+// Name: resolve_address
+// Desc: a symbol name or an expression
+//------------------------------------------------------------------------------
+bool BatchRunner::resolve_address(const QString &expression, edb::address_t *address, QString *error) const {
+
+	Q_ASSERT(address);
+	Q_ASSERT(error);
+
+	if(const Symbol::pointer sym = edb::v1::symbol_manager().find(expression)) {
+		*address = sym->address;
+		return true;
+	}
+
+	Expression<edb::address_t> expr(expression, edb::v1::get_variable, edb::v1::get_value);
+	ExpressionError err;
+
+	bool ok;
+	*address = expr.evaluate_expression(&ok, &err);
+	if(!ok) {
+		*error = err.what();
+	}
+
+	return ok;
+}
+
+//------------------------------------------------------------------------------
+// Name: place_breakpoints
+// Desc: addresses are worked out against the stopped target, so anything in a
+//       library which isn't loaded yet can't be found. Those are reported and
+//       the run goes ahead without them
+//------------------------------------------------------------------------------
+void BatchRunner::place_breakpoints() {
+
+	Q_FOREACH(const Placement &placement, placements_) {
+
+		edb::address_t address;
+		QString error;
+		if(!resolve_address(placement.expression, &address, &error)) {
+			script_error(placement.line, tr("could not place \"%1\": %2").arg(placement.expression, error));
+			out_ << "warning: line " << placement.line << ": could not place " << placement.expression << ": " << error << endl;
+			continue;
+		}
+
+		IBreakpoint::pointer bp = edb::v1::debugger_core->find_breakpoint(address);
+		if(!bp) {
+			bp = edb::v1::debugger_core->add_breakpoint(address);
+		}
+
+		if(!bp) {
+			script_error(placement.line, tr("could not place \"%1\" at %2").arg(placement.expression, edb::v1::format_pointer(address)));
+			out_ << "warning: line " << placement.line << ": could not place " << placement.expression << " at " << edb::v1::format_pointer(address) << endl;
+			continue;
+		}
+
+		if(!placement.condition.isEmpty()) {
+			edb::v1::set_breakpoint_condition(address, placement.condition);
+		}
+
+		if(placement.tracepoint) {
+			edb::v1::set_breakpoint_tracepoint(address, placement.tracepoint);
+		}
+
+		out_ << (placement.tracepoint ? "tracepoint " : "breakpoint ") << placement.expression
+		     << " at " << edb::v1::format_pointer(address) << endl;
+	}
+}
+
+//------------------------------------------------------------------------------
+// Name: timed_out
+// Desc:
+//------------------------------------------------------------------------------
+void BatchRunner::timed_out() {
+	if(!finished_) {
+		out_ << "timed out after " << timeout_ << " seconds, killing the target" << endl;
+		edb::v1::debugger_core->kill();
+		finish(EXIT_TIMEOUT);
+	}
+}
+
+//------------------------------------------------------------------------------
+// Name: finish
+// Desc:
+//------------------------------------------------------------------------------
+void BatchRunner::finish(int exit_code) {
+
+	if(finished_) {
+		return;
+	}
+
+	finished_ = true;
+
+	timer_->stop();
+	timeout_timer_->stop();
+	if(event_notifier_) {
+		event_notifier_->setEnabled(false);
+	}
+
+	// everything the tracepoints recorded needs to be on disk before anyone
+	// goes looking for it
+	edb::v1::flush_trace();
+
+	const QString trace_file = edb::v1::trace_file_name();
+	if(!trace_file.isEmpty()) {
+		if(!trace_copy_name_.isEmpty()) {
+			QFile::remove(trace_copy_name_);
+			if(QFile::copy(trace_file, trace_copy_name_)) {
+				out_ << "trace file: " << trace_copy_name_ << endl;
+			} else {
+				out_ << "could not copy trace file " << trace_file << " to " << trace_copy_name_ << endl;
+			}
+		} else {
+			out_ << "trace file: " << trace_file << endl;
+		}
+	}
+
+	out_ << "stops: " << stops_ << endl;
+	out_.flush();
+	output_file_.close();
+
+	QCoreApplication::exit(exit_code);
+}
+
+//------------------------------------------------------------------------------
+// Name: resume
+// Desc:
+//------------------------------------------------------------------------------
+void BatchRunner::resume(edb::EVENT_STATUS status) {
+	edb::v1::debugger_core->resume(status);
+}
+
+//------------------------------------------------------------------------------
+// Name: next_debug_event
+// Desc:
+//------------------------------------------------------------------------------
+void BatchRunner::next_debug_event() {
+
+	if(finished_) {
+		return;
+	}
+
+	// when woken up by the notifier, the event is already there
+	const int msecs = event_notifier_ ? 1 : 10;
+
+	if(IDebugEvent::const_pointer e = edb::v1::debugger_core->wait_debug_event(msecs)) {
+		edb::v1::memory_regions().sync();
+		handle_event(e);
+	}
+}
+
+//------------------------------------------------------------------------------
+// Name: handle_event
+// Desc:
+//------------------------------------------------------------------------------
+void BatchRunner::handle_event(const IDebugEvent::const_pointer &event) {
+
+	switch(event->reason()) {
+	case IDebugEvent::EVENT_EXITED:
+		out_ << "exited with code " << event->code() << endl;
+		finish(EXIT_OK);
+		break;
+
+	case IDebugEvent::EVENT_TERMINATED:
+		out_ << "terminated by signal " << event->code() << endl;
+		finish(EXIT_OK);
+		break;
+
+	case IDebugEvent::EVENT_STOPPED:
+		handle_stop(event);
+		break;
+
+	default:
+		Q_ASSERT(false);
+		break;
+	}
+}
+
+//------------------------------------------------------------------------------
+// Name: handle_stop
+// Desc: decides what a stop is, does the dumps if it is one we care about and
+//       lets the target carry on
+//------------------------------------------------------------------------------
+void BatchRunner::handle_stop(const IDebugEvent::const_pointer &event) {
+
+	// a breakpoint taken out of the way for the last step goes back in now
+	const IBreakpoint::pointer reenable = reenable_breakpoint_;
+	reenable_breakpoint_.clear();
+	if(reenable) {
+		reenable->enable();
+	}
+
+	if(event->is_kill()) {
+		out_ << "killed" << endl;
+		finish(EXIT_OK);
+		return;
+	}
+
+	if(event->is_stop()) {
+		resume(edb::DEBUG_CONTINUE);
+		return;
+	}
+
+	State state;
+	edb::v1::debugger_core->get_state(&state);
+
+	if(event->is_trap()) {
+
+		// the step over one of our breakpoints is done
+		if(reenable && event->trap_reason() == IDebugEvent::TRAP_STEPPING) {
+			resume(edb::DEBUG_CONTINUE);
+			return;
+		}
+
+		const edb::address_t previous_ip = state.instruction_pointer() - edb::v1::debugger_core->breakpoint_size();
+
+		IBreakpoint::pointer bp = edb::v1::debugger_core->find_breakpoint(previous_ip);
+		if(bp && bp->enabled()) {
+			state.set_instruction_pointer(previous_ip);
+			edb::v1::debugger_core->set_state(state);
+
+			// the core normally deals with these, but not every core does
+			edb::BREAKPOINT_ACTION action = event->breakpoint_action();
+			QString error                 = event->breakpoint_error();
+			if(action == edb::BREAKPOINT_UNDECIDED) {
+				action = edb::v1::breakpoint_action(bp, state, &error);
+			}
+
+			edb::v1::complete_breakpoint_hit(bp, action, state);
+
+			QString reason = tr("breakpoint at %1").arg(edb::v1::format_pointer(previous_ip));
+			switch(action) {
+			case edb::BREAKPOINT_ERROR:
+				reason += tr(", condition \"%1\" failed to evaluate: %2").arg(bp->condition, error);
+				// FALL THROUGH!
+			case edb::BREAKPOINT_STOP:
+				report_stop(tr("%1, hit %2 (thread %3)").arg(reason).arg(bp->hit_count()).arg(event->thread()), state);
+				break;
+			default:
+				break;
+			}
+
+			if(bp->one_time()) {
+				edb::v1::debugger_core->remove_breakpoint(bp->address());
+				resume(edb::DEBUG_CONTINUE);
+			} else {
+				bp->disable();
+				reenable_breakpoint_ = bp;
+				edb::v1::debugger_core->step(edb::DEBUG_CONTINUE);
+			}
+			return;
+		}
+	}
+
+	if(event->is_error() || event->is_trap()) {
+		const IDebugEvent::Message message = event->error_description();
+		report_stop(tr("signal %1 %2 at %3 (thread %4)")
+			.arg(event->code())
+			.arg(event->is_error() ? message.caption : tr("trap"))
+			.arg(edb::v1::format_pointer(state.instruction_pointer()))
+			.arg(event->thread()), state);
+	} else {
+		out_ << "signal " << event->code() << " (thread " << event->thread() << ")" << endl;
+	}
+
+	// the target sees its signals just like it would without us around
+	resume(edb::DEBUG_EXCEPTION_NOT_HANDLED);
+}
+
+//------------------------------------------------------------------------------
+// Name: report_stop
+// Desc: writes a stop and everything the script wants dumped for it
+//------------------------------------------------------------------------------
+void BatchRunner::report_stop(const QString &reason, const State &state) {
+
+	++stops_;
+	out_ << endl << "stop " << stops_ << ": " << reason << endl;
+
+	Q_FOREACH(const Dump &dump, dumps_) {
+		switch(dump.type) {
+		case Dump::DUMP_REGISTERS:
+			dump_registers(dump, state);
+			break;
+		case Dump::DUMP_MEMORY:
+			dump_memory(dump, state);
+			break;
+		case Dump::DUMP_BACKTRACE:
+			dump_backtrace(dump, state);
+			break;
+		case Dump::DUMP_REGIONS:
+			dump_regions();
+			break;
+		}
+	}
+
+	out_.flush();
+}
+
+//------------------------------------------------------------------------------
+// Name: dump_registers
+// Desc:
+//------------------------------------------------------------------------------
+void BatchRunner::dump_registers(const Dump &dump, const State &state) {
+
+	out_ << "registers:" << endl;
+
+	const QStringList names = dump.registers.isEmpty() ? default_registers() : dump.registers;
+	Q_FOREACH(const QString &name, names) {
+		if(const Register reg = state.value(name)) {
+			out_ << "  " << qSetFieldWidth(8) << left << name << qSetFieldWidth(0) << edb::v1::format_pointer(reg.value<edb::reg_t>()) << endl;
+		} else {
+			out_ << "  " << qSetFieldWidth(8) << left << name << qSetFieldWidth(0) << "<unknown>" << endl;
+		}
+	}
+}
+
+//------------------------------------------------------------------------------
+// Name: dump_memory
+// Desc: plain hex, 16 bytes to a line
+//------------------------------------------------------------------------------
+void BatchRunner::dump_memory(const Dump &dump, const State &state) {
+
+	CompiledExpression<edb::address_t> program;
+	ExpressionError err;
+
+	bool ok = edb::v1::compile_expression(dump.expression, state, &program, &err);
+
+	edb::address_t address = 0;
+	if(ok) {
+		address = edb::v1::evaluate_expression(program, state, &ok, &err);
+	}
+
+	if(!ok) {
+		out_ << "memory " << dump.expression << ": " << err.what() << endl;
+		return;
+	}
+
+	QByteArray bytes(qMin(dump.size, max_memory_size), 0);
+	if(!edb::v1::debugger_core->read_bytes(address, bytes.data(), bytes.size())) {
+		out_ << "memory " << dump.expression << " at " << edb::v1::format_pointer(address) << ": could not be read" << endl;
+		return;
+	}
+
+	out_ << "memory " << dump.expression << ":" << endl;
+	for(int i = 0; i < bytes.size(); i += 16) {
+		out_ << "  " << edb::v1::format_pointer(address + i) << " ";
+		for(int j = i; j < qMin(i + 16, bytes.size()); ++j) {
+			out_ << ' ' << QString("%1").arg(static_cast<quint8>(bytes[j]), 2, 16, QChar('0'));
+		}
+		out_ << endl;
+	}
+}
+
+//------------------------------------------------------------------------------
+// Name: dump_backtrace
+// Desc: follows the frame pointers, this is only as good as the code being
+//       debugged is at keeping them
+//------------------------------------------------------------------------------
+void BatchRunner::dump_backtrace(const Dump &dump, const State &state) {
+
+	out_ << "backtrace:" << endl;
+	out_ << "  " << edb::v1::format_pointer(state.instruction_pointer()) << " " << edb::v1::find_function_symbol(state.instruction_pointer()) << endl;
+
+	edb::address_t frame = state.frame_pointer();
+	for(quint32 i = 0; i < qMin(dump.size, max_backtrace_depth); ++i) {
+		edb::address_t frame_data[2];
+		if(!edb::v1::debugger_core->read_bytes(frame, frame_data, sizeof(frame_data)) || frame_data[1] == 0) {
+			break;
+		}
+
+		out_ << "  " << edb::v1::format_pointer(frame_data[1]) << " " << edb::v1::find_function_symbol(frame_data[1]) << endl;
+
+		if(frame_data[0] <= frame) {
+			break;
+		}
+		frame = frame_data[0];
+	}
+}
+
+//------------------------------------------------------------------------------
+// Name: dump_regions
+// Desc:
+//------------------------------------------------------------------------------
+void BatchRunner::dump_regions() {
+
+	out_ << "regions:" << endl;
+
+	Q_FOREACH(const IRegion::pointer &region, edb::v1::memory_regions().regions()) {
+		out_ << "  " << edb::v1::format_pointer(region->start()) << "-" << edb::v1::format_pointer(region->end()) << " "
+		     << (region->readable()   ? 'r' : '-')
+		     << (region->writable()   ? 'w' : '-')
+		     << (region->executable() ? 'x' : '-')
+		     << " " << region->name() << endl;
+	}
+}
@@ -0,0 +1,138 @@
+/*
+Copyright (C) 2006 - 2013 Evan Teran
+                          eteran@alum.rit.edu
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef BATCH_RUNNER_20131027_H_
+#define BATCH_RUNNER_20131027_H_
+
+#include "IBreakpoint.h"
+#include "IDebugEvent.h"
+#include "Tracepoint.h"
+#include "Types.h"
+
+#include <QByteArray>
+#include <QFile>
+#include <QList>
+#include <QObject>
+#include <QString>
+#include <QStringList>
+#include <QTextStream>
+
+class State;
+class QSocketNotifier;
+class QTimer;
+
+// drives the debugger core without any widgets. A script says where to put
+// breakpoints and tracepoints and what to dump each time the target stops,
+// the target is then run to completion and the results go to a file.
+//
+// script lines look like this, '#' starts a comment:
+//   break <expression> [if <condition>]
+//   trace <expression> [registers <r1,r2,...>] [memory <expression> <size>] [backtrace <depth>]
+//   dump registers [<r1,r2,...>]
+//   dump memory <expression> <size>
+//   dump backtrace <depth>
+//   dump regions
+//   output <file>
+//   tracefile <file>
+//   timeout <seconds>
+//
+// the dumps are done whenever the target stops, which is on a breakpoint
+// (whose condition holds) or on a signal. Signals are always passed on to the
+// target afterwards, batch mode never stops for good until the target is gone
+class BatchRunner : public QObject {
+	Q_OBJECT
+
+public:
+	enum {
+		EXIT_OK      = 0,
+		EXIT_ERROR   = 1,
+		EXIT_TIMEOUT = 2
+	};
+
+public:
+	BatchRunner(QObject *parent = 0);
+	virtual ~BatchRunner();
+
+public:
+	bool load_script(const QString &filename);
+	void set_output(const QString &filename);
+	bool run(const QString &program, const QList<QByteArray> &args);
+	bool attach(edb::pid_t pid);
+
+public Q_SLOTS:
+	void next_debug_event();
+	void timed_out();
+
+private:
+	struct Placement {
+		int                 line;
+		QString             expression;
+		QString             condition;
+		Tracepoint::pointer tracepoint;
+	};
+
+	struct Dump {
+		enum Type {
+			DUMP_REGISTERS,
+			DUMP_MEMORY,
+			DUMP_BACKTRACE,
+			DUMP_REGIONS
+		};
+
+		Type        type;
+		QStringList registers;
+		QString     expression;
+		quint32     size;
+	};
+
+private:
+	bool parse_line(const QString &line, int line_number);
+	bool parse_tracepoint(const QStringList &words, int line_number, Tracepoint::pointer *tracepoint);
+	bool parse_dump(const QStringList &words, int line_number);
+	bool start();
+	bool resolve_address(const QString &expression, edb::address_t *address, QString *error) const;
+	void place_breakpoints();
+	void finish(int exit_code);
+	void handle_event(const IDebugEvent::const_pointer &event);
+	void handle_stop(const IDebugEvent::const_pointer &event);
+	void report_stop(const QString &reason, const State &state);
+	void dump_registers(const Dump &dump, const State &state);
+	void dump_memory(const Dump &dump, const State &state);
+	void dump_backtrace(const Dump &dump, const State &state);
+	void dump_regions();
+	void resume(edb::EVENT_STATUS status);
+	void script_error(int line_number, const QString &message);
+
+private:
+	QList<Placement>     placements_;
+	QList<Dump>          dumps_;
+	QString              script_name_;
+	QString              output_name_;
+	QString              trace_copy_name_;
+	int                  timeout_;
+	QFile                output_file_;
+	QTextStream          out_;
+	QTimer              *timer_;
+	QTimer              *timeout_timer_;
+	QSocketNotifier     *event_notifier_;
+	IBreakpoint::pointer reenable_breakpoint_;
+	int                  stops_;
+	bool                 finished_;
+};
+
+#endif
@@ -19,9 +19,14 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #include "Configuration.h"
 #include <QtDebug>
 #include <QSettings>
+#include <QStringList>
 #include <QDir>
 #include <QFont>
 
+#ifdef Q_OS_UNIX
+#include <csignal>
+#endif
+
 #define STRINGIFY(x) #x
 #define TOSTRING(x) STRINGIFY(x)
 
@@ -86,9 +91,30 @@ void Configuration::read_settings() {
 	initial_breakpoint = static_cast<InitialBreakpoint>(settings.value("debugger.initial_breakpoint", MainSymbol).value<uint>());
 	warn_on_no_exec_bp = settings.value("debugger.BP_NX_warn.enabled", true).value<bool>();
 	find_main          = settings.value("debugger.find_main.enabled", true).value<bool>();
+	non_stop           = settings.value("debugger.non_stop.enabled", false).value<bool>();
 	min_string_length  = settings.value("debugger.string_min", 4).value<uint>();
 	tty_enabled        = settings.value("debugger.terminal.enabled", true).value<bool>();
 	tty_command        = settings.value("debugger.terminal.command", "/usr/bin/xterm").value<QString>();
+	syscall_stops      = settings.value("debugger.syscall_stops").value<QStringList>();
+	settings.endGroup();
+
+	// these used to be passed on unconditionally, so that is what they do
+	// until someone says otherwise
+	signal_policies.clear();
+#ifdef Q_OS_UNIX
+	signal_policies.insert(SIGCHLD, edb::SIGNAL_PASS);
+	signal_policies.insert(SIGPROF, edb::SIGNAL_PASS);
+#endif
+
+	settings.beginGroup("Signals");
+	Q_FOREACH(const QString &key, settings.childKeys()) {
+		bool ok;
+		const int signal = key.mid(key.lastIndexOf('.') + 1).toInt(&ok);
+		const uint policy = settings.value(key).value<uint>();
+		if(ok && policy <= edb::SIGNAL_LOG) {
+			signal_policies.insert(signal, static_cast<edb::SIGNAL_POLICY>(policy));
+		}
+	}
 	settings.endGroup();
 
 	settings.beginGroup("Disassembly");
@@ -144,8 +170,17 @@ void Configuration::write_settings() {
 	settings.setValue("debugger.string_min", min_string_length);
 	settings.setValue("debugger.initial_breakpoint", initial_breakpoint);
 	settings.setValue("debugger.find_main.enabled", find_main);
+	settings.setValue("debugger.non_stop.enabled", non_stop);
 	settings.setValue("debugger.terminal.enabled", tty_enabled);
 	settings.setValue("debugger.terminal.command", tty_command);
+	settings.setValue("debugger.syscall_stops", syscall_stops);
+	settings.endGroup();
+
+	settings.beginGroup("Signals");
+	settings.remove("");
+	for(QHash<int, edb::SIGNAL_POLICY>::const_iterator it = signal_policies.begin(); it != signal_policies.end(); ++it) {
+		settings.setValue(QString("signal.%1").arg(it.key()), static_cast<uint>(it.value()));
+	}
 	settings.endGroup();
 
 	settings.beginGroup("Disassembly");
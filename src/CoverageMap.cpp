@@ -0,0 +1,162 @@
+/*
+Copyright (C) 2006 - 2013 Evan Teran
+                          eteran@alum.rit.edu
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "CoverageMap.h"
+#include "BasicBlock.h"
+#include "Function.h"
+#include "IAnalyzer.h"
+#include "IDebuggerCore.h"
+#include "edb.h"
+
+//------------------------------------------------------------------------------
+// Name: CoverageMap
+// Desc:
+//------------------------------------------------------------------------------
+CoverageMap::CoverageMap() {
+}
+
+//------------------------------------------------------------------------------
+// Name: start
+// Desc: plants a coverage breakpoint at the start of every basic block in the
+//       region, analyzing it first if that hasn't been done. Blocks which are
+//       already watched or covered are left alone, and so are blocks which
+//       already have a breakpoint of some other kind, or where one couldn't
+//       be written, since nothing would ever record them.
+//       Returns the number of breakpoints planted
+//------------------------------------------------------------------------------
+int CoverageMap::start(const IRegion::pointer &region) {
+
+	IAnalyzer *const analyzer = edb::v1::analyzer();
+	if(!analyzer || !region || !edb::v1::debugger_core) {
+		return 0;
+	}
+
+	IAnalyzer::FunctionMap functions = analyzer->functions(region);
+	if(functions.isEmpty()) {
+		analyzer->analyze(region);
+		functions = analyzer->functions(region);
+	}
+
+	QMap<edb::address_t, edb::address_t> wanted;
+	Q_FOREACH(const Function &function, functions) {
+		for(Function::const_iterator it = function.begin(); it != function.end(); ++it) {
+			const BasicBlock &block = *it;
+			if(block.empty()) {
+				continue;
+			}
+
+			const edb::address_t address = block.first_address();
+			if(blocks_.contains(address)) {
+				continue;
+			}
+
+			wanted.insert(address, block.last_address());
+		}
+	}
+
+	const QList<IBreakpoint::pointer> planted = edb::v1::debugger_core->add_breakpoints(wanted.keys());
+	Q_FOREACH(const IBreakpoint::pointer &bp, planted) {
+		bp->set_internal(true);
+		bp->coverage = true;
+		blocks_.insert(bp->address(), wanted.value(bp->address()));
+	}
+
+	return planted.size();
+}
+
+//------------------------------------------------------------------------------
+// Name: stop
+// Desc: removes the coverage breakpoints which haven't been hit yet, what has
+//       been covered so far is kept
+//------------------------------------------------------------------------------
+void CoverageMap::stop() {
+
+	if(!edb::v1::debugger_core) {
+		return;
+	}
+
+	QList<edb::address_t> addresses;
+
+	const IDebuggerCore::BreakpointList breakpoints = edb::v1::debugger_core->backup_breakpoints();
+	Q_FOREACH(const IBreakpoint::pointer &bp, breakpoints) {
+		if(bp->coverage) {
+			addresses.push_back(bp->address());
+		}
+	}
+
+	edb::v1::debugger_core->remove_breakpoints(addresses);
+
+	// blocks which never got hit aren't being watched any more
+	QMap<edb::address_t, edb::address_t>::iterator it = blocks_.begin();
+	while(it != blocks_.end()) {
+		if(covered_.contains(it.key())) {
+			++it;
+		} else {
+			it = blocks_.erase(it);
+		}
+	}
+}
+
+//------------------------------------------------------------------------------
+// Name: clear
+// Desc: stops watching and forgets everything which was covered
+//------------------------------------------------------------------------------
+void CoverageMap::clear() {
+	stop();
+	blocks_.clear();
+	covered_.clear();
+}
+
+//------------------------------------------------------------------------------
+// Name: record
+// Desc: marks the block starting at <address> as covered
+//------------------------------------------------------------------------------
+void CoverageMap::record(edb::address_t address) {
+	covered_.insert(address);
+}
+
+//------------------------------------------------------------------------------
+// Name: covered
+// Desc: returns true if <address> is inside of a block which has been covered
+//------------------------------------------------------------------------------
+bool CoverageMap::covered(edb::address_t address) const {
+
+	QMap<edb::address_t, edb::address_t>::const_iterator it = blocks_.upperBound(address);
+	if(it == blocks_.begin()) {
+		return false;
+	}
+
+	--it;
+	return address < it.value() && covered_.contains(it.key());
+}
+
+//------------------------------------------------------------------------------
+// Name: block_count
+// Desc:
+//------------------------------------------------------------------------------
+int CoverageMap::block_count() const {
+	return blocks_.size();
+}
+
+//------------------------------------------------------------------------------
+// Name: covered_count
+// Desc:
+//------------------------------------------------------------------------------
+int CoverageMap::covered_count() const {
+	return covered_.size();
+}
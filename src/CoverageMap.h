@@ -0,0 +1,52 @@
+/*
+Copyright (C) 2006 - 2013 Evan Teran
+                          eteran@alum.rit.edu
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef COVERAGE_MAP_20131030_H_
+#define COVERAGE_MAP_20131030_H_
+
+#include "IRegion.h"
+#include "Types.h"
+
+#include <QMap>
+#include <QSet>
+
+// block coverage. Every basic block the analyzer found gets a breakpoint which
+// the core takes out again on its first hit, so a block costs a single trap
+// no matter how often it runs and the process never stops for it
+class CoverageMap {
+public:
+	CoverageMap();
+
+public:
+	int start(const IRegion::pointer &region);
+	void stop();
+	void clear();
+	void record(edb::address_t address);
+
+public:
+	bool covered(edb::address_t address) const;
+	int block_count() const;
+	int covered_count() const;
+
+private:
+	// start of each block being watched -> one past its last byte
+	QMap<edb::address_t, edb::address_t> blocks_;
+	QSet<edb::address_t>                 covered_;
+};
+
+#endif
@@ -27,6 +27,7 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #include "DialogMemoryRegions.h"
 #include "DialogOptions.h"
 #include "DialogPlugins.h"
+#include "DialogStepTrace.h"
 #include "DialogThreads.h"
 #include "Expression.h"
 #include "IAnalyzer.h"
@@ -40,6 +41,7 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #include "QHexView"
 #include "RecentFileManager.h"
 #include "State.h"
+#include "StepRecorder.h"
 #include "SymbolManager.h"
 #include "edb.h"
 #include "version.h"
@@ -54,9 +56,11 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #include <QInputDialog>
 #include <QMessageBox>
 #include <QMimeData>
+#include <QProgressDialog>
 #include <QSettings>
 #include <QShortcut>
 #include <QStringListModel>
+#include <QSocketNotifier>
 #include <QTimer>
 #include <QToolButton>
 #include <QUrl>
@@ -65,6 +69,7 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 
 #include <boost/bind.hpp>
 #include <memory>
+#include <climits>
 #include <cstring>
 
 #if defined(Q_OS_UNIX) && !defined(Q_OS_MAC)
@@ -199,6 +204,7 @@ Debugger::Debugger(QWidget *parent) : QMainWindow(parent),
 		stack_view_info_(IRegion::pointer()), 
 		arguments_dialog_(new DialogArguments),
 		timer_(new QTimer(this)),
+		event_notifier_(0),
 		recent_file_manager_(new RecentFileManager(this)),
 		stack_comment_server_(new CommentServer),
 		stack_view_locked_(false)
@@ -211,6 +217,17 @@ Debugger::Debugger(QWidget *parent) : QMainWindow(parent),
 	// connect the timer to the debug event
 	connect(timer_, SIGNAL(timeout()), this, SLOT(next_debug_event()));
 
+	// if the core can tell us when an event is waiting, use that instead of
+	// the timer, there is no reason to poll a process which is just running
+	if(edb::v1::debugger_core) {
+		const int fd = edb::v1::debugger_core->event_fd();
+		if(fd != -1) {
+			event_notifier_ = new QSocketNotifier(fd, QSocketNotifier::Read, this);
+			event_notifier_->setEnabled(false);
+			connect(event_notifier_, SIGNAL(activated(int)), this, SLOT(next_debug_event()));
+		}
+	}
+
 	// create a context menu for the tab bar as well
 	connect(ui.tabWidget, SIGNAL(customContextMenuRequested(int, const QPoint &)), this, SLOT(tab_context_menu(int, const QPoint &)));
 
@@ -261,6 +278,7 @@ void Debugger::update_menu_state(GUI_STATE state) {
 	switch(state) {
 	case PAUSED:
 		ui.actionRun_Until_Return->setEnabled(true);
+		ui.action_Record_Instruction_Trace->setEnabled(true);
 		ui.action_Restart->setEnabled(true);
 		ui.action_Run->setEnabled(true);
 		ui.action_Pause->setEnabled(false);
@@ -276,6 +294,7 @@ void Debugger::update_menu_state(GUI_STATE state) {
 		break;
 	case RUNNING:
 		ui.actionRun_Until_Return->setEnabled(false);
+		ui.action_Record_Instruction_Trace->setEnabled(false);
 		ui.action_Restart->setEnabled(false);
 		ui.action_Run->setEnabled(false);
 		ui.action_Pause->setEnabled(true);
@@ -291,6 +310,7 @@ void Debugger::update_menu_state(GUI_STATE state) {
 		break;
 	case TERMINATED:
 		ui.actionRun_Until_Return->setEnabled(false);
+		ui.action_Record_Instruction_Trace->setEnabled(false);
 		ui.action_Restart->setEnabled(false);
 		ui.action_Run->setEnabled(false);
 		ui.action_Pause->setEnabled(false);
@@ -651,6 +671,11 @@ void Debugger::setup_ui() {
 
 	// apply the default setting for showing address separators
 	apply_default_show_separator();
+
+	// let the core deal with the signals which aren't meant to stop
+	edb::v1::apply_signal_policies();
+	edb::v1::apply_syscall_stops();
+	edb::v1::apply_non_stop();
 }
 
 //------------------------------------------------------------------------------
@@ -937,6 +962,18 @@ void Debugger::on_action_Configure_Debugger_triggered() {
 	// apply changes to the GUI options
 	apply_default_show_separator();
 
+	// and the signal policies
+	edb::v1::apply_signal_policies();
+	edb::v1::apply_non_stop();
+
+	const QStringList unknown_syscalls = edb::v1::apply_syscall_stops();
+	if(!unknown_syscalls.isEmpty()) {
+		QMessageBox::warning(
+			this,
+			tr("Unknown System Calls"),
+			tr("These system calls are not known and will not be stopped on: %1").arg(unknown_syscalls.join(", ")));
+	}
+
 	// show changes
 	refresh_gui();
 }
@@ -1593,24 +1630,11 @@ void Debugger::mnuStackModify() {
 	modify_bytes(stack_view_);
 }
 
-//------------------------------------------------------------------------------
-// Name: breakpoint_condition_true
-// Desc:
-//------------------------------------------------------------------------------
-bool Debugger::breakpoint_condition_true(const QString &condition) {
-
-	edb::address_t condition_value;
-	if(!edb::v1::eval_expression(condition, &condition_value)) {
-		return true;
-	}
-	return condition_value;
-}
-
 //------------------------------------------------------------------------------
 // Name: handle_trap
 // Desc: returns true if we should resume as if this trap never happened
 //------------------------------------------------------------------------------
-edb::EVENT_STATUS Debugger::handle_trap() {
+edb::EVENT_STATUS Debugger::handle_trap(const IDebugEvent::const_pointer &event) {
 
 	// we just got a trap event, there are a few possible causes
 	// #1: we hit a 0xcc breakpoint, if so, then we want to stop
@@ -1628,20 +1652,47 @@ edb::EVENT_STATUS Debugger::handle_trap() {
 	if(bp && bp->enabled()) {
 
 		// TODO: check if the breakpoint was corrupted
-		bp->hit();
 
 		// back up eip the size of a breakpoint, since we executed a breakpoint
 		// instead of the real code that belongs there
 		state.set_instruction_pointer(previous_ip);
 		edb::v1::debugger_core->set_state(state);
 
-		const QString condition = bp->condition;
+		// coverage breakpoints are done with after their first hit
+		if(bp->coverage) {
+			bp->hit();
+			edb::v1::record_coverage(previous_ip);
+			bp->disable();
+			edb::v1::debugger_core->remove_breakpoint(previous_ip);
+			return edb::DEBUG_CONTINUE;
+		}
 
-		// handle conditional breakpoints
-		if(!condition.isEmpty()) {
-			if(!breakpoint_condition_true(condition)) {
-				return edb::DEBUG_CONTINUE;
-			}
+		// handle ignore counts, conditions and tracepoints, unless the core
+		// has done so already, in which case we only see the hits which are
+		// due to stop
+		edb::BREAKPOINT_ACTION action = event->breakpoint_action();
+		QString error                 = event->breakpoint_error();
+		if(action == edb::BREAKPOINT_UNDECIDED) {
+			action = edb::v1::breakpoint_action(bp, state, &error);
+		}
+
+		edb::v1::complete_breakpoint_hit(bp, action, state);
+
+		switch(action) {
+		case edb::BREAKPOINT_IGNORE:
+		case edb::BREAKPOINT_SKIP:
+		case edb::BREAKPOINT_TRACE:
+			// step past the breakpoint with it out of the way and let the step
+			// event put it back and carry on running
+			bp->disable();
+			reenable_breakpoint_run_ = bp;
+			return edb::DEBUG_CONTINUE_STEP;
+		case edb::BREAKPOINT_ERROR:
+			// a condition which can't be evaluated always breaks
+			QMessageBox::information(this, tr("Error In Expression!"), error);
+			break;
+		default:
+			break;
 		}
 
 		// if it's a one time breakpoint then we should remove it upon
@@ -1677,14 +1728,13 @@ edb::EVENT_STATUS Debugger::handle_event_stopped(const IDebugEvent::const_pointe
 		return edb::DEBUG_STOP;
 	}
 
-	if(event->is_error()) {
-		const IDebugEvent::Message message = event->error_description();
-		QMessageBox::information(this, message.caption, message.message);
-		return edb::DEBUG_STOP;
-	}
-
 	if(event->is_trap()) {
-		return handle_trap();
+		// one of the system calls we asked to stop on, there is no
+		// breakpoint behind this one
+		if(event->trap_reason() == IDebugEvent::TRAP_SYSCALL) {
+			return edb::DEBUG_STOP;
+		}
+		return handle_trap(event);
 	}
 
 	if(event->is_stop()) {
@@ -1692,21 +1742,31 @@ edb::EVENT_STATUS Debugger::handle_event_stopped(const IDebugEvent::const_pointe
 		return edb::DEBUG_STOP;
 	}
 
-	switch(event->code()) {
-#ifdef Q_OS_UNIX
-	case SIGCHLD:
-	case SIGPROF:
+	// signals which are to go to the application, unless the core has already
+	// seen to that by itself
+	switch(edb::v1::signal_policy(event->code())) {
+	case edb::SIGNAL_LOG:
+		qDebug("[Debugger] passing signal %d to the application", event->code());
+		// FALL THROUGH!
+	case edb::SIGNAL_PASS:
 		return edb::DEBUG_EXCEPTION_NOT_HANDLED;
-#endif
 	default:
-		QMessageBox::information(this, tr("Debug Event"),
-			tr(
-			"<p>The debugged application has received a debug event-> <strong>%1</strong></p>"
-			"<p>If you would like to pass this event to the application press Shift+[F7/F8/F9]</p>"
-			"<p>If you would like to ignore this event, press [F7/F8/F9]</p>").arg(event->code()));
+		break;
+	}
 
+	if(event->is_error()) {
+		const IDebugEvent::Message message = event->error_description();
+		QMessageBox::information(this, message.caption, message.message);
 		return edb::DEBUG_STOP;
 	}
+
+	QMessageBox::information(this, tr("Debug Event"),
+		tr(
+		"<p>The debugged application has received a debug event-> <strong>%1</strong></p>"
+		"<p>If you would like to pass this event to the application press Shift+[F7/F8/F9]</p>"
+		"<p>If you would like to ignore this event, press [F7/F8/F9]</p>").arg(event->code()));
+
+	return edb::DEBUG_STOP;
 }
 
 //------------------------------------------------------------------------------
@@ -1745,6 +1805,15 @@ edb::EVENT_STATUS Debugger::handle_event(const IDebugEvent::const_pointer &event
 
 	Q_ASSERT(edb::v1::debugger_core);
 
+	// breakpoints which were taken out of the way for the last resume go back
+	// in once this event is dealt with, handling it may take out another one
+	const IBreakpoint::pointer reenable_step = reenable_breakpoint_step_;
+	const IBreakpoint::pointer reenable_run  = reenable_breakpoint_run_;
+	reenable_breakpoint_step_.clear();
+	reenable_breakpoint_run_.clear();
+
+	Q_ASSERT(!(reenable_step && reenable_run));
+
 	edb::EVENT_STATUS status;
 	switch(event->reason()) {
 	// either a syncronous event (STOPPED)
@@ -1767,16 +1836,14 @@ edb::EVENT_STATUS Debugger::handle_event(const IDebugEvent::const_pointer &event
 		return edb::DEBUG_EXCEPTION_NOT_HANDLED;
 	}
 
-	Q_ASSERT(!(reenable_breakpoint_step_ && reenable_breakpoint_run_));
-
 	// re-enable any breakpoints we previously disabled
-	if(reenable_breakpoint_step_) {
-		reenable_breakpoint_step_->enable();
-		reenable_breakpoint_step_.clear();
-	} else if(reenable_breakpoint_run_) {
-		reenable_breakpoint_run_->enable();
-		reenable_breakpoint_run_.clear();
-		status = edb::DEBUG_CONTINUE;
+	if(reenable_step) {
+		reenable_step->enable();
+	} else if(reenable_run) {
+		reenable_run->enable();
+		if(status == edb::DEBUG_STOP) {
+			status = edb::DEBUG_CONTINUE;
+		}
 	}
 
 	return status;
@@ -2088,6 +2155,101 @@ void Debugger::on_actionRun_Until_Return_triggered() {
 	resume_execution(PASS_EXCEPTION, MODE_STEP);
 }
 
+//------------------------------------------------------------------------------
+// Name: on_action_Record_Instruction_Trace_triggered
+// Desc: steps the active thread as far as asked and writes every step to an
+//       instruction trace. The core does the steps a batch at a time and the
+//       display is only brought up to date once it is all done
+//------------------------------------------------------------------------------
+void Debugger::on_action_Record_Instruction_Trace_triggered() {
+
+	Q_ASSERT(edb::v1::debugger_core);
+
+	bool ok;
+	const int count = QInputDialog::getInt(this, tr("Record Instruction Trace"), tr("Number of steps (stepping also ends at a breakpoint):"), 100000, 1, INT_MAX, 1000, &ok);
+	if(!ok) {
+		return;
+	}
+
+	QStringList modes;
+	modes << tr("Every instruction") << tr("Every taken branch");
+	const QString mode = QInputDialog::getItem(this, tr("Record Instruction Trace"), tr("Record:"), modes, 0, false, &ok);
+	if(!ok) {
+		return;
+	}
+
+	const edb::tid_t tid   = edb::v1::debugger_core->active_thread();
+	const QString filename = QFileDialog::getSaveFileName(
+		this,
+		tr("Save Instruction Trace As"),
+		QDir::temp().filePath(QString("edb-steps-%1.edbsteps").arg(tid)),
+		tr("Instruction Traces (*.edbsteps)"));
+
+	if(filename.isEmpty()) {
+		return;
+	}
+
+	State state;
+	edb::v1::debugger_core->get_state(&state);
+
+	StepRecorder recorder;
+	if(!recorder.start(filename, tid, state)) {
+		QMessageBox::information(this, tr("Could Not Record"), tr("Could not create %1: %2").arg(filename, recorder.error_string()));
+		return;
+	}
+
+	const IDebuggerCore::StepMode step_mode = (mode == modes[0]) ? IDebuggerCore::STEP_INSTRUCTION : IDebuggerCore::STEP_BLOCK;
+
+	QProgressDialog progress(tr("Recording instruction trace..."), tr("Stop"), 0, count, this);
+	progress.setWindowModality(Qt::WindowModal);
+	progress.setMinimumDuration(500);
+
+	// small enough batches that the progress (and the stop button) stay
+	// responsive
+	const int batch_size = 4096;
+
+	int remaining = count;
+	int steps     = 0;
+	while(remaining > 0 && !progress.wasCanceled()) {
+		const int batch = qMin(remaining, batch_size);
+		steps = edb::v1::debugger_core->step_many(&recorder, batch, step_mode);
+		if(steps == -1) {
+			break;
+		}
+
+		remaining -= steps;
+		progress.setValue(count - remaining);
+
+		if(steps != batch) {
+			break;
+		}
+	}
+
+	progress.reset();
+	recorder.finish();
+
+	if(steps == -1 && recorder.steps() == 0) {
+		QFile::remove(filename);
+		QMessageBox::information(this, tr("Could Not Record"), tr("The debugger core can not record this kind of instruction trace."));
+		return;
+	}
+
+	edb::v1::memory_regions().sync();
+	update_gui();
+
+	edb::v1::set_status(tr("recorded %1 steps to %2").arg(recorder.steps()).arg(filename));
+}
+
+//------------------------------------------------------------------------------
+// Name: on_action_Instruction_Trace_triggered
+// Desc:
+//------------------------------------------------------------------------------
+void Debugger::on_action_Instruction_Trace_triggered() {
+	QPointer<DialogStepTrace> dlg = new DialogStepTrace(this);
+	dlg->exec();
+	delete dlg;
+}
+
 //------------------------------------------------------------------------------
 // Name: on_action_Pause_triggered
 // Desc:
@@ -2103,7 +2265,11 @@ void Debugger::on_action_Pause_triggered() {
 //------------------------------------------------------------------------------
 void Debugger::cleanup_debugger() {
 
-	timer_->stop();
+	if(event_notifier_) {
+		event_notifier_->setEnabled(false);
+	} else {
+		timer_->stop();
+	}
 
 	edb::v1::memory_regions().clear();
 	edb::v1::symbol_manager().clear();
@@ -2176,7 +2342,12 @@ void Debugger::detach_from_process(DETACH_ACTION kill) {
 void Debugger::set_initial_debugger_state() {
 
 	update_menu_state(PAUSED);
-	timer_->start(0);
+
+	if(event_notifier_) {
+		event_notifier_->setEnabled(true);
+	} else {
+		timer_->start(0);
+	}
 
 	edb::v1::symbol_manager().set_symbol_path(edb::v1::config().symbol_path);
 	edb::v1::memory_regions().sync();
@@ -2477,6 +2648,13 @@ void Debugger::on_action_Threads_triggered() {
 			edb::tid_t tid = dlg->selected_thread();
 			if(tid != 0) {
 				edb::v1::debugger_core->set_active_thread(tid);
+
+				// in non-stop mode a thread which is stopped can be picked up
+				// while the others run
+				if(gui_state_ == RUNNING && edb::v1::debugger_core->active_thread() == tid && !edb::v1::debugger_core->thread_running(tid)) {
+					update_menu_state(PAUSED);
+				}
+
 				update_gui();
 			}
 		}
@@ -2662,12 +2840,15 @@ void Debugger::next_debug_event() {
 
 	Q_ASSERT(edb::v1::debugger_core);
 
-	if(IDebugEvent::const_pointer e = edb::v1::debugger_core->wait_debug_event(10)) {
+	// when woken up by the notifier, the event is already there
+	const int msecs = event_notifier_ ? 1 : 10;
+
+	if(IDebugEvent::const_pointer e = edb::v1::debugger_core->wait_debug_event(msecs)) {
 
 		last_event_ = e;
 
-		// TODO: figure out a way to do this less often, if they map an obscene
-		// number of regions, this really slows things down
+		// this is cheap unless the map actually changed, and then only the
+		// regions which changed are touched
 		edb::v1::memory_regions().sync();
 
 		// TODO: make the system use this information, this is huge! it will
@@ -32,7 +32,9 @@ class IBreakpoint;
 class IDebugEvent;
 class IPlugin;
 class RecentFileManager;
+class State;
 
+class QSocketNotifier;
 class QStringListModel;
 class QTimer;
 class QToolButton;
@@ -106,11 +108,13 @@ public Q_SLOTS:
 	void on_action_Attach_triggered();
 	void on_action_Configure_Debugger_triggered();
 	void on_action_Detach_triggered();
+	void on_action_Instruction_Trace_triggered();
 	void on_action_Kill_triggered();
 	void on_action_Memory_Regions_triggered();
 	void on_action_Open_triggered();
 	void on_action_Pause_triggered();
 	void on_action_Plugins_triggered();
+	void on_action_Record_Instruction_Trace_triggered();
 	void on_action_Restart_triggered();
 	void on_action_Run_Pass_Signal_To_Application_triggered();
 	void on_action_Run_triggered();
@@ -191,13 +195,12 @@ private:
 	IRegion::pointer update_cpu_view(const State &state);
 	QString create_tty();
 	QString session_filename() const;
-	bool breakpoint_condition_true(const QString &condition);
 	bool common_open(const QString &s, const QList<QByteArray> &args);
 	edb::EVENT_STATUS debug_event_handler(const IDebugEvent::const_pointer &event);
 	edb::EVENT_STATUS handle_event_exited(const IDebugEvent::const_pointer &event);
 	edb::EVENT_STATUS handle_event_stopped(const IDebugEvent::const_pointer &event);
 	edb::EVENT_STATUS handle_event_terminated(const IDebugEvent::const_pointer &event);
-	edb::EVENT_STATUS handle_trap();
+	edb::EVENT_STATUS handle_trap(const IDebugEvent::const_pointer &event);
 	edb::EVENT_STATUS resume_status(bool pass_exception);
 	edb::address_t get_goto_expression(bool *ok);
 	edb::reg_t get_follow_register(bool *ok) const;
@@ -266,6 +269,7 @@ private:
 	QStringListModel *                               list_model_;
 	DialogArguments *                                arguments_dialog_;
 	QTimer *                                         timer_;
+	QSocketNotifier *                                event_notifier_;
 	RecentFileManager *                              recent_file_manager_;
 
 	QSharedPointer<QHexView::CommentServerInterface> stack_comment_server_;
@@ -24,12 +24,59 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #include <QFileDialog>
 #include <QFont>
 #include <QCloseEvent>
+#include <QComboBox>
+#include <QRegExp>
 #include <QToolBox>
 #include <QDebug>
 
+#ifdef Q_OS_UNIX
+#include <csignal>
+#endif
+
 #include "ui_DialogOptions.h"
 
 namespace {
+
+#ifdef Q_OS_UNIX
+struct SignalName {
+	int         signal;
+	const char *name;
+};
+
+// the signals a policy can be set for, SIGTRAP and SIGSTOP belong to the
+// debugger and SIGKILL can't be caught anyway
+const SignalName signal_names[] = {
+	{ SIGHUP,    "SIGHUP" },
+	{ SIGINT,    "SIGINT" },
+	{ SIGQUIT,   "SIGQUIT" },
+	{ SIGILL,    "SIGILL" },
+	{ SIGABRT,   "SIGABRT" },
+	{ SIGBUS,    "SIGBUS" },
+	{ SIGFPE,    "SIGFPE" },
+	{ SIGUSR1,   "SIGUSR1" },
+	{ SIGSEGV,   "SIGSEGV" },
+	{ SIGUSR2,   "SIGUSR2" },
+	{ SIGPIPE,   "SIGPIPE" },
+	{ SIGALRM,   "SIGALRM" },
+	{ SIGTERM,   "SIGTERM" },
+	{ SIGCHLD,   "SIGCHLD" },
+	{ SIGCONT,   "SIGCONT" },
+	{ SIGTSTP,   "SIGTSTP" },
+	{ SIGTTIN,   "SIGTTIN" },
+	{ SIGTTOU,   "SIGTTOU" },
+	{ SIGURG,    "SIGURG" },
+	{ SIGXCPU,   "SIGXCPU" },
+	{ SIGXFSZ,   "SIGXFSZ" },
+	{ SIGVTALRM, "SIGVTALRM" },
+	{ SIGPROF,   "SIGPROF" },
+	{ SIGWINCH,  "SIGWINCH" },
+#ifdef SIGIO
+	{ SIGIO,     "SIGIO" },
+#endif
+	{ SIGSYS,    "SIGSYS" }
+};
+#endif
+
 //------------------------------------------------------------------------------
 // Name: width_to_index
 // Desc:
@@ -52,6 +99,26 @@ int width_to_index(int n) {
 //------------------------------------------------------------------------------
 DialogOptions::DialogOptions(QWidget *parent) : QDialog(parent), ui(new Ui::DialogOptions), toolbox_(0) {
 	ui->setupUi(this);
+
+#ifdef Q_OS_UNIX
+	for(std::size_t i = 0; i < sizeof(signal_names) / sizeof(signal_names[0]); ++i) {
+		const int row = ui->tblSignals->rowCount();
+		ui->tblSignals->insertRow(row);
+
+		QTableWidgetItem *const item = new QTableWidgetItem(QString("%1 (%2)").arg(signal_names[i].name).arg(signal_names[i].signal));
+		item->setData(Qt::UserRole, signal_names[i].signal);
+		ui->tblSignals->setItem(row, 0, item);
+
+		// the items are in the order of edb::SIGNAL_POLICY
+		QComboBox *const policy = new QComboBox;
+		policy->addItem(tr("Stop"));
+		policy->addItem(tr("Pass To Application"));
+		policy->addItem(tr("Pass To Application And Log"));
+		ui->tblSignals->setCellWidget(row, 1, policy);
+	}
+
+	ui->tblSignals->resizeColumnToContents(0);
+#endif
 }
 
 //------------------------------------------------------------------------------
@@ -207,6 +274,7 @@ void DialogOptions::showEvent(QShowEvent *event) {
 	ui->chkUppercase->setChecked(config.uppercase_disassembly);
 
 	ui->chkFindMain->setChecked(config.find_main);
+	ui->chkNonStop->setChecked(config.non_stop);
 	ui->chkWarnDataBreakpoint->setChecked(config.warn_on_no_exec_bp);
 
 	ui->spnMinString->setValue(config.min_string_length);
@@ -228,6 +296,15 @@ void DialogOptions::showEvent(QShowEvent *event) {
 	ui->cmbDataRowWidth->setCurrentIndex(width_to_index(config.data_row_width));
 
 	ui->chkAddressSemicolon->setChecked(config.show_address_separator);
+
+	for(int row = 0; row < ui->tblSignals->rowCount(); ++row) {
+		const int signal = ui->tblSignals->item(row, 0)->data(Qt::UserRole).toInt();
+		if(QComboBox *const policy = qobject_cast<QComboBox *>(ui->tblSignals->cellWidget(row, 1))) {
+			policy->setCurrentIndex(config.signal_policies.value(signal, edb::SIGNAL_STOP));
+		}
+	}
+
+	ui->txtSyscalls->setText(config.syscall_stops.join(", "));
 }
 
 //------------------------------------------------------------------------------
@@ -271,6 +348,7 @@ void DialogOptions::closeEvent(QCloseEvent *event) {
 
 	config.warn_on_no_exec_bp     = ui->chkWarnDataBreakpoint->isChecked();
 	config.find_main              = ui->chkFindMain->isChecked();
+	config.non_stop               = ui->chkNonStop->isChecked();
 
 	config.show_address_separator = ui->chkAddressSemicolon->isChecked();
 
@@ -283,6 +361,15 @@ void DialogOptions::closeEvent(QCloseEvent *event) {
 	config.data_word_width    = 1 << ui->cmbDataWordWidth->currentIndex();
 	config.data_row_width     = 1 << ui->cmbDataRowWidth->currentIndex();
 
+	for(int row = 0; row < ui->tblSignals->rowCount(); ++row) {
+		const int signal = ui->tblSignals->item(row, 0)->data(Qt::UserRole).toInt();
+		if(QComboBox *const policy = qobject_cast<QComboBox *>(ui->tblSignals->cellWidget(row, 1))) {
+			config.signal_policies.insert(signal, static_cast<edb::SIGNAL_POLICY>(policy->currentIndex()));
+		}
+	}
+
+	config.syscall_stops = ui->txtSyscalls->text().split(QRegExp("[,\\s]+"), QString::SkipEmptyParts);
+
 	event->accept();
 }
 
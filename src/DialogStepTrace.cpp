@@ -0,0 +1,222 @@
+/*
+Copyright (C) 2006 - 2013 Evan Teran
+                          eteran@alum.rit.edu
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "DialogStepTrace.h"
+#include "IDebuggerCore.h"
+#include "Instruction.h"
+#include "QDisassemblyView.h"
+#include "edb.h"
+
+#include <QAbstractTableModel>
+#include <QFileDialog>
+#include <QHeaderView>
+#include <QMessageBox>
+#include <QSet>
+
+#include "ui_DialogStepTrace.h"
+
+namespace {
+
+// the steps of a trace, instructions are disassembled from the process as it
+// is now, only for the rows which are actually shown
+class StepTraceModel : public QAbstractTableModel {
+public:
+	StepTraceModel(const StepTraceFile *trace, QObject *parent) : QAbstractTableModel(parent), trace_(trace) {
+	}
+
+public:
+	void reload() {
+		beginResetModel();
+		endResetModel();
+	}
+
+public:
+	virtual int rowCount(const QModelIndex &parent) const {
+		return parent.isValid() ? 0 : trace_->size();
+	}
+
+	virtual int columnCount(const QModelIndex &parent) const {
+		return parent.isValid() ? 0 : 3;
+	}
+
+	virtual QVariant headerData(int section, Qt::Orientation orientation, int role) const {
+		if(role == Qt::DisplayRole && orientation == Qt::Horizontal) {
+			switch(section) {
+			case 0: return tr("Step");
+			case 1: return tr("Address");
+			case 2: return tr("Instruction");
+			}
+		}
+		return QVariant();
+	}
+
+	virtual QVariant data(const QModelIndex &index, int role) const {
+		if(!index.isValid() || role != Qt::DisplayRole) {
+			return QVariant();
+		}
+
+		const edb::address_t address = trace_->address(index.row());
+
+		switch(index.column()) {
+		case 0:
+			return index.row() + 1;
+		case 1:
+			return edb::v1::find_function_symbol(address, edb::v1::format_pointer(address));
+		case 2:
+			if(edb::v1::debugger_core && edb::v1::debugger_core->pid() != 0) {
+				quint8 buf[edb::Instruction::MAX_SIZE];
+				int buf_size = sizeof(buf);
+				if(edb::v1::get_instruction_bytes(address, buf, &buf_size)) {
+					const edb::Instruction insn(buf, buf + buf_size, address, std::nothrow);
+					if(insn) {
+						return QString::fromStdString(to_string(insn));
+					}
+				}
+			}
+			break;
+		}
+
+		return QVariant();
+	}
+
+private:
+	const StepTraceFile *const trace_;
+};
+
+}
+
+//------------------------------------------------------------------------------
+// Name: DialogStepTrace
+// Desc:
+//------------------------------------------------------------------------------
+DialogStepTrace::DialogStepTrace(QWidget *parent) : QDialog(parent), ui(new Ui::DialogStepTrace), model_(0) {
+	ui->setupUi(this);
+
+	StepTraceModel *const model = new StepTraceModel(&trace_, this);
+	model_ = model;
+
+	ui->tableSteps->setModel(model);
+	connect(ui->tableSteps->selectionModel(), SIGNAL(currentRowChanged(const QModelIndex &, const QModelIndex &)), this, SLOT(step_selected(const QModelIndex &)));
+
+#if QT_VERSION >= 0x050000
+	ui->tableRegisters->horizontalHeader()->setSectionResizeMode(QHeaderView::ResizeToContents);
+#else
+	ui->tableRegisters->horizontalHeader()->setResizeMode(QHeaderView::ResizeToContents);
+#endif
+}
+
+//------------------------------------------------------------------------------
+// Name: ~DialogStepTrace
+// Desc:
+//------------------------------------------------------------------------------
+DialogStepTrace::~DialogStepTrace() {
+	delete ui;
+}
+
+//------------------------------------------------------------------------------
+// Name: load
+// Desc:
+//------------------------------------------------------------------------------
+bool DialogStepTrace::load(const QString &filename) {
+
+	const bool ok = trace_.load(filename);
+	static_cast<StepTraceModel *>(model_)->reload();
+
+	ui->tableRegisters->setRowCount(0);
+
+	if(ok) {
+		ui->lblSummary->setText(tr("%1: %2 steps of thread %3").arg(filename).arg(trace_.size()).arg(trace_.info().tid));
+	} else {
+		ui->lblSummary->clear();
+		QMessageBox::information(this, tr("Could Not Open"), tr("Could not read %1: %2").arg(filename, trace_.error_string()));
+	}
+
+	mark_traced_addresses(ok);
+	return ok;
+}
+
+//------------------------------------------------------------------------------
+// Name: on_btnOpen_clicked
+// Desc:
+//------------------------------------------------------------------------------
+void DialogStepTrace::on_btnOpen_clicked() {
+	const QString filename = QFileDialog::getOpenFileName(this, tr("Open Instruction Trace"), QString(), tr("Instruction Traces (*.edbsteps);;All Files (*)"));
+	if(!filename.isEmpty()) {
+		load(filename);
+	}
+}
+
+//------------------------------------------------------------------------------
+// Name: step_selected
+// Desc: shows the step in the CPU view and the registers as the step left
+//       them, the ones it changed are in red
+//------------------------------------------------------------------------------
+void DialogStepTrace::step_selected(const QModelIndex &index) {
+
+	if(!index.isValid()) {
+		return;
+	}
+
+	const int step = index.row();
+
+	if(edb::v1::debugger_core && edb::v1::debugger_core->pid() != 0) {
+		edb::v1::jump_to_address(trace_.address(step));
+	}
+
+	const QStringList names          = trace_.info().registers;
+	const QVector<edb::reg_t> values = trace_.registers(step);
+	const QVector<edb::reg_t> before = (step != 0) ? trace_.registers(step - 1) : values;
+
+	ui->tableRegisters->setRowCount(names.size());
+	for(int i = 0; i < names.size(); ++i) {
+		QTableWidgetItem *const name  = new QTableWidgetItem(names[i]);
+		QTableWidgetItem *const value = new QTableWidgetItem(edb::v1::format_pointer(values[i]));
+		if(values[i] != before[i]) {
+			value->setForeground(Qt::red);
+		}
+		ui->tableRegisters->setItem(i, 0, name);
+		ui->tableRegisters->setItem(i, 1, value);
+	}
+}
+
+//------------------------------------------------------------------------------
+// Name: hideEvent
+// Desc: the marks only make sense while the trace is on screen
+//------------------------------------------------------------------------------
+void DialogStepTrace::hideEvent(QHideEvent *event) {
+	mark_traced_addresses(false);
+	QDialog::hideEvent(event);
+}
+
+//------------------------------------------------------------------------------
+// Name: mark_traced_addresses
+// Desc:
+//------------------------------------------------------------------------------
+void DialogStepTrace::mark_traced_addresses(bool show) {
+
+	QSet<edb::address_t> addresses;
+	if(show) {
+		for(int i = 0; i < trace_.size(); ++i) {
+			addresses.insert(trace_.address(i));
+		}
+	}
+
+	if(QDisassemblyView *const view = qobject_cast<QDisassemblyView *>(edb::v1::disassembly_widget())) {
+		view->setTracedAddresses(addresses);
+	}
+}
@@ -0,0 +1,62 @@
+/*
+Copyright (C) 2006 - 2013 Evan Teran
+                          eteran@alum.rit.edu
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef DIALOG_STEP_TRACE_20131103_H_
+#define DIALOG_STEP_TRACE_20131103_H_
+
+#include "StepTraceFile.h"
+
+#include <QDialog>
+
+namespace Ui { class DialogStepTrace; }
+
+class QAbstractTableModel;
+class QModelIndex;
+
+// shows an instruction trace, picking a step shows it in the CPU view along
+// with the registers as they were after it. While the dialog is open, every
+// instruction in the trace is marked in the CPU view
+class DialogStepTrace : public QDialog {
+	Q_OBJECT
+
+public:
+	DialogStepTrace(QWidget *parent = 0);
+	virtual ~DialogStepTrace();
+
+public:
+	bool load(const QString &filename);
+
+public Q_SLOTS:
+	void on_btnOpen_clicked();
+
+private Q_SLOTS:
+	void step_selected(const QModelIndex &index);
+
+private:
+	virtual void hideEvent(QHideEvent *event);
+
+private:
+	void mark_traced_addresses(bool show);
+
+private:
+	Ui::DialogStepTrace *const ui;
+	QAbstractTableModel       *model_;
+	StepTraceFile              trace_;
+};
+
+#endif
@@ -72,6 +72,12 @@ void DialogThreads::showEvent(QShowEvent *) {
 		item->setData(Qt::UserRole, static_cast<qulonglong>(thread));
 
 		ui->thread_table->setItem(row, 0, item);
+
+		if(edb::v1::debugger_core->thread_running(thread)) {
+			ui->thread_table->setItem(row, 1, new QTableWidgetItem(tr("Running")));
+		} else {
+			ui->thread_table->setItem(row, 1, new QTableWidgetItem(tr("Stopped")));
+		}
 	}
 
 	ui->thread_table->resizeRowsToContents();
@@ -86,7 +92,7 @@ void DialogThreads::showEvent(QShowEvent *) {
 edb::tid_t DialogThreads::selected_thread() {
 	QList<QTableWidgetItem *> selected = ui->thread_table->selectedItems();
 	if(!selected.isEmpty()) {
-		return selected[0]->data(Qt::UserRole).toUInt();
+		return ui->thread_table->item(selected[0]->row(), 0)->data(Qt::UserRole).toUInt();
 	}
 	return 0;
 }
@@ -0,0 +1,90 @@
+/*
+Copyright (C) 2006 - 2013 Evan Teran
+                          eteran@alum.rit.edu
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "IState.h"
+
+#include <QHash>
+#include <QMutex>
+#include <QStringList>
+
+//------------------------------------------------------------------------------
+// These are the fallbacks for platforms whose state does not have its own
+// register table. Names are interned into a process wide list so that an id
+// stays valid for every state object, the lookup by id then simply goes back
+// through value(const QString &).
+//------------------------------------------------------------------------------
+
+namespace {
+
+QMutex             register_names_mutex;
+QStringList        register_names;
+QHash<QString,int> register_ids;
+
+}
+
+//------------------------------------------------------------------------------
+// Name: register_id
+// Desc: returns an id for the named register, or -1 if there is no such
+//       register
+//------------------------------------------------------------------------------
+int IState::register_id(const QString &reg) const {
+
+	const QString name = reg.toLower();
+
+	{
+		QMutexLocker locker(&register_names_mutex);
+		QHash<QString,int>::const_iterator it = register_ids.constFind(name);
+		if(it != register_ids.constEnd()) {
+			return it.value();
+		}
+	}
+
+	// only hand out ids for names which really are registers
+	if(!value(name).valid()) {
+		return -1;
+	}
+
+	QMutexLocker locker(&register_names_mutex);
+	QHash<QString,int>::const_iterator it = register_ids.constFind(name);
+	if(it != register_ids.constEnd()) {
+		return it.value();
+	}
+
+	const int id = register_names.size();
+	register_names.push_back(name);
+	register_ids.insert(name, id);
+	return id;
+}
+
+//------------------------------------------------------------------------------
+// Name: value
+// Desc: returns the value of a register previously resolved with register_id
+//------------------------------------------------------------------------------
+Register IState::value(int id) const {
+
+	QString name;
+	{
+		QMutexLocker locker(&register_names_mutex);
+		if(id < 0 || id >= register_names.size()) {
+			return Register();
+		}
+		name = register_names[id];
+	}
+
+	return value(name);
+}
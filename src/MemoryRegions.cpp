@@ -23,11 +23,58 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 
 #include <QDebug>
 
+#include <algorithm>
+
+namespace {
+
+//------------------------------------------------------------------------------
+// Name: load_symbols
+// Desc: if the region has a name, is mapped starting at the beginning of the
+//       file, and is executable, sounds like a module mapping!
+//------------------------------------------------------------------------------
+void load_symbols(const IRegion::pointer &region) {
+	if(!region->name().isEmpty()) {
+		if(region->base() == 0) {
+			if(region->executable()) {
+				edb::v1::symbol_manager().load_symbol_file(region->name(), region->start());
+			}
+		}
+	}
+}
+
+//------------------------------------------------------------------------------
+// Name: region_less
+// Desc:
+//------------------------------------------------------------------------------
+bool region_less(const IRegion::pointer &a, const IRegion::pointer &b) {
+	return a->start() < b->start();
+}
+
+//------------------------------------------------------------------------------
+// Name: same_regions
+// Desc: true if both lists hold the very same region objects
+//------------------------------------------------------------------------------
+bool same_regions(const QList<IRegion::pointer> &a, const QList<IRegion::pointer> &b) {
+	if(a.size() != b.size()) {
+		return false;
+	}
+
+	for(int i = 0; i < a.size(); ++i) {
+		if(a[i] != b[i]) {
+			return false;
+		}
+	}
+
+	return true;
+}
+
+}
+
 //------------------------------------------------------------------------------
 // Name: MemoryRegions
 // Desc: constructor
 //------------------------------------------------------------------------------
-MemoryRegions::MemoryRegions() : QAbstractItemModel(0) {
+MemoryRegions::MemoryRegions() : QAbstractItemModel(0), index_(new RegionIndex) {
 }
 
 //------------------------------------------------------------------------------
@@ -42,61 +89,163 @@ MemoryRegions::~MemoryRegions() {
 // Desc:
 //------------------------------------------------------------------------------
 void MemoryRegions::clear() {
+#if QT_VERSION >= 0x050000
+	beginResetModel();
+#endif
+
 	regions_.clear();
+	rebuild_index();
+
+#if QT_VERSION >= 0x050000
+	endResetModel();
+#else
+	reset();
+#endif
 }
 
 //------------------------------------------------------------------------------
 // Name: sync
-// Desc: reads a memory map file line by line
+// Desc: brings the list up to date with the memory map of the process. Only
+//       the regions which actually changed are removed or inserted, so views
+//       of the model keep their selection and scroll position
 //------------------------------------------------------------------------------
 void MemoryRegions::sync() {
 
-#if QT_VERSION >= 0x050000
-	beginResetModel();
-#endif
-
 	QList<IRegion::pointer> regions;
-	
+
 	if(edb::v1::debugger_core) {
 		regions = edb::v1::debugger_core->memory_regions();
-		Q_FOREACH(const IRegion::pointer &region, regions) {
-			// if the region has a name, is mapped starting
-			// at the beginning of the file, and is executable, sounds
-			// like a module mapping!
-			if(!region->name().isEmpty()) {
-				if(region->base() == 0) {
-					if(region->executable()) {
-						edb::v1::symbol_manager().load_symbol_file(region->name(), region->start());
-					}
-				}
-			}
-		}
-		
 		if(regions.isEmpty()) {
 			qDebug() << "[MemoryRegions] warning: empty memory map";
 		}
 	}
 
+	// a core may hand back the same list as last time if nothing changed
+	if(same_regions(regions_, regions)) {
+		return;
+	}
+
+	// nothing to line up, just do it in one go
+	if(regions_.isEmpty()) {
+		beginInsertRows(QModelIndex(), 0, regions.size() - 1);
+		regions_ = regions;
+		endInsertRows();
+
+		rebuild_index();
+
+		Q_FOREACH(const IRegion::pointer &region, regions_) {
+			load_symbols(region);
+		}
+		return;
+	}
+
+	// walk both lists (which are sorted by address) together, everything
+	// before <row> already matches everything before <i>
+	int row = 0;
+	int i   = 0;
+	while(i != regions.size()) {
+		const IRegion::pointer &region = regions[i];
 
-	qSwap(regions_, regions);
-#if QT_VERSION >= 0x050000
-	endResetModel();
-#else
-	reset();
-#endif
+		if(row != regions_.size()) {
+			if(regions_[row]->compare(region) == 0) {
+				++row;
+				++i;
+				continue;
+			}
+
+			// this one is gone, or has changed and is about to be replaced
+			if(regions_[row]->start() <= region->start()) {
+				beginRemoveRows(QModelIndex(), row, row);
+				regions_.removeAt(row);
+				endRemoveRows();
+				continue;
+			}
+		}
+
+		beginInsertRows(QModelIndex(), row, row);
+		regions_.insert(row, region);
+		endInsertRows();
+
+		load_symbols(region);
+
+		++row;
+		++i;
+	}
+
+	if(row != regions_.size()) {
+		beginRemoveRows(QModelIndex(), row, regions_.size() - 1);
+		regions_.erase(regions_.begin() + row, regions_.end());
+		endRemoveRows();
+	}
+
+	// the contents match now, but take the core's objects so that the quick
+	// check above works next time around
+	regions_ = regions;
+	rebuild_index();
 }
 
 //------------------------------------------------------------------------------
-// Name: find_region
+// Name: rebuild_index
+// Desc: sorts the regions by address for find_region, the new index replaces
+//       the old one in one go
+//------------------------------------------------------------------------------
+void MemoryRegions::rebuild_index() {
+
+	RegionIndex *const index = new RegionIndex;
+
+	index->regions = regions_.toVector();
+	std::sort(index->regions.begin(), index->regions.end(), region_less);
+
+	index->starts.resize(index->regions.size());
+	index->ends.resize(index->regions.size());
+
+	for(int i = 0; i < index->regions.size(); ++i) {
+		index->starts[i] = index->regions[i]->start();
+		index->ends[i]   = index->regions[i]->end();
+	}
+
+	// the old index goes away once the last lookup using it is done, which
+	// needn't be under the lock
+	QSharedPointer<const RegionIndex> old_index(index);
+
+	QMutexLocker locker(&index_mutex_);
+	qSwap(index_, old_index);
+}
+
+//------------------------------------------------------------------------------
+// Name: current_index
 // Desc:
 //------------------------------------------------------------------------------
+QSharedPointer<const MemoryRegions::RegionIndex> MemoryRegions::current_index() const {
+	QMutexLocker locker(&index_mutex_);
+	return index_;
+}
+
+//------------------------------------------------------------------------------
+// Name: find_region
+// Desc: returns the region containing <address>, in O(log n)
+// Note: may be called from any thread
+//------------------------------------------------------------------------------
 IRegion::pointer MemoryRegions::find_region(edb::address_t address) const {
 
-	Q_FOREACH(const IRegion::pointer &i, regions_) {
-		if(i->contains(address)) {
-			return i;
+	const QSharedPointer<const RegionIndex> index = current_index();
+
+	// lookups tend to land in the same region as the one before
+	const int hit = index->last_hit.fetchAndAddRelaxed(0);
+	if(hit < index->starts.size() && address >= index->starts[hit] && address < index->ends[hit]) {
+		return index->regions[hit];
+	}
+
+	// find the last region starting at or before the address
+	const QVector<edb::address_t>::const_iterator it = std::upper_bound(index->starts.begin(), index->starts.end(), address);
+	if(it != index->starts.begin()) {
+		const int n = (it - index->starts.begin()) - 1;
+		if(address < index->ends[n]) {
+			index->last_hit.fetchAndStoreRelaxed(n);
+			return index->regions[n];
 		}
 	}
+
 	return IRegion::pointer();
 }
 
@@ -129,6 +129,29 @@ Register State::value(const QString &reg) const {
 	return Register();
 }
 
+//------------------------------------------------------------------------------
+// Name: value
+// Desc: returns the value of a register previously resolved with register_id
+//------------------------------------------------------------------------------
+Register State::value(int id) const {
+	if(impl_) {
+		return impl_->value(id);
+	}
+	return Register();
+}
+
+//------------------------------------------------------------------------------
+// Name: register_id
+// Desc: resolves a register name to an id which can be passed to value(int),
+//       returns -1 if there is no such register
+//------------------------------------------------------------------------------
+int State::register_id(const QString &reg) const {
+	if(impl_) {
+		return impl_->register_id(reg);
+	}
+	return -1;
+}
+
 //------------------------------------------------------------------------------
 // Name: operator[]
 // Desc:
@@ -0,0 +1,123 @@
+/*
+Copyright (C) 2006 - 2013 Evan Teran
+                          eteran@alum.rit.edu
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "StepRecorder.h"
+#include "State.h"
+#include "edb.h"
+
+namespace {
+
+//------------------------------------------------------------------------------
+// Name: traced_registers
+// Desc: what is kept for every step, besides the address
+//------------------------------------------------------------------------------
+QStringList traced_registers() {
+	if(edb::v1::pointer_size() == 8) {
+		return QString("rax,rbx,rcx,rdx,rsi,rdi,rbp,rsp,r8,r9,r10,r11,r12,r13,r14,r15,rflags").split(',');
+	} else {
+		return QString("eax,ebx,ecx,edx,esi,edi,ebp,esp,eflags").split(',');
+	}
+}
+
+}
+
+//------------------------------------------------------------------------------
+// Name: StepRecorder
+// Desc:
+//------------------------------------------------------------------------------
+StepRecorder::StepRecorder() : steps_(0), ok_(false) {
+}
+
+//------------------------------------------------------------------------------
+// Name: ~StepRecorder
+// Desc:
+//------------------------------------------------------------------------------
+StepRecorder::~StepRecorder() {
+	finish();
+}
+
+//------------------------------------------------------------------------------
+// Name: start
+// Desc: creates the trace file, registers are looked up by name once here
+//------------------------------------------------------------------------------
+bool StepRecorder::start(const QString &filename, edb::tid_t tid, const State &state) {
+
+	finish();
+
+	file_.setFileName(filename);
+	if(!file_.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+		return false;
+	}
+
+	StepTraceFile::Info info;
+	info.tid = tid;
+
+	register_ids_.clear();
+	Q_FOREACH(const QString &name, traced_registers()) {
+		const int id = state.register_id(name);
+		if(id != -1) {
+			info.registers.push_back(name);
+			register_ids_.push_back(id);
+		}
+	}
+
+	values_.fill(0, register_ids_.size());
+	encoder_.reset(register_ids_.size());
+	steps_ = 0;
+
+	ok_ = file_.write(StepTraceFile::header()) != -1 && file_.write(StepTraceFile::encode(info)) != -1;
+	return ok_;
+}
+
+//------------------------------------------------------------------------------
+// Name: finish
+// Desc: writes out the last, partial, block and closes the file
+//------------------------------------------------------------------------------
+void StepRecorder::finish() {
+	if(file_.isOpen()) {
+		if(ok_ && encoder_.steps() != 0) {
+			file_.write(encoder_.take_block());
+		}
+		file_.close();
+	}
+	ok_ = false;
+}
+
+//------------------------------------------------------------------------------
+// Name: handle_step
+// Desc: stepping stops if the file can't be written to
+//------------------------------------------------------------------------------
+bool StepRecorder::handle_step(const State &state) {
+
+	if(!ok_) {
+		return false;
+	}
+
+	for(int i = 0; i < register_ids_.size(); ++i) {
+		values_[i] = state.value(register_ids_[i]).value<edb::reg_t>();
+	}
+
+	encoder_.add(state.instruction_pointer(), values_.constData());
+	++steps_;
+
+	if(encoder_.steps() == StepTraceFile::block_size) {
+		ok_ = file_.write(encoder_.take_block()) != -1;
+	}
+
+	return ok_;
+}
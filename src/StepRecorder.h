@@ -0,0 +1,57 @@
+/*
+Copyright (C) 2006 - 2013 Evan Teran
+                          eteran@alum.rit.edu
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef STEP_RECORDER_20131103_H_
+#define STEP_RECORDER_20131103_H_
+
+#include "IStepHandler.h"
+#include "StepTraceFile.h"
+#include "Types.h"
+
+#include <QFile>
+#include <QVector>
+
+class State;
+
+// writes the steps it is shown to an instruction trace. Everything happens on
+// the thread doing the stepping, a block is only written out once it is full
+class StepRecorder : public IStepHandler {
+public:
+	StepRecorder();
+	virtual ~StepRecorder();
+
+public:
+	bool start(const QString &filename, edb::tid_t tid, const State &state);
+	void finish();
+	QString error_string() const { return file_.errorString(); }
+	QString file_name() const    { return file_.fileName(); }
+	quint64 steps() const        { return steps_; }
+
+public:
+	virtual bool handle_step(const State &state);
+
+private:
+	QFile                  file_;
+	QVector<int>           register_ids_;
+	QVector<edb::reg_t>    values_;
+	StepTraceFile::Encoder encoder_;
+	quint64                steps_;
+	bool                   ok_;
+};
+
+#endif
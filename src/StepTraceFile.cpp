@@ -0,0 +1,332 @@
+/*
+Copyright (C) 2006 - 2013 Evan Teran
+                          eteran@alum.rit.edu
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "StepTraceFile.h"
+
+#include <QDataStream>
+#include <QFile>
+
+#include <algorithm>
+
+namespace {
+
+const char    step_trace_magic[8] = { 'E', 'D', 'B', 'S', 'T', 'E', 'P', 'S' };
+const quint32 step_trace_version  = 1;
+
+//------------------------------------------------------------------------------
+// Name: make_record
+// Desc: frames a payload as a record of the given type
+//------------------------------------------------------------------------------
+QByteArray make_record(StepTraceFile::RecordType type, const QByteArray &payload) {
+	QByteArray record;
+	QDataStream stream(&record, QIODevice::WriteOnly);
+	stream.setVersion(QDataStream::Qt_4_6);
+	stream << static_cast<quint8>(type) << static_cast<quint32>(payload.size());
+	record.append(payload);
+	return record;
+}
+
+//------------------------------------------------------------------------------
+// Name: put_delta
+// Desc: appends the signed difference between two values, small differences
+//       either way take a byte or two
+//------------------------------------------------------------------------------
+void put_delta(QByteArray *data, quint64 value, quint64 previous) {
+	const qint64 delta = static_cast<qint64>(value - previous);
+	quint64 n = (static_cast<quint64>(delta) << 1) ^ static_cast<quint64>(delta >> 63);
+	while(n >= 0x80) {
+		data->append(static_cast<char>((n & 0x7f) | 0x80));
+		n >>= 7;
+	}
+	data->append(static_cast<char>(n));
+}
+
+//------------------------------------------------------------------------------
+// Name: get_varint
+// Desc: returns false if the data runs out first
+//------------------------------------------------------------------------------
+bool get_varint(const uchar *&p, const uchar *end, quint64 *value) {
+	quint64 n = 0;
+	for(int shift = 0; p != end && shift < 64; shift += 7) {
+		const uchar byte = *p++;
+		n |= static_cast<quint64>(byte & 0x7f) << shift;
+		if(!(byte & 0x80)) {
+			*value = n;
+			return true;
+		}
+	}
+	return false;
+}
+
+//------------------------------------------------------------------------------
+// Name: get_delta
+// Desc: undoes put_delta
+//------------------------------------------------------------------------------
+bool get_delta(const uchar *&p, const uchar *end, quint64 previous, quint64 *value) {
+	quint64 n;
+	if(!get_varint(p, end, &n)) {
+		return false;
+	}
+
+	const qint64 delta = static_cast<qint64>(n >> 1) ^ -static_cast<qint64>(n & 1);
+	*value = previous + static_cast<quint64>(delta);
+	return true;
+}
+
+}
+
+//------------------------------------------------------------------------------
+// Name: Encoder
+// Desc:
+//------------------------------------------------------------------------------
+StepTraceFile::Encoder::Encoder() : previous_address_(0), steps_(0) {
+}
+
+//------------------------------------------------------------------------------
+// Name: reset
+// Desc: starts a new block of steps with <register_count> registers each
+//------------------------------------------------------------------------------
+void StepTraceFile::Encoder::reset(int register_count) {
+
+	// the changed registers are a bitmask
+	Q_ASSERT(register_count <= 64);
+
+	data_.clear();
+	previous_.fill(0, register_count);
+	previous_address_ = 0;
+	steps_            = 0;
+}
+
+//------------------------------------------------------------------------------
+// Name: add
+// Desc: adds a step, <registers> holds as many values as reset was told
+//------------------------------------------------------------------------------
+void StepTraceFile::Encoder::add(edb::address_t address, const edb::reg_t *registers) {
+
+	Q_ASSERT(registers);
+
+	put_delta(&data_, address, previous_address_);
+	previous_address_ = address;
+
+	quint64 changed = 0;
+	for(int i = 0; i < previous_.size(); ++i) {
+		if(registers[i] != previous_[i]) {
+			changed |= Q_UINT64_C(1) << i;
+		}
+	}
+
+	put_delta(&data_, changed, 0);
+
+	for(int i = 0; i < previous_.size(); ++i) {
+		if(changed & (Q_UINT64_C(1) << i)) {
+			put_delta(&data_, registers[i], previous_[i]);
+			previous_[i] = registers[i];
+		}
+	}
+
+	++steps_;
+}
+
+//------------------------------------------------------------------------------
+// Name: take_block
+// Desc: returns the steps added so far as a block record and starts the next
+//       block
+//------------------------------------------------------------------------------
+QByteArray StepTraceFile::Encoder::take_block() {
+
+	QByteArray payload;
+	QDataStream stream(&payload, QIODevice::WriteOnly);
+	stream.setVersion(QDataStream::Qt_4_6);
+	stream << static_cast<quint32>(steps_) << qCompress(data_);
+
+	reset(previous_.size());
+	return make_record(RECORD_BLOCK, payload);
+}
+
+//------------------------------------------------------------------------------
+// Name: StepTraceFile
+// Desc:
+//------------------------------------------------------------------------------
+StepTraceFile::StepTraceFile() {
+	info_.tid = 0;
+}
+
+//------------------------------------------------------------------------------
+// Name: header
+// Desc: what every instruction trace starts with
+//------------------------------------------------------------------------------
+QByteArray StepTraceFile::header() {
+	QByteArray header(step_trace_magic, sizeof(step_trace_magic));
+	QDataStream stream(&header, QIODevice::WriteOnly | QIODevice::Append);
+	stream.setVersion(QDataStream::Qt_4_6);
+	stream << step_trace_version;
+	return header;
+}
+
+//------------------------------------------------------------------------------
+// Name: encode
+// Desc: which thread was traced and which registers the steps have in them,
+//       comes before the first block
+//------------------------------------------------------------------------------
+QByteArray StepTraceFile::encode(const Info &info) {
+	QByteArray payload;
+	QDataStream stream(&payload, QIODevice::WriteOnly);
+	stream.setVersion(QDataStream::Qt_4_6);
+	stream << static_cast<quint64>(info.tid) << info.registers;
+	return make_record(RECORD_INFO, payload);
+}
+
+//------------------------------------------------------------------------------
+// Name: load
+// Desc: reads a whole trace, a block cut short at the end is ignored
+//------------------------------------------------------------------------------
+bool StepTraceFile::load(const QString &filename) {
+
+	info_.tid = 0;
+	info_.registers.clear();
+	addresses_.clear();
+	block_starts_.clear();
+	first_change_.clear();
+	changes_.clear();
+	error_string_.clear();
+
+	QFile file(filename);
+	if(!file.open(QIODevice::ReadOnly)) {
+		error_string_ = file.errorString();
+		return false;
+	}
+
+	char magic[sizeof(step_trace_magic)];
+	if(file.read(magic, sizeof(magic)) != sizeof(magic) || qstrncmp(magic, step_trace_magic, sizeof(magic)) != 0) {
+		error_string_ = QT_TRANSLATE_NOOP("StepTraceFile", "This is not an instruction trace.");
+		return false;
+	}
+
+	QDataStream stream(&file);
+	stream.setVersion(QDataStream::Qt_4_6);
+
+	quint32 version;
+	stream >> version;
+	if(version != step_trace_version) {
+		error_string_ = QT_TRANSLATE_NOOP("StepTraceFile", "Unsupported instruction trace version.");
+		return false;
+	}
+
+	while(!stream.atEnd()) {
+		quint8  type;
+		quint32 length;
+		stream >> type >> length;
+
+		const QByteArray payload = file.read(length);
+		if(stream.status() != QDataStream::Ok || payload.size() != static_cast<int>(length)) {
+			break;
+		}
+
+		QDataStream record(payload);
+		record.setVersion(QDataStream::Qt_4_6);
+
+		switch(type) {
+		case RECORD_INFO:
+			do {
+				quint64 tid;
+				record >> tid >> info_.registers;
+				info_.tid = tid;
+			} while(0);
+			break;
+		case RECORD_BLOCK:
+			if(!decode_block(payload)) {
+				error_string_ = QT_TRANSLATE_NOOP("StepTraceFile", "The instruction trace is damaged.");
+				return false;
+			}
+			break;
+		default:
+			break;
+		}
+	}
+
+	first_change_.push_back(changes_.size());
+	return true;
+}
+
+//------------------------------------------------------------------------------
+// Name: decode_block
+// Desc:
+//------------------------------------------------------------------------------
+bool StepTraceFile::decode_block(const QByteArray &payload) {
+
+	QDataStream record(payload);
+	record.setVersion(QDataStream::Qt_4_6);
+
+	quint32    steps;
+	QByteArray compressed;
+	record >> steps >> compressed;
+
+	const QByteArray data = qUncompress(compressed);
+	const uchar *p         = reinterpret_cast<const uchar *>(data.constData());
+	const uchar *const end = p + data.size();
+
+	const int register_count = qMin(info_.registers.size(), 64);
+	QVector<quint64> previous(register_count, 0);
+	quint64 previous_address = 0;
+
+	block_starts_.push_back(addresses_.size());
+
+	for(quint32 i = 0; i < steps; ++i) {
+		quint64 address;
+		quint64 changed;
+		if(!get_delta(p, end, previous_address, &address) || !get_delta(p, end, 0, &changed)) {
+			return false;
+		}
+
+		previous_address = address;
+		addresses_.push_back(address);
+		first_change_.push_back(changes_.size());
+
+		for(int reg = 0; reg < register_count; ++reg) {
+			if(changed & (Q_UINT64_C(1) << reg)) {
+				if(!get_delta(p, end, previous[reg], &previous[reg])) {
+					return false;
+				}
+
+				const Change change = { reg, static_cast<edb::reg_t>(previous[reg]) };
+				changes_.push_back(change);
+			}
+		}
+	}
+
+	return true;
+}
+
+//------------------------------------------------------------------------------
+// Name: registers
+// Desc: the registers as they were after <step>, which takes replaying the
+//       changes since the start of its block
+//------------------------------------------------------------------------------
+QVector<edb::reg_t> StepTraceFile::registers(int step) const {
+
+	Q_ASSERT(step >= 0 && step < addresses_.size());
+
+	QVector<edb::reg_t> values(info_.registers.size(), 0);
+
+	const int block_start = *(std::upper_bound(block_starts_.begin(), block_starts_.end(), step) - 1);
+	for(int i = first_change_[block_start]; i < first_change_[step + 1]; ++i) {
+		values[changes_[i].reg] = changes_[i].value;
+	}
+
+	return values;
+}
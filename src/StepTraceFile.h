@@ -0,0 +1,103 @@
+/*
+Copyright (C) 2006 - 2013 Evan Teran
+                          eteran@alum.rit.edu
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef STEP_TRACE_FILE_20131103_H_
+#define STEP_TRACE_FILE_20131103_H_
+
+#include "Types.h"
+
+#include <QByteArray>
+#include <QString>
+#include <QStringList>
+#include <QVector>
+
+// the on disk format of instruction traces. Like tracepoint logs, a file is a
+// short header followed by records of a type, a length and a payload. The
+// steps come in blocks; in a block each step is the distance from the last
+// address and the registers which changed, as the difference from their last
+// value, all of it as variable length integers and then compressed. Every
+// block starts over from zero so it can be decoded on its own
+class StepTraceFile {
+public:
+	enum RecordType {
+		RECORD_INFO  = 1,
+		RECORD_BLOCK = 2
+	};
+
+	struct Info {
+		edb::tid_t  tid;
+		QStringList registers;
+	};
+
+	// turns steps into block records
+	class Encoder {
+	public:
+		Encoder();
+
+	public:
+		void reset(int register_count);
+		void add(edb::address_t address, const edb::reg_t *registers);
+		int steps() const { return steps_; }
+		QByteArray take_block();
+
+	private:
+		QByteArray          data_;
+		QVector<edb::reg_t> previous_;
+		edb::address_t      previous_address_;
+		int                 steps_;
+	};
+
+public:
+	// steps in a block, enough to make compression worth it and still little
+	// to decode when looking at a single step
+	static const int block_size = 65536;
+
+public:
+	StepTraceFile();
+
+public:
+	static QByteArray header();
+	static QByteArray encode(const Info &info);
+
+public:
+	bool load(const QString &filename);
+	QString error_string() const                  { return error_string_; }
+	Info info() const                             { return info_; }
+	int size() const                              { return addresses_.size(); }
+	edb::address_t address(int step) const        { return addresses_[step]; }
+	QVector<edb::reg_t> registers(int step) const;
+
+private:
+	bool decode_block(const QByteArray &payload);
+
+private:
+	struct Change {
+		int        reg;
+		edb::reg_t value;
+	};
+
+private:
+	QString                 error_string_;
+	Info                    info_;
+	QVector<edb::address_t> addresses_;
+	QVector<int>            block_starts_;
+	QVector<int>            first_change_;
+	QVector<Change>         changes_;
+};
+
+#endif
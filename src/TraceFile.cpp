@@ -0,0 +1,224 @@
+/*
+Copyright (C) 2006 - 2013 Evan Teran
+                          eteran@alum.rit.edu
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "TraceFile.h"
+
+#include <QDataStream>
+#include <QFile>
+
+namespace {
+
+const char    trace_magic[8] = { 'E', 'D', 'B', 'T', 'R', 'A', 'C', 'E' };
+const quint32 trace_version  = 1;
+
+//------------------------------------------------------------------------------
+// Name: make_record
+// Desc: frames a payload as a record of the given type
+//------------------------------------------------------------------------------
+QByteArray make_record(TraceFile::RecordType type, const QByteArray &payload) {
+	QByteArray record;
+	QDataStream stream(&record, QIODevice::WriteOnly);
+	stream.setVersion(QDataStream::Qt_4_6);
+	stream << static_cast<quint8>(type) << static_cast<quint32>(payload.size());
+	record.append(payload);
+	return record;
+}
+
+}
+
+//------------------------------------------------------------------------------
+// Name: TraceFile
+// Desc:
+//------------------------------------------------------------------------------
+TraceFile::TraceFile() : dropped_(0) {
+}
+
+//------------------------------------------------------------------------------
+// Name: header
+// Desc: what every trace file starts with
+//------------------------------------------------------------------------------
+QByteArray TraceFile::header() {
+	QByteArray header(trace_magic, sizeof(trace_magic));
+	QDataStream stream(&header, QIODevice::WriteOnly | QIODevice::Append);
+	stream.setVersion(QDataStream::Qt_4_6);
+	stream << trace_version;
+	return header;
+}
+
+//------------------------------------------------------------------------------
+// Name: encode
+// Desc: describes a tracepoint, written before its first hit
+//------------------------------------------------------------------------------
+QByteArray TraceFile::encode(const TracepointInfo &info) {
+	QByteArray payload;
+	QDataStream stream(&payload, QIODevice::WriteOnly);
+	stream.setVersion(QDataStream::Qt_4_6);
+	stream << info.id
+	       << static_cast<quint64>(info.address)
+	       << info.registers
+	       << info.memory_expression
+	       << info.memory_size
+	       << info.backtrace_depth;
+
+	return make_record(RECORD_TRACEPOINT, payload);
+}
+
+//------------------------------------------------------------------------------
+// Name: encode
+// Desc: one hit of a tracepoint, the registers are in the order the
+//       tracepoint's record lists them
+//------------------------------------------------------------------------------
+QByteArray TraceFile::encode(const Hit &hit) {
+	QByteArray payload;
+	QDataStream stream(&payload, QIODevice::WriteOnly);
+	stream.setVersion(QDataStream::Qt_4_6);
+	stream << hit.tracepoint
+	       << hit.timestamp
+	       << static_cast<quint64>(hit.tid)
+	       << static_cast<quint64>(hit.address);
+
+	stream << static_cast<quint32>(hit.registers.size());
+	Q_FOREACH(edb::reg_t value, hit.registers) {
+		stream << static_cast<quint64>(value);
+	}
+
+	stream << static_cast<quint64>(hit.memory_address) << hit.memory;
+
+	stream << static_cast<quint32>(hit.backtrace.size());
+	Q_FOREACH(edb::address_t address, hit.backtrace) {
+		stream << static_cast<quint64>(address);
+	}
+
+	return make_record(RECORD_HIT, payload);
+}
+
+//------------------------------------------------------------------------------
+// Name: encode_dropped
+// Desc: notes that some hits didn't make it into the file
+//------------------------------------------------------------------------------
+QByteArray TraceFile::encode_dropped(quint64 count) {
+	QByteArray payload;
+	QDataStream stream(&payload, QIODevice::WriteOnly);
+	stream.setVersion(QDataStream::Qt_4_6);
+	stream << count;
+	return make_record(RECORD_DROPPED, payload);
+}
+
+//------------------------------------------------------------------------------
+// Name: load
+// Desc: reads a whole trace file, a record cut short at the end (the file may
+//       still be being written) is ignored
+//------------------------------------------------------------------------------
+bool TraceFile::load(const QString &filename) {
+
+	tracepoints_.clear();
+	hits_.clear();
+	dropped_ = 0;
+	error_string_.clear();
+
+	QFile file(filename);
+	if(!file.open(QIODevice::ReadOnly)) {
+		error_string_ = file.errorString();
+		return false;
+	}
+
+	char magic[sizeof(trace_magic)];
+	if(file.read(magic, sizeof(magic)) != sizeof(magic) || qstrncmp(magic, trace_magic, sizeof(magic)) != 0) {
+		error_string_ = QT_TRANSLATE_NOOP("TraceFile", "This is not a trace file.");
+		return false;
+	}
+
+	QDataStream stream(&file);
+	stream.setVersion(QDataStream::Qt_4_6);
+
+	quint32 version;
+	stream >> version;
+	if(version != trace_version) {
+		error_string_ = QT_TRANSLATE_NOOP("TraceFile", "Unsupported trace file version.");
+		return false;
+	}
+
+	while(!stream.atEnd()) {
+		quint8  type;
+		quint32 length;
+		stream >> type >> length;
+
+		const QByteArray payload = file.read(length);
+		if(stream.status() != QDataStream::Ok || payload.size() != static_cast<int>(length)) {
+			break;
+		}
+
+		QDataStream record(payload);
+		record.setVersion(QDataStream::Qt_4_6);
+
+		switch(type) {
+		case RECORD_TRACEPOINT:
+			do {
+				TracepointInfo info;
+				quint64 address;
+				record >> info.id >> address >> info.registers >> info.memory_expression >> info.memory_size >> info.backtrace_depth;
+				info.address = address;
+				tracepoints_.insert(info.id, info);
+			} while(0);
+			break;
+		case RECORD_HIT:
+			do {
+				Hit hit;
+				quint64 tid;
+				quint64 address;
+				quint64 memory_address;
+				quint32 count;
+
+				record >> hit.tracepoint >> hit.timestamp >> tid >> address;
+				hit.tid     = tid;
+				hit.address = address;
+
+				record >> count;
+				for(quint32 i = 0; i < count && !record.atEnd(); ++i) {
+					quint64 value;
+					record >> value;
+					hit.registers.push_back(value);
+				}
+
+				record >> memory_address >> hit.memory;
+				hit.memory_address = memory_address;
+
+				record >> count;
+				for(quint32 i = 0; i < count && !record.atEnd(); ++i) {
+					quint64 frame;
+					record >> frame;
+					hit.backtrace.push_back(frame);
+				}
+
+				hits_.push_back(hit);
+			} while(0);
+			break;
+		case RECORD_DROPPED:
+			do {
+				quint64 count;
+				record >> count;
+				dropped_ += count;
+			} while(0);
+			break;
+		default:
+			break;
+		}
+	}
+
+	return true;
+}
@@ -0,0 +1,308 @@
+/*
+Copyright (C) 2006 - 2013 Evan Teran
+                          eteran@alum.rit.edu
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "TraceRecorder.h"
+#include "Expression.h"
+#include "IDebuggerCore.h"
+#include "State.h"
+#include "TraceFile.h"
+#include "edb.h"
+
+#include <QDateTime>
+#include <QDir>
+#include <QtDebug>
+
+#include <cstring>
+
+namespace {
+
+// nobody wants megabytes per hit, this keeps a typo from filling the disk
+const quint32 max_memory_size     = 4096;
+const quint32 max_backtrace_depth = 64;
+
+}
+
+//------------------------------------------------------------------------------
+// Name: TraceRecorder
+// Desc:
+//------------------------------------------------------------------------------
+TraceRecorder::TraceRecorder() : ring_(new char[capacity]), head_(0), tail_(0), dropped_(0), running_(0), pid_(0), next_id_(0) {
+}
+
+//------------------------------------------------------------------------------
+// Name: ~TraceRecorder
+// Desc:
+//------------------------------------------------------------------------------
+TraceRecorder::~TraceRecorder() {
+	stop_file();
+	delete [] ring_;
+}
+
+//------------------------------------------------------------------------------
+// Name: file_name
+// Desc:
+//------------------------------------------------------------------------------
+QString TraceRecorder::file_name() const {
+	return file_ ? file_->fileName() : QString();
+}
+
+//------------------------------------------------------------------------------
+// Name: record
+// Desc: encodes a hit of bp's tracepoint and queues it for the file
+//------------------------------------------------------------------------------
+void TraceRecorder::record(const IBreakpoint::pointer &bp, const State &state) {
+
+	Q_ASSERT(bp);
+	Q_ASSERT(edb::v1::debugger_core);
+
+	const Tracepoint::pointer tracepoint = bp->tracepoint;
+	if(!tracepoint) {
+		return;
+	}
+
+	// every process gets a file of its own
+	const edb::pid_t pid = edb::v1::debugger_core->pid();
+	if(pid != pid_ || !isRunning()) {
+		stop_file();
+		pid_ = pid;
+		if(!start_file()) {
+			return;
+		}
+	}
+
+	if(tracepoint->id == 0) {
+		prepare(tracepoint, bp->address(), state);
+	}
+
+	if(!described_.contains(tracepoint->id)) {
+		TraceFile::TracepointInfo info;
+		info.id                = tracepoint->id;
+		info.address           = bp->address();
+		info.registers         = tracepoint->registers;
+		info.memory_expression = tracepoint->memory_expression;
+		info.memory_size       = tracepoint->memory_size;
+		info.backtrace_depth   = tracepoint->backtrace_depth;
+
+		if(!push(TraceFile::encode(info))) {
+			return;
+		}
+		described_.insert(tracepoint->id);
+	}
+
+	TraceFile::Hit hit;
+	hit.tracepoint     = tracepoint->id;
+	hit.timestamp      = QDateTime::currentMSecsSinceEpoch();
+	hit.tid            = edb::v1::debugger_core->active_thread();
+	hit.address        = bp->address();
+	hit.memory_address = 0;
+
+	hit.registers.reserve(tracepoint->register_ids.size());
+	Q_FOREACH(int id, tracepoint->register_ids) {
+		hit.registers.push_back(state.value(id).value<edb::reg_t>());
+	}
+
+	if(tracepoint->memory_program && tracepoint->memory_size != 0) {
+		bool ok;
+		ExpressionError err;
+		const edb::address_t address = edb::v1::evaluate_expression(*tracepoint->memory_program, state, &ok, &err);
+		if(ok) {
+			hit.memory_address = address;
+			hit.memory.resize(qMin(tracepoint->memory_size, max_memory_size));
+			if(!edb::v1::debugger_core->read_bytes(address, hit.memory.data(), hit.memory.size())) {
+				hit.memory.clear();
+			}
+		}
+	}
+
+	// follow the frame pointers, this is only as good as the code being traced
+	// is at keeping them
+	edb::address_t frame = state.frame_pointer();
+	for(quint32 i = 0; i < qMin(tracepoint->backtrace_depth, max_backtrace_depth); ++i) {
+		edb::address_t frame_data[2];
+		if(!edb::v1::debugger_core->read_bytes(frame, frame_data, sizeof(frame_data)) || frame_data[1] == 0) {
+			break;
+		}
+
+		hit.backtrace.push_back(frame_data[1]);
+
+		if(frame_data[0] <= frame) {
+			break;
+		}
+		frame = frame_data[0];
+	}
+
+	push(TraceFile::encode(hit));
+}
+
+//------------------------------------------------------------------------------
+// Name: prepare
+// Desc: resolves what the tracepoint asks for once, so that a hit is only
+//       register reads and running the compiled memory expression
+//------------------------------------------------------------------------------
+void TraceRecorder::prepare(const Tracepoint::pointer &tracepoint, edb::address_t address, const State &state) {
+
+	tracepoint->id = ++next_id_;
+
+	tracepoint->register_ids.clear();
+	Q_FOREACH(const QString &name, tracepoint->registers) {
+		const int id = state.register_id(name);
+		if(id == -1) {
+			qDebug() << "[TraceRecorder] tracepoint at" << edb::v1::format_pointer(address) << "asks for an unknown register:" << name;
+		}
+		tracepoint->register_ids.push_back(id);
+	}
+
+	tracepoint->memory_program.clear();
+	if(!tracepoint->memory_expression.isEmpty()) {
+		QSharedPointer<CompiledExpression<edb::address_t> > program(new CompiledExpression<edb::address_t>);
+		ExpressionError err;
+		if(edb::v1::compile_expression(tracepoint->memory_expression, state, program.data(), &err)) {
+			tracepoint->memory_program = program;
+		} else {
+			qDebug() << "[TraceRecorder] tracepoint at" << edb::v1::format_pointer(address) << "has a bad memory expression:" << err.what();
+		}
+	}
+}
+
+//------------------------------------------------------------------------------
+// Name: push
+// Desc: copies a record into the ring, returns false (and counts the record as
+//       dropped) if there isn't room for all of it
+//------------------------------------------------------------------------------
+bool TraceRecorder::push(const QByteArray &record) {
+
+	const int size = record.size();
+	const int head = head_.fetchAndAddRelaxed(0);
+	const int tail = tail_.fetchAndAddAcquire(0);
+
+	const int used = (head - tail + capacity) % capacity;
+	if(size > capacity - used - 1) {
+		dropped_.fetchAndAddRelaxed(1);
+		return false;
+	}
+
+	const int first = qMin(size, capacity - head);
+	std::memcpy(ring_ + head, record.constData(), first);
+	std::memcpy(ring_, record.constData() + first, size - first);
+
+	head_.fetchAndStoreRelease((head + size) % capacity);
+	return true;
+}
+
+//------------------------------------------------------------------------------
+// Name: drain
+// Desc: moves everything in the ring to the file in one go
+//------------------------------------------------------------------------------
+void TraceRecorder::drain() {
+
+	QMutexLocker locker(&file_mutex_);
+
+	if(!file_ || !file_->isOpen()) {
+		return;
+	}
+
+	const int tail = tail_.fetchAndAddRelaxed(0);
+	const int head = head_.fetchAndAddAcquire(0);
+
+	if(head != tail) {
+		if(head > tail) {
+			file_->write(ring_ + tail, head - tail);
+		} else {
+			file_->write(ring_ + tail, capacity - tail);
+			file_->write(ring_, head);
+		}
+		tail_.fetchAndStoreRelease(head);
+	}
+
+	if(const int dropped = dropped_.fetchAndStoreRelaxed(0)) {
+		file_->write(TraceFile::encode_dropped(dropped));
+	}
+
+	file_->flush();
+}
+
+//------------------------------------------------------------------------------
+// Name: flush
+// Desc: writes out everything recorded so far without waiting for the thread
+//------------------------------------------------------------------------------
+void TraceRecorder::flush() {
+	drain();
+}
+
+//------------------------------------------------------------------------------
+// Name: run
+// Desc: writes out what has been recorded in batches until told to stop
+//------------------------------------------------------------------------------
+void TraceRecorder::run() {
+	while(running_.fetchAndAddAcquire(0)) {
+		drain();
+		msleep(100);
+	}
+
+	drain();
+}
+
+//------------------------------------------------------------------------------
+// Name: start_file
+// Desc: creates a fresh trace file for the current process and starts the
+//       thread which fills it
+// Note: the temp directory is shared, so the name has a random part and the
+//       file is created by us (0600) or not at all, rather than opening
+//       whatever someone else may have put there. It is kept after we are
+//       done with it, for the trace viewer
+//------------------------------------------------------------------------------
+bool TraceRecorder::start_file() {
+
+	QMutexLocker locker(&file_mutex_);
+
+	file_.reset(new QTemporaryFile(QString("%1/edb-trace-%2-XXXXXX.edbtrace").arg(QDir::tempPath()).arg(pid_)));
+	file_->setAutoRemove(false);
+	if(!file_->open()) {
+		qDebug() << "[TraceRecorder] could not create a trace file in" << QDir::tempPath() << ":" << file_->errorString();
+		file_.reset();
+		return false;
+	}
+
+	file_->write(TraceFile::header());
+
+	head_.fetchAndStoreRelaxed(0);
+	tail_.fetchAndStoreRelaxed(0);
+	dropped_.fetchAndStoreRelaxed(0);
+	described_.clear();
+
+	running_.fetchAndStoreRelease(1);
+	start(QThread::LowPriority);
+	return true;
+}
+
+//------------------------------------------------------------------------------
+// Name: stop_file
+// Desc: writes out what is left and closes the file
+//------------------------------------------------------------------------------
+void TraceRecorder::stop_file() {
+
+	if(isRunning()) {
+		running_.fetchAndStoreRelease(0);
+		wait();
+	}
+
+	QMutexLocker locker(&file_mutex_);
+	if(file_ && file_->isOpen()) {
+		file_->close();
+	}
+}
@@ -0,0 +1,84 @@
+/*
+Copyright (C) 2006 - 2013 Evan Teran
+                          eteran@alum.rit.edu
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef TRACE_RECORDER_20131020_H_
+#define TRACE_RECORDER_20131020_H_
+
+#include "IBreakpoint.h"
+#include "ScopedPointer.h"
+#include "Types.h"
+
+#include <QAtomicInt>
+#include <QByteArray>
+#include <QMutex>
+#include <QSet>
+#include <QTemporaryFile>
+#include <QThread>
+
+class State;
+
+// writes tracepoint hits to a trace file. Hits are encoded on the thread
+// which handles debug events and put in a ring buffer without taking any
+// locks, a background thread moves whatever has piled up to the file every
+// so often. If the ring fills up faster than it is drained, hits are dropped
+// and the file says how many
+class TraceRecorder : public QThread {
+public:
+	TraceRecorder();
+	virtual ~TraceRecorder();
+
+public:
+	void record(const IBreakpoint::pointer &bp, const State &state);
+	void flush();
+	QString file_name() const;
+
+protected:
+	virtual void run();
+
+private:
+	bool start_file();
+	void stop_file();
+	void prepare(const Tracepoint::pointer &tracepoint, edb::address_t address, const State &state);
+	bool push(const QByteArray &record);
+	void drain();
+
+private:
+	static const int capacity = 1024 * 1024;
+
+private:
+	// ring_ is written by the producer between head_ and tail_ - 1, and read by
+	// the consumer from tail_ up to head_. Each side only ever moves its own
+	// index, so the indexes are all the synchronization there is
+	char *const    ring_;
+	QAtomicInt     head_;
+	QAtomicInt     tail_;
+	QAtomicInt     dropped_;
+	QAtomicInt     running_;
+
+	// the consumer side, drain() can be called from flush() as well as from
+	// the thread so it is serialized with this
+	QMutex                         file_mutex_;
+	SCOPED_POINTER<QTemporaryFile> file_;
+
+	// producer side only
+	edb::pid_t     pid_;
+	quint32        next_id_;
+	QSet<quint32>  described_;
+};
+
+#endif
@@ -496,6 +496,26 @@ void analyze_operands(const State &state, const edb::Instruction &insn, QStringL
 
 	Q_UNUSED(insn);
 
+	// fetch the targets of all of the memory operands in one go
+	edb::address_t targets[edb::Instruction::MAX_OPERANDS];
+	int range_index[edb::Instruction::MAX_OPERANDS];
+	IDebuggerCore::MemoryRangeList ranges;
+
+	for(int j = 0; j < edb::Instruction::MAX_OPERANDS; ++j) {
+
+		const edb::Operand &operand = insn.operands()[j];
+
+		if(operand.valid() && operand.general_type() == edb::Operand::TYPE_EXPRESSION) {
+			const IDebuggerCore::MemoryRange range = { get_effective_address(operand, state), &targets[j], sizeof(targets[j]), false };
+			range_index[j] = ranges.size();
+			ranges.push_back(range);
+		}
+	}
+
+	if(!ranges.isEmpty()) {
+		edb::v1::debugger_core->read_ranges(&ranges);
+	}
+
 	for(int j = 0; j < edb::Instruction::MAX_OPERANDS; ++j) {
 
 		const edb::Operand &operand = insn.operands()[j];
@@ -514,12 +534,11 @@ void analyze_operands(const State &state, const edb::Instruction &insn, QStringL
 				break;
 			case edb::Operand::TYPE_EXPRESSION:
 				do {
-					const edb::address_t effective_address = get_effective_address(operand, state);
-					edb::address_t target;
-
-					const bool ok = edb::v1::debugger_core->read_bytes(effective_address, &target, sizeof(target));
+					const IDebuggerCore::MemoryRange &range = ranges[range_index[j]];
+					const edb::address_t effective_address  = range.address;
+					const edb::address_t target             = targets[j];
 
-					if(ok) {
+					if(range.ok) {
 						switch(operand.complete_type()) {
 						case edb::Operand::TYPE_EXPRESSION8:
 							ret << QString("%1 = [%2] = 0x%3").arg(temp_operand).arg(edb::v1::format_pointer(effective_address)).arg(target & 0xff, 2, 16, QChar('0'));
@@ -20,6 +20,7 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #include "ArchProcessor.h"
 #include "BinaryString.h"
 #include "Configuration.h"
+#include "CoverageMap.h"
 #include "Debugger.h"
 #include "DialogInputBinaryString.h"
 #include "DialogInputValue.h"
@@ -34,6 +35,7 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #include "QHexView"
 #include "State.h"
 #include "SymbolManager.h"
+#include "TraceRecorder.h"
 #include "version.h"
 
 #include <QAction>
@@ -43,7 +45,9 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #include <QFile>
 #include <QFileInfo>
 #include <QInputDialog>
+#include <QMap>
 #include <QMessageBox>
+#include <QSet>
 
 #include <cctype>
 
@@ -66,6 +70,16 @@ namespace {
 		return qobject_cast<Debugger *>(edb::v1::debugger_ui);
 	}
 
+	TraceRecorder &trace_recorder() {
+		static TraceRecorder recorder;
+		return recorder;
+	}
+
+	CoverageMap &coverage_map() {
+		static CoverageMap coverage;
+		return coverage;
+	}
+
 	bool function_symbol_base(edb::address_t address, QString *value, int *offset) {
 
 		Q_ASSERT(value);
@@ -81,6 +95,39 @@ namespace {
 		}
 		return ret;
 	}
+
+	// binds a variable in a breakpoint condition to a register id, like
+	// get_variable, fs and gs mean the base of the segment
+	int resolve_condition_variable(const State &state, const QString &name, bool *ok, ExpressionError *err) {
+
+		const QString lower = name.toLower();
+
+		int id;
+		if(lower == "fs") {
+			id = state.register_id("fs_base");
+		} else if(lower == "gs") {
+			id = state.register_id("gs_base");
+		} else {
+			id = state.register_id(lower);
+		}
+
+		*ok = (id != -1);
+		if(!*ok) {
+			*err = ExpressionError(ExpressionError::UNKNOWN_VARIABLE);
+		}
+		return id;
+	}
+
+	edb::address_t read_condition_variable(const State &state, int id, bool *ok, ExpressionError *err) {
+
+		const Register reg = state.value(id);
+
+		*ok = reg.valid();
+		if(!*ok) {
+			*err = ExpressionError(ExpressionError::UNKNOWN_VARIABLE);
+		}
+		return reg.value<edb::reg_t>();
+	}
 }
 
 namespace edb {
@@ -327,6 +374,7 @@ void set_breakpoint_condition(address_t address, const QString &condition) {
 	IBreakpoint::pointer bp = find_breakpoint(address);
 	if(bp) {
 		bp->condition = condition;
+		bp->compiled_condition.clear();
 	}
 }
 
@@ -344,6 +392,308 @@ QString get_breakpoint_condition(address_t address) {
 	return ret;
 }
 
+//------------------------------------------------------------------------------
+// Name: set_breakpoint_ignore_count
+// Desc: the breakpoint will let the next <count> hits go by without stopping
+//------------------------------------------------------------------------------
+void set_breakpoint_ignore_count(address_t address, unsigned int count) {
+	IBreakpoint::pointer bp = find_breakpoint(address);
+	if(bp) {
+		bp->set_ignore_count(count);
+	}
+}
+
+//------------------------------------------------------------------------------
+// Name: get_breakpoint_ignore_count
+// Desc:
+//------------------------------------------------------------------------------
+unsigned int get_breakpoint_ignore_count(address_t address) {
+	unsigned int ret = 0;
+	IBreakpoint::pointer bp = find_breakpoint(address);
+	if(bp) {
+		ret = bp->ignore_count();
+	}
+
+	return ret;
+}
+
+//------------------------------------------------------------------------------
+// Name: evaluate_breakpoint_condition
+// Desc: returns the value of bp's condition for the given state. The first
+//       call compiles the condition with its registers resolved to ids, from
+//       then on it is just a run of the program. A condition which doesn't
+//       compile is not kept, so that every hit reports the error
+//------------------------------------------------------------------------------
+bool evaluate_breakpoint_condition(const IBreakpoint::pointer &bp, const State &state, bool *ok, ExpressionError *err) {
+
+	Q_ASSERT(bp);
+	Q_ASSERT(ok);
+	Q_ASSERT(err);
+
+	if(!bp->compiled_condition) {
+		QSharedPointer<CompiledExpression<address_t> > program(new CompiledExpression<address_t>);
+		if(!compile_expression(bp->condition, state, program.data(), err)) {
+			*ok = false;
+			return false;
+		}
+
+		bp->compiled_condition = program;
+	}
+
+	return evaluate_expression(*bp->compiled_condition, state, ok, err);
+}
+
+//------------------------------------------------------------------------------
+// Name: breakpoint_action
+// Desc: decides what a hit on bp calls for, state being that of the thread
+//       sitting right on it. A hit which is ignored goes no further, otherwise
+//       the condition (if any) has to hold before the hit stops, or is traced
+//       when bp is a tracepoint. error is set for BREAKPOINT_ERROR
+//------------------------------------------------------------------------------
+BREAKPOINT_ACTION breakpoint_action(const IBreakpoint::pointer &bp, const State &state, QString *error) {
+
+	Q_ASSERT(bp);
+	Q_ASSERT(error);
+
+	if(bp->ignore_count() != 0) {
+		return BREAKPOINT_IGNORE;
+	}
+
+	if(!bp->condition.isEmpty()) {
+		bool ok;
+		ExpressionError err;
+		const bool result = evaluate_breakpoint_condition(bp, state, &ok, &err);
+
+		// a condition which can't be evaluated always stops
+		if(!ok) {
+			*error = err.what();
+			return BREAKPOINT_ERROR;
+		}
+
+		if(!result) {
+			return BREAKPOINT_SKIP;
+		}
+	}
+
+	return bp->tracepoint ? BREAKPOINT_TRACE : BREAKPOINT_STOP;
+}
+
+//------------------------------------------------------------------------------
+// Name: complete_breakpoint_hit
+// Desc: counts a hit on bp which breakpoint_action decided on, and uses up
+//       the ignore count or records the tracepoint hit as that calls for
+//------------------------------------------------------------------------------
+void complete_breakpoint_hit(const IBreakpoint::pointer &bp, BREAKPOINT_ACTION action, const State &state) {
+
+	Q_ASSERT(bp);
+
+	bp->hit();
+
+	switch(action) {
+	case BREAKPOINT_IGNORE:
+		bp->set_ignore_count(bp->ignore_count() - 1);
+		break;
+	case BREAKPOINT_TRACE:
+		record_tracepoint(bp, state);
+		break;
+	default:
+		break;
+	}
+}
+
+//------------------------------------------------------------------------------
+// Name: set_breakpoint_tracepoint
+// Desc: makes a breakpoint log its hits instead of stopping, a null tracepoint
+//       turns it back into a regular breakpoint
+//------------------------------------------------------------------------------
+void set_breakpoint_tracepoint(address_t address, const Tracepoint::pointer &tracepoint) {
+	IBreakpoint::pointer bp = find_breakpoint(address);
+	if(bp) {
+		bp->tracepoint = tracepoint;
+	}
+}
+
+//------------------------------------------------------------------------------
+// Name: compile_expression
+// Desc: compiles an expression with its registers bound to ids, fs and gs mean
+//       the base of the segment just like with get_variable
+//------------------------------------------------------------------------------
+bool compile_expression(const QString &expression, const State &state, CompiledExpression<address_t> *program, ExpressionError *err) {
+
+	Q_ASSERT(program);
+	Q_ASSERT(err);
+
+	Expression<address_t> expr(expression);
+	return expr.compile(program, boost::bind(resolve_condition_variable, boost::cref(state), _1, _2, _3), err);
+}
+
+//------------------------------------------------------------------------------
+// Name: evaluate_expression
+// Desc: runs a program made by compile_expression against the given state
+//------------------------------------------------------------------------------
+address_t evaluate_expression(const CompiledExpression<address_t> &program, const State &state, bool *ok, ExpressionError *err) {
+	return program.evaluate(
+		boost::bind(read_condition_variable, boost::cref(state), _1, _2, _3),
+		get_value,
+		ok,
+		err);
+}
+
+//------------------------------------------------------------------------------
+// Name: record_tracepoint
+// Desc: queues a record of a tracepoint hit, this never blocks on the file
+//------------------------------------------------------------------------------
+void record_tracepoint(const IBreakpoint::pointer &bp, const State &state) {
+	trace_recorder().record(bp, state);
+}
+
+//------------------------------------------------------------------------------
+// Name: trace_file_name
+// Desc: the file tracepoint hits are being written to, empty if nothing has
+//       been recorded yet
+//------------------------------------------------------------------------------
+QString trace_file_name() {
+	return trace_recorder().file_name();
+}
+
+//------------------------------------------------------------------------------
+// Name: flush_trace
+// Desc: makes sure every hit recorded so far is in the trace file
+//------------------------------------------------------------------------------
+void flush_trace() {
+	trace_recorder().flush();
+}
+
+//------------------------------------------------------------------------------
+// Name: signal_policy
+// Desc:
+//------------------------------------------------------------------------------
+SIGNAL_POLICY signal_policy(int signal) {
+	return config().signal_policies.value(signal, SIGNAL_STOP);
+}
+
+//------------------------------------------------------------------------------
+// Name: apply_signal_policies
+// Desc: tells the core about the configured signal policies, so that it can
+//       deal with the signals which aren't meant to stop by itself
+//------------------------------------------------------------------------------
+void apply_signal_policies() {
+	if(debugger_core) {
+		const QHash<int, SIGNAL_POLICY> &policies = config().signal_policies;
+		for(QHash<int, SIGNAL_POLICY>::const_iterator it = policies.begin(); it != policies.end(); ++it) {
+			debugger_core->set_signal_policy(it.key(), it.value());
+		}
+	}
+}
+
+//------------------------------------------------------------------------------
+// Name: apply_non_stop
+// Desc: tells the core whether the other threads keep running when one of
+//       them reports an event
+//------------------------------------------------------------------------------
+void apply_non_stop() {
+	if(debugger_core) {
+		debugger_core->set_non_stop(config().non_stop);
+	}
+}
+
+//------------------------------------------------------------------------------
+// Name: apply_syscall_stops
+// Desc: looks up the configured system calls in syscalls.xml and gives the
+//       core their numbers for each ABI it has them for
+//------------------------------------------------------------------------------
+QStringList apply_syscall_stops() {
+
+	const QStringList &names = config().syscall_stops;
+
+	QMap<QString, QList<int> > syscalls;
+	QSet<QString>              found;
+
+	if(!names.isEmpty()) {
+		QFile file(":/debugger/xml/syscalls.xml");
+		QDomDocument doc;
+
+		if(file.open(QIODevice::ReadOnly) && doc.setContent(&file)) {
+			const QDomElement root = doc.firstChildElement("syscalls");
+			for(QDomElement os = root.firstChildElement("linux"); !os.isNull(); os = os.nextSiblingElement("linux")) {
+				const QString arch = os.attribute("arch");
+				for(QDomElement syscall = os.firstChildElement("syscall"); !syscall.isNull(); syscall = syscall.nextSiblingElement("syscall")) {
+					const QString name = syscall.attribute("name");
+					if(names.contains(name)) {
+						bool ok;
+						const int index = syscall.firstChildElement("index").text().toInt(&ok);
+						if(ok) {
+							syscalls[arch].push_back(index);
+							found.insert(name);
+						}
+					}
+				}
+			}
+		}
+	}
+
+	if(debugger_core) {
+		debugger_core->set_syscall_stops(syscalls);
+	}
+
+	QStringList unknown;
+	Q_FOREACH(const QString &name, names) {
+		if(!found.contains(name)) {
+			unknown << name;
+		}
+	}
+	return unknown;
+}
+
+//------------------------------------------------------------------------------
+// Name: start_coverage
+// Desc: starts watching every basic block of the region, returns how many
+//       blocks got a breakpoint
+//------------------------------------------------------------------------------
+int start_coverage(const IRegion::pointer &region) {
+	return coverage_map().start(region);
+}
+
+//------------------------------------------------------------------------------
+// Name: stop_coverage
+// Desc: removes the coverage breakpoints which are left, keeping the results
+//------------------------------------------------------------------------------
+void stop_coverage() {
+	coverage_map().stop();
+}
+
+//------------------------------------------------------------------------------
+// Name: clear_coverage
+// Desc:
+//------------------------------------------------------------------------------
+void clear_coverage() {
+	coverage_map().clear();
+}
+
+//------------------------------------------------------------------------------
+// Name: record_coverage
+// Desc: called when the coverage breakpoint at <address> is hit
+//------------------------------------------------------------------------------
+void record_coverage(address_t address) {
+	coverage_map().record(address);
+}
+
+//------------------------------------------------------------------------------
+// Name: is_covered
+// Desc: returns true if <address> is in a block which has been executed
+//------------------------------------------------------------------------------
+bool is_covered(address_t address) {
+	return coverage_map().covered(address);
+}
+
+//------------------------------------------------------------------------------
+// Name: coverage_enabled
+// Desc: returns true if there are any blocks being watched or covered
+//------------------------------------------------------------------------------
+bool coverage_enabled() {
+	return coverage_map().block_count() != 0;
+}
+
 
 //------------------------------------------------------------------------------
 // Name: create_breakpoint
@@ -446,6 +796,26 @@ void remove_breakpoint(address_t address) {
 	repaint_cpu_view();
 }
 
+//------------------------------------------------------------------------------
+// Name: create_breakpoints
+// Desc: sets breakpoints on many addresses at once, without any of the
+//       questions create_breakpoint asks. Returns how many were created
+//------------------------------------------------------------------------------
+int create_breakpoints(const QList<address_t> &addresses) {
+	const int count = debugger_core->add_breakpoints(addresses).size();
+	repaint_cpu_view();
+	return count;
+}
+
+//------------------------------------------------------------------------------
+// Name: remove_breakpoints
+// Desc:
+//------------------------------------------------------------------------------
+void remove_breakpoints(const QList<address_t> &addresses) {
+	debugger_core->remove_breakpoints(addresses);
+	repaint_cpu_view();
+}
+
 //------------------------------------------------------------------------------
 // Name: eval_expression
 // Desc:
@@ -735,7 +1105,7 @@ address_t get_value(address_t address, bool *ok, ExpressionError *err) {
 
 	*ok = debugger_core->read_bytes(address, &ret, sizeof(ret));
 
-	if(!ok) {
+	if(!*ok) {
 		*err = ExpressionError(ExpressionError::CANNOT_READ_MEMORY);
 	}
 
@@ -16,6 +16,7 @@ You should have received a copy of the GNU General Public License
 along with this program.  If not, see <http://www.gnu.org/licenses/>.
 */
 
+#include "BatchRunner.h"
 #include "Configuration.h"
 #include "Debugger.h"
 #include "DebuggerInternal.h"
@@ -44,7 +45,7 @@ namespace {
 //------------------------------------------------------------------------------
 void load_plugins(const QString &directory) {
 
-	QDir plugins_dir(qApp->applicationDirPath());
+	QDir plugins_dir(QCoreApplication::applicationDirPath());
 
 	// TODO: attempt to detect the same plugin being loaded twice
 	plugins_dir.cd(directory);
@@ -120,6 +121,40 @@ int start_debugger(edb::pid_t attach_pid, const QString &program, const QList<QB
 	}
 }
 
+//------------------------------------------------------------------------------
+// Name: start_batch
+// Desc: runs a script against the target without creating a single widget
+//------------------------------------------------------------------------------
+int start_batch(const QString &script, const QString &output, edb::pid_t attach_pid, const QString &program, const QList<QByteArray> &programArgs) {
+
+	if(!edb::v1::debugger_core) {
+		std::cerr << "Failed to load the debugger core plugin, please make sure it exists and that the plugin path is correctly configured." << std::endl;
+		return BatchRunner::EXIT_ERROR;
+	}
+
+	BatchRunner runner;
+	if(!runner.load_script(script)) {
+		return BatchRunner::EXIT_ERROR;
+	}
+
+	if(!output.isEmpty()) {
+		runner.set_output(output);
+	}
+
+	bool ok;
+	if(attach_pid != 0) {
+		ok = runner.attach(attach_pid);
+	} else {
+		ok = runner.run(program, programArgs);
+	}
+
+	if(!ok) {
+		return BatchRunner::EXIT_ERROR;
+	}
+
+	return qApp->exec();
+}
+
 //------------------------------------------------------------------------------
 // Name: load_translations
 // Desc: 
@@ -149,6 +184,11 @@ void usage() {
 	std::cerr << " --version                 : output version information and exit" << std::endl;
 	std::cerr << " --dump-version            : display terse version string and exit" << std::endl;
 	std::cerr << " --help                    : display this help and exit" << std::endl;
+	std::cerr << std::endl;
+	std::cerr << " --batch <script> [--output <file>] (--attach <pid> | --run <program> (args...))" << std::endl;
+	std::cerr << "                           : run <script> against the target without a GUI, results" << std::endl;
+	std::cerr << "                             go to <file> (or standard output). Exits with 0 once the" << std::endl;
+	std::cerr << "                             target is gone, 1 on errors and 2 if the script timed out" << std::endl;
 	
 	Q_FOREACH(QObject *plugin, edb::v1::plugin_list()) {
 		if(IPlugin *const p = qobject_cast<IPlugin *>(plugin)) {
@@ -175,8 +215,22 @@ int main(int argc, char *argv[]) {
 
 	QT_REQUIRE_VERSION(argc, argv, "4.5.0");
 
+	// batch mode must not need a display, so this has to be known before the
+	// application object exists
+	const bool batch = argc > 1 && qstrcmp(argv[1], "--batch") == 0;
+
+#if QT_VERSION >= 0x050000
+	if(batch) {
+		qputenv("QT_QPA_PLATFORM", "minimal");
+	}
 	QApplication app(argc, argv);
-	QApplication::setWindowIcon(QIcon(":/debugger/images/edb48-logo.png"));
+#else
+	QApplication app(argc, argv, !batch);
+#endif
+
+	if(!batch) {
+		QApplication::setWindowIcon(QIcon(":/debugger/images/edb48-logo.png"));
+	}
 
 	qsrand(std::time(0));
 
@@ -194,6 +248,8 @@ int main(int argc, char *argv[]) {
 	edb::pid_t        attach_pid = 0;
 	QList<QByteArray> run_args;
 	QString           run_app;
+	QString           batch_script;
+	QString           batch_output;
 	
 	// call the init function for each plugin, this is done after
 	// ALL plugins are loaded in case there are inter-plugin dependencies
@@ -214,19 +270,39 @@ int main(int argc, char *argv[]) {
 		}
 	}
 
-	if(args.size() > 1) {
-		if(args.size() == 3 && args[1] == "--attach") {
-			attach_pid = args[2].toUInt();
-		} else if(args.size() >= 3 && args[1] == "--run") {
-			run_app = args[2];
+	// --batch <script> [--output <file>] come first, the target follows them
+	int first = 1;
+	if(batch) {
+		if(args.size() < 3) {
+			usage();
+		}
 
-			for(int i = 3; i < args.size(); ++i) {
+		batch_script = args[2];
+		first = 3;
+
+		if(args.size() > 4 && args[3] == "--output") {
+			batch_output = args[4];
+			first = 5;
+		}
+
+		if(args.size() == first) {
+			usage();
+		}
+	}
+
+	if(args.size() > first) {
+		if(args.size() == first + 2 && args[first] == "--attach") {
+			attach_pid = args[first + 1].toUInt();
+		} else if(args.size() >= first + 2 && args[first] == "--run") {
+			run_app = args[first + 1];
+
+			for(int i = first + 2; i < args.size(); ++i) {
 				run_args.push_back(argv[i]);
 			}
-		} else if(args.size() == 2 && args[1] == "--version") {
+		} else if(!batch && args.size() == 2 && args[1] == "--version") {
 			std::cout << "edb version: " << edb::version << std::endl;
 			return 0;
-		} else if(args.size() == 2 && args[1] == "--dump-version") {
+		} else if(!batch && args.size() == 2 && args[1] == "--dump-version") {
 			std::cout << edb::version << std::endl;
 			return 0;
 		} else {
@@ -234,5 +310,9 @@ int main(int argc, char *argv[]) {
 		}
 	}
 
+	if(batch) {
+		return start_batch(batch_script, batch_output, attach_pid, run_app, run_args);
+	}
+
 	return start_debugger(attach_pid, run_app, run_args);
 }
@@ -26,10 +26,12 @@ HEADERS += \
 	ArchProcessor.h \
 	ArchTypes.h \
 	BasicBlock.h \
+	BatchRunner.h \
 	BinaryString.h \
 	ByteShiftArray.h \
 	CommentServer.h \
 	Configuration.h \
+	CoverageMap.h \
 	DataViewInfo.h \
 	Debugger.h \
 	DebuggerInternal.h \
@@ -40,6 +42,7 @@ HEADERS += \
 	DialogMemoryRegions.h \
 	DialogOptions.h \
 	DialogPlugins.h \
+	DialogStepTrace.h \
 	DialogThreads.h \
 	Expression.h \
 	HexStringValidator.h \
@@ -53,6 +56,7 @@ HEADERS += \
 	IRegion.h \
 	ISessionFile.h \
 	IState.h \
+	IStepHandler.h \
 	ISymbolManager.h \
 	Instruction.h \
 	LineEdit.h \
@@ -73,10 +77,15 @@ HEADERS += \
 	ScopedPointer.h \
 	ShiftBuffer.h \
 	State.h \
+	StepRecorder.h \
+	StepTraceFile.h \
 	Symbol.h \
 	SymbolManager.h \
 	SyntaxHighlighter.h \
 	TabWidget.h \
+	TraceFile.h \
+	TraceRecorder.h \
+	Tracepoint.h \
 	Types.h \
 	Util.h \
 	edb.h \
@@ -94,15 +103,18 @@ FORMS += \
 	DialogMemoryRegions.ui \
 	DialogOptions.ui \
 	DialogPlugins.ui \
+	DialogStepTrace.ui \
 	DialogThreads.ui
 
 SOURCES += \
 	ArchProcessor.cpp \
 	BasicBlock.cpp \
+	BatchRunner.cpp \
 	BinaryString.cpp \
 	ByteShiftArray.cpp \
 	CommentServer.cpp \
 	Configuration.cpp \
+	CoverageMap.cpp \
 	DataViewInfo.cpp \
 	Debugger.cpp \
 	Function.cpp \
@@ -113,8 +125,10 @@ SOURCES += \
 	DialogMemoryRegions.cpp \
 	DialogOptions.cpp \
 	DialogPlugins.cpp \
+	DialogStepTrace.cpp \
 	DialogThreads.cpp \
 	HexStringValidator.cpp \
+	IState.cpp \
 	LineEdit.cpp \
 	MD5.cpp \
 	MemoryRegions.cpp \
@@ -127,9 +141,13 @@ SOURCES += \
 	RegisterListWidget.cpp \
 	RegisterViewDelegate.cpp \
 	State.cpp \
+	StepRecorder.cpp \
+	StepTraceFile.cpp \
 	SymbolManager.cpp \
 	SyntaxHighlighter.cpp \
 	TabWidget.cpp \
+	TraceFile.cpp \
+	TraceRecorder.cpp \
 	edb.cpp \
 	instruction.cpp \
 	main.cpp
@@ -430,6 +430,25 @@ void QDisassemblyView::setCurrentAddress(edb::address_t address) {
 	current_address_ = address;
 }
 
+//------------------------------------------------------------------------------
+// Name: has_breakpoint_icon
+// Desc: coverage breakpoints are the debugger's business, they aren't shown
+//------------------------------------------------------------------------------
+bool QDisassemblyView::has_breakpoint_icon(edb::address_t address) const {
+	const IBreakpoint::pointer bp = edb::v1::find_breakpoint(address);
+	return bp && !bp->coverage;
+}
+
+//------------------------------------------------------------------------------
+// Name: setTracedAddresses
+// Desc: instructions which are marked as having been executed, such as the
+//       ones in an instruction trace
+//------------------------------------------------------------------------------
+void QDisassemblyView::setTracedAddresses(const QSet<edb::address_t> &addresses) {
+	traced_addresses_ = addresses;
+	viewport()->update();
+}
+
 //------------------------------------------------------------------------------
 // Name: setRegion
 // Desc: sets the memory region we are viewing
@@ -725,6 +744,9 @@ void QDisassemblyView::paintEvent(QPaintEvent *) {
 	const QBrush alternated_base_color = palette().alternateBase();
 	const QBrush bytes_color           = palette().text();
 	const QBrush divider_color         = palette().shadow();
+	const QBrush traced_color          = QColor(255, 255, 0, 64);
+	const QBrush covered_color         = QColor(0, 255, 0, 48);
+	const bool   show_coverage         = edb::v1::coverage_enabled();
 	const QPen bytes_pen               = bytes_color.color();
 	const QPen divider_pen             = divider_color.color();
 	const QPen address_pen(Qt::red);
@@ -772,6 +794,12 @@ void QDisassemblyView::paintEvent(QPaintEvent *) {
 			painter.fillRect(0, y, width(), line_height, alternated_base_color);
 		}
 
+		if(traced_addresses_.contains(address)) {
+			painter.fillRect(0, y, width(), line_height, traced_color);
+		} else if(show_coverage && edb::v1::is_covered(address)) {
+			painter.fillRect(0, y, width(), line_height, covered_color);
+		}
+
 		if(analyzer) {
 			draw_function_markers(painter, address, l2, y, insn_size, analyzer);
 		}
@@ -779,7 +807,7 @@ void QDisassemblyView::paintEvent(QPaintEvent *) {
 		// draw breakpoint icon or eip indicator
 		if(address == current_address_) {
 			painter.drawPixmap(1, y + 1, current_address_icon_);
-		} else if(edb::v1::find_breakpoint(address) != 0) {
+		} else if(has_breakpoint_icon(address)) {
 			painter.drawPixmap(1, y + 1, breakpoint_icon_);
 
 			// TODO:
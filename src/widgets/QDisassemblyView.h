@@ -61,6 +61,7 @@ public Q_SLOTS:
 	void setAddressOffset(edb::address_t address);
 	void setRegion(const IRegion::pointer &r);
 	void setCurrentAddress(edb::address_t address);
+	void setTracedAddresses(const QSet<edb::address_t> &addresses);
 	void clear();
 	void repaint();
 	void setShowAddressSeparator(bool value);
@@ -78,6 +79,7 @@ private:
 	QString format_instruction_bytes(const edb::Instruction &insn, int maxStringPx, const QFontMetricsF &metrics) const;
 	QString format_invalid_instruction_bytes(const edb::Instruction &insn, QPainter &painter) const;
 	edb::address_t address_from_coord(int x, int y) const;
+	bool has_breakpoint_icon(edb::address_t address) const;
 	size_t length_disasm_back(const quint8 *buf, size_t size) const;
 	edb::address_t previous_instructions(edb::address_t current_address, int count);
 	edb::address_t following_instructions(edb::address_t current_address, int count);
@@ -99,6 +101,7 @@ private:
 	QPixmap                  breakpoint_icon_;
 	QPixmap                  current_address_icon_;
 	QSet<edb::address_t>     show_addresses_;
+	QSet<edb::address_t>     traced_addresses_;
 	SyntaxHighlighter *const highlighter_;
 	edb::address_t           address_offset_;
 	edb::address_t           selected_instruction_address_;